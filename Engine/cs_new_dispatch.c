@@ -82,6 +82,10 @@ static void dag_print_state(CSOUND *csound)
     watchList *w;
     printf("*** %d tasks\n", csound->dag_num_active);
     for (i=0; i<csound->dag_num_active; i++) {
+      if (csound->dag_task_map[i] == NULL) {
+        printf("%d: unused\n", i);
+        continue;
+      }
       printf("%d(%d): ", i, csound->dag_task_map[i]->insno);
       switch (csound->dag_task_status[i].s) {
       case DONE:
@@ -104,10 +108,10 @@ static void dag_print_state(CSOUND *csound)
         break;
       case WAITING:
         {
-          char *tt = csound->dag_task_dep[i];
+          taskDeps *d = &csound->dag_task_dep[i];
           int j;
           printf("status=WAITING for tasks [");
-          for (j=0; j<i; j++) if (tt[j]) printf("%d ", j);
+          for (j=0; j<d->npred; j++) printf("%d ", d->pred[j]);
           printf("]\n");
         }
         break;
@@ -117,7 +121,60 @@ static void dag_print_state(CSOUND *csound)
     }
 }
 
-/* For now allocate a fixed maximum number of tasks; FIXME */
+/* Work-stealing ready queues (--work-stealing).
+ * Each thread owns one deque of AVAILABLE tasks: it pushes and pops at the
+ * bottom, idle threads steal from the top.  Every task is pushed at most once
+ * per k-cycle, so a queue never holds more than dag_task_max_size entries and
+ * the indices are simply reset in dag_reinit instead of wrapping.
+ */
+typedef struct dag_deque_t {
+  volatile int top;
+  uint8_t padding1[CONCURRENTPADDING - sizeof(int)];
+  volatile int bottom;
+  uint8_t padding2[CONCURRENTPADDING - sizeof(int)];
+  taskID   *tasks;
+  int64_t  load;                /* cost dealt to this queue when seeding */
+  uint8_t padding3[CONCURRENTPADDING - sizeof(taskID *) - sizeof(int64_t)];
+} dag_deque_t;
+
+static void dag_alloc_deques(CSOUND *csound)
+{
+    int i, n = csound->oparms->numThreads;
+    int max = csound->dag_task_max_size;
+    dag_deque_t *dq = csound->dag_deques;
+    if (dq == NULL) {
+      dq = (dag_deque_t *)csound->Calloc(csound, sizeof(dag_deque_t)*n);
+      csound->dag_deques = dq;
+      csound->dag_num_deques = n;
+    }
+    for (i=0; i<n; i++) {
+      dq[i].tasks = (taskID *)csound->ReAlloc(csound, dq[i].tasks,
+                                              sizeof(taskID)*max);
+      dq[i].top = dq[i].bottom = 0;
+    }
+}
+
+/* Cost ordering (--dag-cost-model).
+ * nodePerf keeps a running cost per k-period for every instrument.  Tasks
+ * are kept in dag_task_order sorted longest first; the scanning dispatcher
+ * walks that order from a per-thread start chosen so that each thread
+ * starts on an equal share of the total cost, and the ready queues are
+ * seeded by dealing each task to the least loaded queue.
+ */
+static void dag_alloc_order(CSOUND *csound)
+{
+    int max = csound->dag_task_max_size;
+    csound->dag_task_order =
+      (taskID *)csound->ReAlloc(csound, csound->dag_task_order,
+                                sizeof(taskID)*max);
+    csound->dag_task_cost =
+      (int32 *)csound->ReAlloc(csound, csound->dag_task_cost,
+                               sizeof(int32)*max);
+    if (csound->dag_thread_start == NULL)
+      csound->dag_thread_start =
+        (int *)csound->Calloc(csound, sizeof(int)*csound->oparms->numThreads);
+}
+
 static void create_dag(CSOUND *csound)
 {
     /* Allocate the main task status and watchlists */
@@ -125,11 +182,14 @@ static void create_dag(CSOUND *csound)
     csound->dag_task_status = csound->Calloc(csound, sizeof(stateWithPadding)*max);
     csound->dag_task_watch  = csound->Calloc(csound, sizeof(watchList*)*max);
     csound->dag_task_map    = csound->Calloc(csound, sizeof(INSDS*)*max);
-    csound->dag_task_dep    = (char **)csound->Calloc(csound, sizeof(char*)*max);
+    csound->dag_task_dep    =
+      (taskDeps *)csound->Calloc(csound, sizeof(taskDeps)*max);
     csound->dag_wlmm = (watchList *)csound->Calloc(csound, sizeof(watchList)*max);
+    if (csound->oparms->workStealing) dag_alloc_deques(csound);
+    if (csound->oparms->dagCostModel) dag_alloc_order(csound);
 }
 
-static void recreate_dag(CSOUND *csound)
+static void recreate_dag(CSOUND *csound, int oldmax)
 {
     /* Allocate the main task status and watchlists */
     int max = csound->dag_task_max_size;
@@ -142,9 +202,28 @@ static void recreate_dag(CSOUND *csound)
     csound->dag_task_map    =
       csound->ReAlloc(csound, (INSDS *)csound->dag_task_map, sizeof(INSDS*)*max);
     csound->dag_task_dep    =
-      (char **)csound->ReAlloc(csound, csound->dag_task_dep, sizeof(char*)*max);
+      (taskDeps *)csound->ReAlloc(csound, csound->dag_task_dep,
+                                  sizeof(taskDeps)*max);
     csound->dag_wlmm        =
       (watchList *)csound->ReAlloc(csound, csound->dag_wlmm, sizeof(watchList)*max);
+    /* slots above the old size must start empty */
+    memset(&csound->dag_task_map[oldmax], '\0', sizeof(INSDS*)*(max-oldmax));
+    memset(&csound->dag_task_dep[oldmax], '\0', sizeof(taskDeps)*(max-oldmax));
+    if (csound->oparms->workStealing) dag_alloc_deques(csound);
+    if (csound->oparms->dagCostModel) dag_alloc_order(csound);
+}
+
+/* make sure there are at least n task slots */
+static void dag_ensure_size(CSOUND *csound, int n)
+{
+    if (csound->dag_task_status == NULL)
+      create_dag(csound);
+    if (n > csound->dag_task_max_size) {
+      int oldmax = csound->dag_task_max_size;
+      //printf("**************need to extend task vector\n");
+      csound->dag_task_max_size = n+INIT_SIZE;
+      recreate_dag(csound, oldmax);
+    }
 }
 
 static INSTR_SEMANTICS *dag_get_info(CSOUND* csound, int insno)
@@ -183,92 +262,371 @@ static int dag_intersect(CSOUND *csound, struct set_t *current,
     return res;
 }
 
-void dag_build(CSOUND *csound, INSDS *chain)
+/* Whether instances of two instruments have to run in chain order.
+ * This only depends on the pair of instrument numbers, and the relation
+ * is symmetric, so results are kept in a small open addressing hash
+ * table keyed on (lower insno, higher insno) until new instrument
+ * semantics are compiled.
+ */
+typedef struct dag_conflict_t {
+  int64_t key;                  /* 0 for an empty entry */
+  int     conflict;
+} dag_conflict_t;
+
+/* both instrument numbers are kept whole, as numbers can be large */
+#define DAG_CONFLICT_KEY(a,b) \
+  ((a) < (b) ? (((int64_t)(a)<<32) | (uint32_t)(b)) + 1 : \
+               (((int64_t)(b)<<32) | (uint32_t)(a)) + 1)
+
+static inline int dag_conflict_hash(int64_t key, int size)
 {
-    INSDS *save = chain;
-    INSDS **task_map;
+    uint32_t h = (uint32_t)((uint64_t)key >> 32) ^ (uint32_t)key;
+    return (int)((h * 2654435761u) & (size-1));
+}
+
+static int dag_conflict_compute(CSOUND *csound, int a, int b)
+{
+    INSTR_SEMANTICS *current_instr = dag_get_info(csound, a);
+    INSTR_SEMANTICS *later_instr = dag_get_info(csound, b);
+    int cnt = 0;
+    //csp_set_print(csound, current_instr->read);
+    //csp_set_print(csound, current_instr->write);
+    //csp_set_print(csound, later_instr->read);
+    //csp_set_print(csound, later_instr->write);
+    //csp_set_print(csound, later_instr->read_write);
+    return (dag_intersect(csound, current_instr->write,
+                          later_instr->read, cnt++)       ||
+            dag_intersect(csound, current_instr->read_write,
+                          later_instr->read, cnt++)       ||
+            dag_intersect(csound, current_instr->read,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->write,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->read_write,
+                          later_instr->write, cnt++)      ||
+            dag_intersect(csound, current_instr->read,
+                          later_instr->read_write, cnt++) ||
+            dag_intersect(csound, current_instr->write,
+                          later_instr->read_write, cnt++));
+}
+
+static int dag_conflict(CSOUND *csound, int a, int b)
+{
+    int64_t key = DAG_CONFLICT_KEY(a, b);
+    dag_conflict_t *tab = csound->dag_conflicts;
+    int size = csound->dag_conflicts_size, i;
+
+    if (csound->dag_conflicts_stale) {   /* new instruments were compiled */
+      if (tab != NULL) memset(tab, '\0', sizeof(dag_conflict_t)*size);
+      csound->dag_conflicts_count = 0;
+      csound->dag_conflicts_stale = 0;
+    }
+    if (2*(csound->dag_conflicts_count+1) > size) {
+      /* grow and rehash */
+      int newsize = size ? 2*size : 64, j;
+      dag_conflict_t *ntab =
+        (dag_conflict_t *)csound->Calloc(csound,
+                                         sizeof(dag_conflict_t)*newsize);
+      for (j=0; j<size; j++) {
+        if (tab[j].key == 0) continue;
+        i = dag_conflict_hash(tab[j].key, newsize);
+        while (ntab[i].key != 0) i = (i+1) & (newsize-1);
+        ntab[i] = tab[j];
+      }
+      csound->Free(csound, tab);
+      csound->dag_conflicts = tab = ntab;
+      csound->dag_conflicts_size = size = newsize;
+    }
+    i = dag_conflict_hash(key, size);
+    while (tab[i].key != 0) {
+      if (tab[i].key == key) return tab[i].conflict;
+      i = (i+1) & (size-1);
+    }
+    tab[i].key = key;
+    tab[i].conflict = dag_conflict_compute(csound, a, b);
+    csound->dag_conflicts_count++;
+    return tab[i].conflict;
+}
+
+static void dag_list_add(CSOUND *csound, taskID **list, int *n, int *max,
+                         taskID id)
+{
+    if (*n == *max) {
+      *max = *max ? 2 * *max : 4;
+      *list = (taskID *)csound->ReAlloc(csound, *list, sizeof(taskID) * *max);
+    }
+    (*list)[(*n)++] = id;
+}
+
+static void dag_list_remove(taskID *list, int *n, taskID id)
+{
+    int i;
+    for (i=0; i<*n; i++)
+      if (list[i] == id) {
+        list[i] = list[--(*n)];
+        return;
+      }
+}
+
+/* task "to" has to wait for task "from" */
+static void dag_add_edge(CSOUND *csound, taskID from, taskID to)
+{
+    taskDeps *f = &csound->dag_task_dep[from], *t = &csound->dag_task_dep[to];
+    dag_list_add(csound, &t->pred, &t->npred, &t->maxpred, from);
+    dag_list_add(csound, &f->succ, &f->nsucc, &f->maxsucc, to);
+}
+
+static void dag_remove_task(CSOUND *csound, taskID id)
+{
+    taskDeps *d = &csound->dag_task_dep[id];
     int i;
+    for (i=0; i<d->npred; i++) {
+      taskDeps *p = &csound->dag_task_dep[d->pred[i]];
+      dag_list_remove(p->succ, &p->nsucc, id);
+    }
+    for (i=0; i<d->nsucc; i++) {
+      taskDeps *s = &csound->dag_task_dep[d->succ[i]];
+      dag_list_remove(s->pred, &s->npred, id);
+    }
+    d->npred = d->nsucc = 0;
+    csound->dag_task_map[id] = NULL;
+    csound->dag_num_live--;
+}
+
+/* After a build: keep the surviving tasks in their previous order and
+   append the new ones; dag_task_cost marks the slots already placed */
+static void dag_order_update(CSOUND *csound)
+{
+    int i, j, n = csound->dag_num_active;
+    taskID *order = csound->dag_task_order;
+    int32 *cost = csound->dag_task_cost;
+    INSDS **task_map = csound->dag_task_map;
+    for (i=0; i<n; i++) cost[i] = -1;
+    for (i=j=0; i<csound->dag_num_order; i++) {
+      taskID t = order[i];
+      if (t < n && task_map[t] != NULL && cost[t] < 0) {
+        cost[t] = 0;
+        order[j++] = t;
+      }
+    }
+    for (i=0; i<n; i++)
+      if (task_map[i] != NULL && cost[i] < 0) order[j++] = i;
+    csound->dag_num_order = j;
+}
+
+/* Refresh the costs and sort longest first.  The order is left from the
+   previous k-cycle so it is nearly sorted and insertion sort is cheap. */
+static void dag_order_sort(CSOUND *csound)
+{
+    int i, j, k, n = csound->dag_num_order;
+    int nt = csound->oparms->numThreads;
+    taskID *order = csound->dag_task_order;
+    int32 *cost = csound->dag_task_cost;
+    int64_t total = 0, sum = 0;
+    for (i=0; i<n; i++) {
+      taskID t = order[i];
+      int64_t c = (int64_t)(csound->dag_task_map[t]->instr->kcost + 1) *
+        csound->dag_task_dep[t].ninst;
+      cost[t] = (c > 0x3fffffff) ? 0x3fffffff : (int32)c;
+      total += cost[t];
+    }
+    for (i=1; i<n; i++) {
+      taskID t = order[i];
+      for (j=i; j>0 && cost[order[j-1]] < cost[t]; j--)
+        order[j] = order[j-1];
+      order[j] = t;
+    }
+    /* thread k starts where the cost so far reaches k/nt of the total */
+    for (i=0, k=0; k<nt; k++) {
+      while (i < n && sum*nt < total*k) sum += cost[order[i++]];
+      csound->dag_thread_start[k] = (i < n) ? i : 0;
+    }
+}
+
+/* Deal the initially available tasks out to the ready queues; called
+   from the main thread before the workers are released */
+static void dag_seed_deques(CSOUND *csound)
+{
+    int i, k = 0;
+    int n = csound->dag_num_deques;
+    dag_deque_t *dq = csound->dag_deques;
+    for (i=0; i<n; i++) dq[i].top = dq[i].bottom = 0;
+    if (csound->dag_task_order != NULL) {
+      /* longest first to the least loaded queue, then reverse each queue
+         so that its owner pops the longest task first */
+      taskID *order = csound->dag_task_order;
+      for (i=0; i<n; i++) dq[i].load = 0;
+      for (i=0; i<csound->dag_num_order; i++) {
+        taskID t = order[i];
+        int m;
+        if (csound->dag_task_status[t].s != AVAILABLE) continue;
+        for (m=0, k=1; k<n; k++)
+          if (dq[k].load < dq[m].load) m = k;
+        dq[m].tasks[dq[m].bottom++] = t;
+        dq[m].load += csound->dag_task_cost[t];
+      }
+      for (k=0; k<n; k++) {
+        taskID *q = dq[k].tasks;
+        int lo = 0, hi = dq[k].bottom-1;
+        while (lo < hi) {
+          taskID tmp = q[lo];
+          q[lo++] = q[hi];
+          q[hi--] = tmp;
+        }
+      }
+      return;
+    }
+    for (i=0; i<csound->dag_num_active; i++) {
+      if (csound->dag_task_status[i].s == AVAILABLE) {
+        dq[k].tasks[dq[k].bottom++] = i;
+        if (++k == n) k = 0;
+      }
+    }
+}
+
+static inline int64_t dag_inst_cost(CSOUND *csound, INSDS *ip)
+{
+    return csound->oparms->dagCostModel ? (int64_t)ip->instr->kcost + 1 : 1;
+}
+
+/* Number every instance in chain order and add an edge for every
+   conflicting pair: O(n^2) cached lookups.
+   With --task-batch=N, runs of instances of an instrument that does not
+   conflict with itself are chained through dag_next into tasks costing
+   about N times the mean instance.  The chain is in instrument order, so
+   such a run is contiguous and every other task is either before or
+   after all of it. */
+static void dag_build_full(CSOUND *csound, INSDS *chain)
+{
+    INSDS *save = chain;
+    taskDeps *deps;
+    int i, j, n = 0;
+    int64_t total = 0, target = 0;
 
     //printf("DAG BUILD***************************************\n");
-    csound->dag_num_active = 0;
     while (chain != NULL) {
-      csound->dag_num_active++;
+      if (csound->oparms->taskBatch > 0) total += dag_inst_cost(csound, chain);
+      n++;
       chain = chain->nxtact;
     }
-    if (csound->dag_num_active>csound->dag_task_max_size) {
-      //printf("**************need to extend task vector\n");
-      csound->dag_task_max_size = csound->dag_num_active+INIT_SIZE;
-      recreate_dag(csound);
+    if (n > 0) target = (total * csound->oparms->taskBatch) / n;
+    dag_ensure_size(csound, n);
+    deps = csound->dag_task_dep;
+    if (csound->dag_num_active > n) n = csound->dag_num_active;
+    for (i=0; i<n; i++) {
+      deps[i].npred = deps[i].nsucc = 0;
+      csound->dag_task_map[i] = NULL;
     }
-    if (csound->dag_task_status == NULL)
-      create_dag(csound); /* Should move elsewhere */
-    else {
-      memset((void*)csound->dag_task_watch, '\0',
-             sizeof(watchList*)*csound->dag_task_max_size);
-      for (i=0; i<csound->dag_task_max_size; i++) {
-        if (csound->dag_task_dep[i]) {
-          csound->dag_task_dep[i]= NULL;
+    n = 0;
+    for (i=0, chain=save; chain != NULL; i++) {
+      INSDS *last = chain;
+      csound->dag_task_map[i] = chain;
+      chain->dag_task = i;
+      deps[i].order = i;
+      deps[i].stamp = csound->dag_epoch;
+      deps[i].ninst = 1;
+      chain = chain->nxtact;
+      if (target > 0 && chain != NULL && chain->insno == last->insno &&
+          !dag_conflict(csound, last->insno, last->insno)) {
+        int64_t cost = dag_inst_cost(csound, last);
+        while (chain != NULL && chain->insno == last->insno && cost < target) {
+          last->dag_next = chain;
+          last = chain;
+          chain->dag_task = i;
+          cost += dag_inst_cost(csound, chain);
+          deps[i].ninst++;
+          chain = chain->nxtact;
         }
-        csound->dag_wlmm[i].id = INVALID;
       }
+      last->dag_next = NULL;
+      n++;
     }
-    task_map = csound->dag_task_map;
-    for (i=0; i<csound->dag_num_active; i++) {
-      csound->dag_task_status[i].s = AVAILABLE;
-      csound->dag_wlmm[i].id=i;
-    }
-    csound->dag_changed = 0;
+    csound->dag_num_active = csound->dag_num_live = n;
     if (UNLIKELY(csound->oparms->odebug))
       printf("dag_num_active = %d\n", csound->dag_num_active);
-    i = 0; chain = save;
-    while (chain != NULL) {     /* for each instance check against later */
-      int j = i+1;              /* count of instance */
+    for (i=0; i<n; i++) {     /* for each instance check against later */
+      int insno = csound->dag_task_map[i]->insno;
       if (UNLIKELY(csound->oparms->odebug))
-        printf("\nWho depends on %d (instr %d)?\n", i, chain->insno);
-      INSDS *next = chain->nxtact;
-      INSTR_SEMANTICS *current_instr = dag_get_info(csound, chain->insno);
-      //csp_set_print(csound, current_instr->read);
-      //csp_set_print(csound, current_instr->write);
-      while (next) {
-        INSTR_SEMANTICS *later_instr = dag_get_info(csound, next->insno);
-        int cnt = 0;
+        printf("\nWho depends on %d (instr %d)?\n", i, insno);
+      for (j=i+1; j<n; j++) {
         if (UNLIKELY(csound->oparms->odebug)) printf("%d ", j);
-        //csp_set_print(csound, later_instr->read);
-        //csp_set_print(csound, later_instr->write);
-        //csp_set_print(csound, later_instr->read_write);
-        if (dag_intersect(csound, current_instr->write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->read, cnt++)       ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read_write,
-                          later_instr->write, cnt++)      ||
-            dag_intersect(csound, current_instr->read,
-                          later_instr->read_write, cnt++) ||
-            dag_intersect(csound, current_instr->write,
-                          later_instr->read_write, cnt++)) {
-          char *tt = csound->dag_task_dep[j];
-          if (tt==NULL) {
-            /* get dep vector if missing and set watch first time */
-            tt = csound->dag_task_dep[j] =
-              (char*)csound->Calloc(csound, sizeof(char)*(j+1));
-            csound->dag_task_status[j].s = WAITING;
-            csound->dag_wlmm[j].next = csound->dag_task_watch[i];
-            csound->dag_wlmm[j].id = j;
-            csound->dag_task_watch[i] = &(csound->dag_wlmm[j]);
-            //printf("set watch %d to %d\n", j, i);
-          }
-          tt[i] = 1;
-          //printf("-yes ");
+        if (dag_conflict(csound, insno, csound->dag_task_map[j]->insno))
+          dag_add_edge(csound, i, j);
+      }
+    }
+}
+
+/* Patch the graph after instances were inserted into or removed from the
+   active chain.  Surviving tasks keep their slots and edges, as their
+   relative chain order cannot change; removed tasks are unlinked and each
+   new instance is checked against the live ones only.  Returns 0 if there
+   were too many changes and a full build is cheaper. */
+static int dag_build_incremental(CSOUND *csound, INSDS *chain)
+{
+    taskDeps *deps = csound->dag_task_dep;
+    INSDS **task_map = csound->dag_task_map;
+    int epoch = ++csound->dag_epoch;
+    int i, pos = 0, nnew = 0, nold = 0, hole = 0;
+    INSDS *ip;
+
+    if (csound->dag_task_status == NULL) return 0;
+    for (ip = chain; ip != NULL; ip = ip->nxtact, pos++) {
+      int t = ip->dag_task;
+      if (t >= 0 && t < csound->dag_num_active && task_map[t] == ip) {
+        deps[t].stamp = epoch;
+        deps[t].order = pos;
+        nold++;
+      }
+      else nnew++;
+    }
+    /* rebuild if most of the graph changed or slots are mostly holes */
+    if (nnew > nold || 2*pos < csound->dag_num_active) return 0;
+    for (i=0; i<csound->dag_num_active; i++)
+      if (task_map[i] != NULL && deps[i].stamp != epoch)
+        dag_remove_task(csound, i);
+    dag_ensure_size(csound, csound->dag_num_active + nnew);
+    deps = csound->dag_task_dep;
+    task_map = csound->dag_task_map;
+    for (ip = chain, pos = 0; ip != NULL; ip = ip->nxtact, pos++) {
+      int t = ip->dag_task, k;
+      if (t >= 0 && t < csound->dag_num_active && task_map[t] == ip) continue;
+      /* new instance: take the first free slot */
+      while (hole < csound->dag_num_active && task_map[hole] != NULL) hole++;
+      t = hole;
+      if (t == csound->dag_num_active) csound->dag_num_active++;
+      task_map[t] = ip;
+      ip->dag_task = t;
+      ip->dag_next = NULL;
+      deps[t].order = pos;
+      deps[t].npred = deps[t].nsucc = 0;
+      deps[t].ninst = 1;
+      for (k=0; k<csound->dag_num_active; k++) {
+        if (task_map[k] == NULL || deps[k].stamp != epoch) continue;
+        if (dag_conflict(csound, task_map[k]->insno, ip->insno)) {
+          if (deps[k].order < pos) dag_add_edge(csound, k, t);
+          else dag_add_edge(csound, t, k);
         }
-        j++; next = next->nxtact;
       }
-      task_map[i] = chain;
-      i++; chain = chain->nxtact;
+      deps[t].stamp = epoch;
+      csound->dag_num_live++;
     }
+    while (csound->dag_num_active > 0 &&
+           task_map[csound->dag_num_active-1] == NULL)
+      csound->dag_num_active--;
+    return 1;
+}
+
+void dag_reinit(CSOUND *csound);
+
+void dag_build(CSOUND *csound, INSDS *chain)
+{
+    /* batches are recut on every build */
+    if (!csound->oparms->dagIncremental || csound->oparms->taskBatch > 0 ||
+        csound->dag_conflicts_stale || !dag_build_incremental(csound, chain))
+      dag_build_full(csound, chain);
+    if (csound->dag_task_order != NULL) dag_order_update(csound);
+    csound->dag_changed = 0;
+    dag_reinit(csound);
     if (UNLIKELY(csound->oparms->odebug)) dag_print_state(csound);
 }
 
@@ -279,26 +637,27 @@ void dag_reinit(CSOUND *csound)
     volatile stateWithPadding *task_status = csound->dag_task_status;
     watchList * volatile *task_watch = csound->dag_task_watch;
     watchList *wlmm = csound->dag_wlmm;
+    taskDeps *deps = csound->dag_task_dep;
     if (UNLIKELY(csound->oparms->odebug))
       printf("DAG REINIT************************\n");
     for (i=csound->dag_num_active; i<max; i++)
       task_status[i].s = DONE;
-    task_status[0].s = AVAILABLE;
-    task_watch[0] = NULL;
-    for (i=1; i<csound->dag_num_active; i++) {
-      int j;
-      task_status[i].s = AVAILABLE;
+    for (i=0; i<csound->dag_num_active; i++) {
       task_watch[i] = NULL;
-      if (csound->dag_task_dep[i]==NULL) continue;
-      for (j=0; j<i; j++)
-        if (csound->dag_task_dep[i][j]) {
-          task_status[i].s = WAITING;
-          wlmm[i].id = i;
-          wlmm[i].next = task_watch[j];
-          task_watch[j] = &wlmm[i];
-          break;
-        }
+      if (csound->dag_task_map[i] == NULL) task_status[i].s = DONE;
+      else task_status[i].s = AVAILABLE;
     }
+    for (i=0; i<csound->dag_num_active; i++) {
+      if (deps[i].npred == 0 || csound->dag_task_map[i] == NULL) continue;
+      /* watch the first task we depend on */
+      task_status[i].s = WAITING;
+      wlmm[i].id = i;
+      wlmm[i].next = task_watch[deps[i].pred[0]];
+      task_watch[deps[i].pred[0]] = &wlmm[i];
+    }
+    ATOMIC_SET(csound->dag_tasks_unstarted, csound->dag_num_live);
+    if (csound->dag_task_order != NULL) dag_order_sort(csound);
+    if (csound->dag_deques != NULL) dag_seed_deques(csound);
     //dag_print_state(csound);
 }
 
@@ -324,6 +683,115 @@ void dag_reinit(CSOUND *csound)
                               __ATOMIC_SEQ_CST)
 #endif
 
+#if defined(_MSC_VER)
+#define DAG_FENCE() MemoryBarrier()
+#else
+#define DAG_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define DAG_PAUSE() __builtin_ia32_pause()
+#else
+#define DAG_PAUSE()
+#endif
+
+/* Worker parking (--park-spin=N).
+ * A thread that finds no ready task polls N times and then sleeps on
+ * dag_park_cond.  Each batch of released tasks wakes at most that many
+ * sleepers, and claiming the last unstarted task wakes them all so that
+ * they can leave for the end of cycle barrier.
+ */
+static void dag_unpark(CSOUND *csound, int n)
+{
+    csoundLockMutex(csound->dag_park_lock);
+    if (n > csound->dag_parked) n = csound->dag_parked;
+    while (n-- > 0)
+      csoundCondSignal(csound->dag_park_cond);
+    csoundUnlockMutex(csound->dag_park_lock);
+}
+
+/* Call after making n tasks available */
+static inline void dag_wake(CSOUND *csound, int n)
+{
+    if (csound->dag_park_cond == NULL) return;
+    DAG_FENCE();                /* publish the tasks before reading parked */
+    if (ATOMIC_GET(csound->dag_parked) > 0) dag_unpark(csound, n);
+}
+
+/* A task has been claimed */
+static inline void dag_claimed(CSOUND *csound)
+{
+    ATOMIC_DECR(csound->dag_tasks_unstarted);
+    if (ATOMIC_GET(csound->dag_tasks_unstarted) == 0)
+      dag_wake(csound, csound->oparms->numThreads);
+}
+
+/* Strong CAS: a spurious failure when racing for the last entry of a
+   deque would lose the task */
+#if defined(_MSC_VER)
+#define ATOMIC_CAS_STRONG(x,current,new) \
+  (current == InterlockedCompareExchange(x, new, current))
+#else
+#define ATOMIC_CAS_STRONG(x,current,new)  \
+  __atomic_compare_exchange_n(x,&(current),new, false, __ATOMIC_SEQ_CST, \
+                              __ATOMIC_SEQ_CST)
+#endif
+
+/* Only the owning thread pushes */
+static inline void dag_deque_push(dag_deque_t *d, taskID t)
+{
+    int b = d->bottom;
+    d->tasks[b] = t;
+    ATOMIC_SET(d->bottom, b+1);
+}
+
+/* Only the owning thread pops, from the bottom */
+static inline taskID dag_deque_pop(dag_deque_t *d)
+{
+    int b = d->bottom - 1, t;
+    taskID x = INVALID;
+    ATOMIC_SET(d->bottom, b);
+    t = ATOMIC_GET(d->top);
+    if (t <= b) {
+      x = d->tasks[b];
+      if (t == b) {             /* last one: race against thieves */
+        if (!ATOMIC_CAS_STRONG(&(d->top), t, t+1)) x = INVALID;
+        ATOMIC_SET(d->bottom, b+1);
+      }
+    }
+    else ATOMIC_SET(d->bottom, b+1);
+    return x;
+}
+
+/* Any other thread steals from the top; INVALID if empty or lost a race */
+static inline taskID dag_deque_steal(dag_deque_t *d)
+{
+    int t = ATOMIC_GET(d->top);
+    int b = ATOMIC_GET(d->bottom);
+    taskID x;
+    if (t >= b) return INVALID;
+    x = d->tasks[t];
+    if (!ATOMIC_CAS_STRONG(&(d->top), t, t+1)) return INVALID;
+    return x;
+}
+
+static taskID dag_steal_task(CSOUND *csound, int index)
+{
+    int k, n = csound->dag_num_deques;
+    dag_deque_t *dq = csound->dag_deques;
+    taskID x = dag_deque_pop(&dq[index]);
+    for (k = 1; x == INVALID && k < n; k++) {
+      int victim = index + k;
+      if (victim >= n) victim -= n;
+      x = dag_deque_steal(&dq[victim]);
+    }
+    if (x == INVALID)
+      return ATOMIC_GET(csound->dag_tasks_unstarted) > 0 ?
+        (taskID)WAIT : (taskID)INVALID;
+    dag_claimed(csound);
+    ATOMIC_WRITE(csound->dag_task_status[x].s, INPROGRESS);
+    return x;
+}
+
 taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
 {
     int i;
@@ -332,24 +800,35 @@ taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
     int start = (index * active) / numThreads;
     volatile stateWithPadding *task_status = csound->dag_task_status;
     enum state current_task_status;
+    taskID *order = csound->dag_task_order;
 
     if (next_task != INVALID) {
       // Have forwarded one task from the previous one
       // assert(ATOMIC_READ(task_status[next_task].s) == WAITING);
+      if (csound->dag_deques != NULL || csound->dag_park_cond != NULL)
+        dag_claimed(csound);
       ATOMIC_WRITE(task_status[next_task].s,INPROGRESS);
       return next_task;
     }
+    if (csound->dag_deques != NULL) return dag_steal_task(csound, index);
+    if (order != NULL) {        /* scan positions in cost order */
+      active = csound->dag_num_order;
+      if (active == 0) return (taskID)INVALID;
+      start = csound->dag_thread_start[index];
+    }
 
     //printf("**GetTask from %d\n", csound->dag_num_active);
     i = start;
     do {
-      current_task_status = ATOMIC_READ(task_status[i].s);
+      taskID t = (order != NULL) ? order[i] : i;
+      current_task_status = ATOMIC_READ(task_status[t].s);
 
       switch (current_task_status) {
       case AVAILABLE :
         // Need to CAS as the value may have changed
-        if (ATOMIC_CAS(&(task_status[i].s), current_task_status, INPROGRESS)) {
-          return (taskID)i;
+        if (ATOMIC_CAS(&(task_status[t].s), current_task_status, INPROGRESS)) {
+          if (csound->dag_park_cond != NULL) dag_claimed(csound);
+          return t;
         }
         break;
 
@@ -382,6 +861,33 @@ taskID dag_get_task(CSOUND *csound, int index, int numThreads, taskID next_task)
     return (taskID)WAIT;
 }
 
+/* Called on WAIT: poll for the spin budget, then sleep until tasks are
+   released or none are left to start */
+taskID dag_park_task(CSOUND *csound, int index, int numThreads)
+{
+    int spin = csound->oparms->parkSpin;
+    taskID t;
+    while (spin-- > 0) {
+      t = dag_get_task(csound, index, numThreads, INVALID);
+      if (t != WAIT) return t;
+      DAG_PAUSE();
+    }
+    csoundLockMutex(csound->dag_park_lock);
+    ATOMIC_INCR(csound->dag_parked);
+    /* recheck after announcing ourselves so a release cannot be missed */
+    while ((t = dag_get_task(csound, index, numThreads, INVALID)) == WAIT) {
+      /* a forwarded task still reads as WAITING after it is claimed */
+      if (ATOMIC_GET(csound->dag_tasks_unstarted) == 0) {
+        t = (taskID)INVALID;
+        break;
+      }
+      csoundCondWait(csound->dag_park_cond, csound->dag_park_lock);
+    }
+    ATOMIC_DECR(csound->dag_parked);
+    csoundUnlockMutex(csound->dag_park_lock);
+    return t;
+}
+
 /* This static is OK as not written */
 static const watchList DoNotRead = { INVALID, NULL};
 
@@ -406,14 +912,15 @@ inline static int moveWatch(CSOUND *csound, watchList * volatile *w,
     return 1;
 }
 
-taskID dag_end_task(CSOUND *csound, taskID i)
+taskID dag_end_task(CSOUND *csound, taskID i, int index)
 {
     watchList *to_notify, *next;
     int canQueue;
-    int j, k;
+    int j, k, m;
     watchList * volatile *task_watch = csound->dag_task_watch;
     enum state current_task_status;
     int wait_on_current_tasks;
+    int released = 0;
     taskID next_task = INVALID;
     ATOMIC_WRITE(csound->dag_task_status[i].s, DONE); /* as DONE is zero */
     // A write barrier /might/ be useful here to avoid the case
@@ -435,8 +942,8 @@ taskID dag_end_task(CSOUND *csound, taskID i)
       canQueue = 1;
       wait_on_current_tasks = 0;
 
-      for (k=0; k<j; k++) {     /* seek next watch */
-        if (csound->dag_task_dep[j][k]==0) continue;
+      for (m=0; m<csound->dag_task_dep[j].npred; m++) { /* seek next watch */
+        k = csound->dag_task_dep[j].pred[m];
         current_task_status = ATOMIC_READ(csound->dag_task_status[k].s);
         //printf("investigating task %d (%d)\n", k, current_task_status);
 
@@ -465,8 +972,8 @@ taskID dag_end_task(CSOUND *csound, taskID i)
 
       // Try the same thing again but this time waiting on active or available task
       if (wait_on_current_tasks == 1) {
-        for (k=0; k<j; k++) {     /* seek next watch */
-          if (csound->dag_task_dep[j][k]==0) continue;
+        for (m=0; m<csound->dag_task_dep[j].npred; m++) { /* seek next watch */
+          k = csound->dag_task_dep[j].pred[m];
           current_task_status = ATOMIC_READ(csound->dag_task_status[k].s);
           //printf("investigating task %d (%d)\n", k, current_task_status);
 
@@ -494,10 +1001,14 @@ taskID dag_end_task(CSOUND *csound, taskID i)
           next_task = j; // Forward directly to the thread to save re-dispatch
         } else {
           ATOMIC_WRITE(csound->dag_task_status[j].s, AVAILABLE);
+          if (csound->dag_deques != NULL)
+            dag_deque_push(&csound->dag_deques[index], j);
+          released++;
         }
       }
       to_notify = next;
     }
+    if (released) dag_wake(csound, released);
     //dag_print_state(csound);
     return next_task;
 }
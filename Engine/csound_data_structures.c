@@ -350,6 +350,7 @@ PUBLIC void cs_hash_table_free(CSOUND* csound, CS_HASH_TABLE* hashTable) {
         item = next;
       }
     }
+    csound->Free(csound, hashTable->buckets);
     csound->Free(csound, hashTable);
 }
 
@@ -368,6 +369,7 @@ PUBLIC void cs_hash_table_mfree_complete(CSOUND* csound, CS_HASH_TABLE* hashTabl
         item = next;
       }
     }
+    csound->Free(csound, hashTable->buckets);
     csound->Free(csound, hashTable);
 }
 
@@ -390,6 +392,7 @@ PUBLIC void cs_hash_table_free_complete(CSOUND* csound, CS_HASH_TABLE* hashTable
         item = next;
       }
     }
+    csound->Free(csound, hashTable->buckets);
     csound->Free(csound, hashTable);
 }
 
@@ -56,6 +56,9 @@ int named_instr_alloc(CSOUND *csound, char *s, INSTRTXT *ip, int32 insno,
                       ENGINE_STATE *engineState, int merge);
 int check_instr_name(char *s);
 void free_instr_var_memory(CSOUND *, INSDS *);
+void insds_free(CSOUND *, INSTRTXT *, INSDS *);
+void insds_slab_free(CSOUND *, INSTRTXT *);
+void insds_slab_prewarm(CSOUND *, INSTRTXT *);
 void mergeState_enqueue(CSOUND *csound, ENGINE_STATE *e, TYPE_TABLE *t,
                         OPDS *ids);
 
@@ -943,9 +946,10 @@ void free_instrtxt(CSOUND *csound, INSTRTXT *instrtxt) {
     free_instr_var_memory(csound, active);
     if (active->opcod_iobufs != NULL)
       csound->Free(csound, active->opcod_iobufs);
-    csound->Free(csound, active);
+    insds_free(csound, ip, active);
     active = nxt;
   }
+  insds_slab_free(csound, ip);
   OPTXT *t = ip->nxtop;
   while (t) {
     OPTXT *s = t->nxtop;
@@ -999,7 +1003,7 @@ void add_to_deadpool(CSOUND *csound, INSTRTXT *instrtxt) {
     if (csound->dead_instr_pool[i] != NULL) {
       INSDS *active = csound->dead_instr_pool[i]->instance;
       while (active != NULL) {
-        if (active->actflg) {
+        if (active->actflg || active->reclaiming) {
           // add_to_deadpool(csound,csound->dead_instr_pool[i]);
           break;
         }
@@ -1083,7 +1087,7 @@ int named_instr_alloc(CSOUND *csound, char *s, INSTRTXT *ip, int32 insno,
     }
     INSDS *active = engineState->instrtxtp[inm->instno]->instance;
     while (active != NULL) {
-      if (active->actflg) {
+      if (active->actflg || active->reclaiming) {
         /* FIXME:  */
         /* this seems to be wiping memory that is still being used */
         // add_to_deadpool(csound, engineState->instrtxtp[inm->instno]);
@@ -1287,7 +1291,7 @@ void insert_instrtxt(CSOUND *csound, INSTRTXT *instrtxt, int32 instrNum,
     }
     INSDS *active = engineState->instrtxtp[instrNum]->instance;
     while (active != NULL && instrNum != 0) {
-      if (active->actflg) {
+      if (active->actflg || active->reclaiming) {
         add_to_deadpool(csound, engineState->instrtxtp[instrNum]);
         break;
       }
@@ -1477,6 +1481,7 @@ int engineState_merge(CSOUND *csound, ENGINE_STATE *engineState) {
     insprep(csound, current, current_state); /* run insprep() to connect ARGS */
     recalculateVarPoolMemory(csound,
                              current->varPool); /* recalculate var pool */
+    insds_slab_prewarm(csound, current);
   }
   /* now we need to patch up instr order */
   end = current_state->maxinsno;
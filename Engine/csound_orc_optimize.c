@@ -24,8 +24,13 @@
 
 #include "csoundCore.h"
 #include "csound_orc.h"
+#include "interlocks.h"
+#include "aops.h"
+#include <limits.h>
+#include <math.h>
 extern void print_tree(CSOUND *csound, char*, TREE *l);
 extern void delete_tree(CSOUND *csound, TREE *l);
+extern OENTRIES* find_opcode2(CSOUND*, char*);
 
 static TREE * create_fun_token(CSOUND *csound, TREE *right, char *fname)
 {
@@ -418,6 +423,576 @@ TREE* constant_fold(CSOUND *csound, TREE* root)
 }
 
 
+/* Per-instrument passes, run on the expanded statement list of each
+   instr and UDO body.  All of them leave the computed values bit for
+   bit unchanged: they only drop repeated work or move it to the init
+   pass where nothing at init time can observe the difference.
+
+   There is no pass for the intermediate variables the expression
+   compiler creates: remove_excess_assigns already folds each
+   "#k3 = op; x = #k3" pair into "x = op", and the synthetic values it
+   leaves are opcode arguments and conditions, which need a variable,
+   or i-time results copied into a k variable, which hoist_init_values
+   turns into a single copy at init. */
+
+static inline int is_statement(TREE *t)
+{
+    return (t->type == T_OPCODE || t->type == T_OPCODE0 || t->type == '=') &&
+      t->markup != NULL;
+}
+
+static inline int is_literal(TREE *a)
+{
+    return a->type == INTEGER_TOKEN || a->type == NUMBER_TOKEN;
+}
+
+/* a local (possibly synthetic) variable of rate c: i, k or a */
+static inline int local_var(char *s, char c)
+{
+    if (*s == '#') s++;
+    return *s == c;
+}
+
+static int takes_label(OENTRY *ep)
+{
+    return ep->intypes != NULL && strchr(ep->intypes, 'l') != NULL;
+}
+
+/* every argument is a plain name or number */
+static int leaf_args(TREE *t)
+{
+    TREE *a;
+    for (a = t->left; a != NULL; a = a->next)
+      if (a->left != NULL || a->right != NULL || a->value == NULL) return 0;
+    for (a = t->right; a != NULL; a = a->next)
+      if (a->left != NULL || a->right != NULL || a->value == NULL) return 0;
+    return 1;
+}
+
+static OENTRY *find_entry(CSOUND *csound, char *opname)
+{
+    OENTRIES *entries = find_opcode2(csound, opname);
+    OENTRY *ep = NULL;
+    int i;
+    for (i = 0; i < entries->count; i++)
+      if (strcmp(entries->entries[i]->opname, opname) == 0) {
+        ep = entries->entries[i];
+        break;
+      }
+    csound->Free(csound, entries);
+    return ep;
+}
+
+/* Arithmetic that reads only its arguments and writes only its result */
+static int pure_op(OENTRY *ep)
+{
+    static const char *names[] = {
+      "##add.", "##sub.", "##mul.", "##div.", "##pow.", "pow.", NULL
+    };
+    const char *s = NULL;
+    int i;
+    if (ep->useropinfo != NULL) return 0;
+    for (i = 0; names[i] != NULL; i++)
+      if (strncmp(ep->opname, names[i], strlen(names[i])) == 0) {
+        s = ep->opname + strlen(names[i]);
+        break;
+      }
+    if (s == NULL || *s == '\0') return 0;
+    for ( ; *s != '\0'; s++)
+      if (*s != 'i' && *s != 'k' && *s != 'a') return 0;
+    return 1;
+}
+
+static void set_op(CSOUND *csound, TREE *t, OENTRY *ep, char *name)
+{
+    t->markup = ep;
+    csound->Free(csound, t->value->lexeme);
+    t->value->lexeme = cs_strdup(csound, name);
+}
+
+/* pow(x, 2) -> x * x, and x / 2^n -> x * 2^-n.  Both are exact, so
+   unlike a general reciprocal this cannot change a single sample. */
+static void strength_reduce(CSOUND *csound, TREE *t)
+{
+    OENTRY *ep = (OENTRY *) t->markup, *mul;
+    TREE *x = t->right, *y;
+    char *rate, name[16];
+    double c;
+
+    if (x == NULL || (y = x->next) == NULL || !is_literal(y) || !leaf_args(t))
+      return;
+    c = cs_strtod(y->value->lexeme, NULL);
+    rate = strchr(ep->opname, '.');
+    if (rate == NULL) return;
+    if (strncmp(ep->opname, "pow.", 4) == 0 ||
+        strncmp(ep->opname, "##pow.", 6) == 0) {
+      TREE *norm = y->next;
+      ORCTOKEN *tok;
+      if (c != 2.0 || rate[2] != '\0') return;
+      if (norm != NULL) {
+        double n;
+        if (!is_literal(norm) || norm->next != NULL) return;
+        n = cs_strtod(norm->value->lexeme, NULL);
+        if (n != 0.0 && n != 1.0) return;
+      }
+      snprintf(name, sizeof(name), "##mul.%c%c", rate[1], rate[1]);
+      if ((mul = find_entry(csound, name)) == NULL) return;
+      tok = make_token(csound, x->value->lexeme);
+      tok->type = x->value->type;
+      tok->value = x->value->value;
+      tok->fvalue = x->value->fvalue;
+      csound->Free(csound, y->value->lexeme);
+      csound->Free(csound, y->value);
+      y->value = tok;
+      y->type = x->type;
+      y->markup = x->markup;
+      y->next = NULL;
+      delete_tree(csound, norm);
+      set_op(csound, t, mul, "##mul");
+    }
+    else if (strncmp(ep->opname, "##div.", 6) == 0 && rate[2] != 'a') {
+      int e;
+      char buf[64];
+      if (c == 0.0 || fabs(c) < 0x1p-64 || fabs(c) > 0x1p64 ||
+          fabs(frexp(c, &e)) != 0.5)
+        return;
+      snprintf(name, sizeof(name), "##mul%s", rate);
+      if ((mul = find_entry(csound, name)) == NULL) return;
+      c = 1.0 / c;
+      snprintf(buf, 60, "%.20g", c);
+      csound->Free(csound, y->value->lexeme);
+      y->value->lexeme = cs_strdup(csound, buf);
+      y->value->type = y->type = NUMBER_TOKEN;
+      y->value->fvalue = c;
+      set_op(csound, t, mul, "##mul");
+    }
+}
+
+/* rename every later use of a variable */
+static void rename_uses(CSOUND *csound, TREE *t, char *from, char *to)
+{
+    for ( ; t != NULL; t = t->next) {
+      if (t->value != NULL && t->value->lexeme != NULL &&
+          strcmp(t->value->lexeme, from) == 0) {
+        csound->Free(csound, t->value->lexeme);
+        t->value->lexeme = cs_strdup(csound, to);
+      }
+      rename_uses(csound, t->left, from, to);
+      rename_uses(csound, t->right, from, to);
+    }
+}
+
+/* a pure op computing a single synthetic value from locals and numbers */
+static int cse_candidate(TREE *t)
+{
+    TREE *a;
+    if (!pure_op((OENTRY *) t->markup) || !leaf_args(t) ||
+        t->left == NULL || t->left->next != NULL ||
+        t->left->value->lexeme[0] != '#')
+      return 0;
+    for (a = t->right; a != NULL; a = a->next) {
+      char *s = a->value->lexeme;
+      if (!is_literal(a) &&
+          !(a->type == T_IDENT &&
+            (local_var(s, 'i') || local_var(s, 'k') || local_var(s, 'a'))))
+        return 0;
+    }
+    return 1;
+}
+
+static int same_expr(TREE *t, TREE *u)
+{
+    TREE *a, *b;
+    if (t->markup != u->markup) return 0;
+    for (a = t->right, b = u->right; a != NULL && b != NULL;
+         a = a->next, b = b->next)
+      if (strcmp(a->value->lexeme, b->value->lexeme) != 0) return 0;
+    return a == b;
+}
+
+static int uses_var(TREE *t, char *name)
+{
+    TREE *a;
+    if (strcmp(t->left->value->lexeme, name) == 0) return 1;
+    for (a = t->right; a != NULL; a = a->next)
+      if (strcmp(a->value->lexeme, name) == 0) return 1;
+    return 0;
+}
+
+#define CSE_MAX (64)
+
+static void kill_var(TREE **avail, int *n, char *name)
+{
+    int i, j;
+    for (i = j = 0; i < *n; i++)
+      if (!uses_var(avail[i], name)) avail[j++] = avail[i];
+    *n = j;
+}
+
+/* Within a straight run of statements (labels, jumps and UDO calls end
+   one), a repeated expression reuses the earlier synthetic result. */
+static void common_subexpressions(CSOUND *csound, TREE *body)
+{
+    TREE *avail[CSE_MAX], *prev = NULL, *t = body, *a;
+    int n = 0, i;
+
+    while (t != NULL) {
+      OENTRY *ep = (OENTRY *) t->markup;
+      if (!is_statement(t) || ep->useropinfo != NULL || takes_label(ep)) {
+        n = 0;
+        prev = t; t = t->next;
+        continue;
+      }
+      if (cse_candidate(t)) {
+        for (i = 0; i < n && !same_expr(avail[i], t); i++);
+        if (i < n) {
+          TREE *nxt = t->next;
+          rename_uses(csound, nxt, t->left->value->lexeme,
+                      avail[i]->left->value->lexeme);
+          prev->next = nxt;
+          t->next = NULL;
+          delete_tree(csound, t);
+          t = nxt;
+          continue;
+        }
+      }
+      for (a = t->left; a != NULL; a = a->next)
+        if (a->value != NULL) kill_var(avail, &n, a->value->lexeme);
+      if (ep->flags & WI)
+        for (a = t->right; a != NULL; a = a->next)
+          if (a->value != NULL) kill_var(avail, &n, a->value->lexeme);
+      if (cse_candidate(t)) {
+        if (n == CSE_MAX) {
+          memmove(avail, avail + 1, (CSE_MAX - 1) * sizeof(TREE *));
+          n--;
+        }
+        avail[n++] = t;
+      }
+      prev = t; t = t->next;
+    }
+}
+
+typedef struct {
+    int     writes;             /* statements writing the variable */
+    int     lastw;              /* index of the last of them */
+    int     perfw;              /* written at performance time */
+    int     firstr;             /* index of the first statement reading it */
+    int     initr;              /* read by an opcode with an init routine */
+    int     ivalued;            /* constant once the init pass is done */
+} VARUSE;
+
+static VARUSE *var_use(CSOUND *csound, CS_HASH_TABLE *uses, char *name)
+{
+    VARUSE *u = cs_hash_table_get(csound, uses, name);
+    if (u == NULL) {
+      u = csound->Calloc(csound, sizeof(VARUSE));
+      u->firstr = INT_MAX;
+      cs_hash_table_put(csound, uses, name, u);
+    }
+    return u;
+}
+
+/* "=.k", "##mul.kk" and the like, with an i-time twin doing the same */
+static OENTRY *init_twin(CSOUND *csound, OENTRY *ep)
+{
+    char name[32], *s;
+    OENTRY *ip;
+    if (strcmp(ep->opname, "=.k") != 0 && !pure_op(ep)) return NULL;
+    if (strlen(ep->opname) >= sizeof(name) ||
+        (s = strchr(ep->opname, '.')) == NULL)
+      return NULL;
+    strcpy(name, ep->opname);
+    for (s = name + (s - ep->opname) + 1; *s != '\0'; s++) {
+      if (*s != 'k') return NULL;
+      *s = 'i';
+    }
+    ip = find_entry(csound, name);
+    if (ip == NULL || ip->iopadr != ep->kopadr || ip->dsblksiz != ep->dsblksiz)
+      return NULL;
+    return ip;
+}
+
+/* A k-rate statement whose inputs are all fixed after init, whose k
+   output is written nowhere else and is only read later by perf-time
+   opcodes, gives the same value every k-cycle: compute it once in the
+   init pass instead.  Only done for bodies without labels or jumps, so
+   that every statement runs in text order on every pass. */
+static void hoist_init_values(CSOUND *csound, TREE *body)
+{
+    CS_HASH_TABLE *uses = cs_hash_table_create(csound);
+    TREE *t, *a;
+    int j;
+
+    for (t = body, j = 0; t != NULL; t = t->next, j++) {
+      OENTRY *ep = (OENTRY *) t->markup;
+      for (a = t->right; a != NULL; a = a->next) {
+        VARUSE *u;
+        if (is_literal(a)) continue;
+        u = var_use(csound, uses, a->value->lexeme);
+        if (u->firstr == INT_MAX) u->firstr = j;
+        if (ep->thread == 0 || (ep->thread & 1)) u->initr = 1;
+        if (ep->flags & WI) {
+          u->writes++; u->lastw = j; u->perfw = 1;
+        }
+      }
+      for (a = t->left; a != NULL; a = a->next) {
+        VARUSE *u = var_use(csound, uses, a->value->lexeme);
+        u->writes++; u->lastw = j;
+        if (ep->thread != 1) u->perfw = 1;
+      }
+    }
+    for (t = body; t != NULL; t = t->next)
+      for (a = t->left; a != NULL; a = a->next) {
+        VARUSE *u = var_use(csound, uses, a->value->lexeme);
+        u->ivalued = local_var(a->value->lexeme, 'i') && !u->perfw;
+      }
+
+    for (t = body, j = 0; t != NULL; t = t->next, j++) {
+      OENTRY *ip;
+      VARUSE *out;
+      if (t->left == NULL || t->left->next != NULL ||
+          !local_var(t->left->value->lexeme, 'k'))
+        continue;
+      out = var_use(csound, uses, t->left->value->lexeme);
+      if (out->writes != 1 || out->firstr <= j || out->initr) continue;
+      for (a = t->right; a != NULL; a = a->next) {
+        VARUSE *u;
+        if (is_literal(a)) continue;
+        u = cs_hash_table_get(csound, uses, a->value->lexeme);
+        if (u == NULL || !u->ivalued || u->lastw >= j) break;
+      }
+      if (a != NULL || t->right == NULL ||
+          (ip = init_twin(csound, (OENTRY *) t->markup)) == NULL)
+        continue;
+      if (UNLIKELY(PARSER_DEBUG))
+        csound->Message(csound, "init pass: %s %s\n",
+                        ip->opname, t->left->value->lexeme);
+      t->markup = ip;
+      out->perfw = 0;
+      out->ivalued = 1;
+    }
+    cs_hash_table_mfree_complete(csound, uses);
+}
+
+/* Chains of a-rate + - * / become one ##fused opcode (see aops.c):
+   a synthetic a-rate result read only by a later op in the same
+   straight run is computed inside that op instead of in a variable. */
+
+static OENTRY fused_away;       /* markup of statements merged into others */
+
+/* the operator of a statement ##fused can absorb, else 0 */
+static char fusable_op(TREE *t)
+{
+    const char *s = ((OENTRY *) t->markup)->opname;
+    char op;
+    if (strncmp(s, "##", 2) != 0 || strlen(s) != 8 || s[5] != '.') return 0;
+    if (strncmp(s + 2, "add", 3) == 0) op = '+';
+    else if (strncmp(s + 2, "sub", 3) == 0) op = '-';
+    else if (strncmp(s + 2, "mul", 3) == 0) op = '*';
+    else if (strncmp(s + 2, "div", 3) == 0) op = '/';
+    else return 0;
+    if (strcmp(s + 6, "aa") != 0 && strcmp(s + 6, "ak") != 0 &&
+        strcmp(s + 6, "ka") != 0)
+      return 0;
+    return leaf_args(t) ? op : 0;
+}
+
+static int is_fused(TREE *t)
+{
+    return strcmp(((OENTRY *) t->markup)->opname, "##fused") == 0;
+}
+
+/* number of operands of a plain or fused statement */
+static int fused_count(TREE *t)
+{
+    TREE *a;
+    int n = 0;
+    for (a = is_fused(t) ? t->right->next : t->right; a != NULL; a = a->next)
+      n++;
+    return n;
+}
+
+/* append the program of s (shifted by base operands) to buf, detach
+   its operands and return them */
+static TREE *take_program(TREE *s, char *buf, int base)
+{
+    char *p = buf + strlen(buf), *q;
+    TREE *ops;
+    if (is_fused(s)) {
+      ops = s->right->next;
+      for (q = s->right->value->lexeme + 1; *q != '"'; q++)
+        *p++ = (*q >= 'a' && *q <= 'z') ? *q + base : *q;
+      s->right->next = NULL;
+    }
+    else {
+      ops = s->right;
+      *p++ = 'a' + base;
+      *p++ = 'b' + base;
+      *p++ = fusable_op(s);
+      s->right = NULL;
+    }
+    *p = '\0';
+    return ops;
+}
+
+static TREE *last_of(TREE *t)
+{
+    while (t->next != NULL) t = t->next;
+    return t;
+}
+
+static void count_reads(CSOUND *csound, CS_HASH_TABLE *reads, TREE *a)
+{
+    for ( ; a != NULL; a = a->next) {
+      if (a->value != NULL && a->value->lexeme != NULL &&
+          a->value->lexeme[0] == '#' && local_var(a->value->lexeme, 'a')) {
+        int *cnt = cs_hash_table_get(csound, reads, a->value->lexeme);
+        if (cnt == NULL) {
+          cnt = csound->Calloc(csound, sizeof(int));
+          cs_hash_table_put(csound, reads, a->value->lexeme, cnt);
+        }
+        (*cnt)++;
+      }
+      count_reads(csound, reads, a->left);
+      count_reads(csound, reads, a->right);
+    }
+}
+
+#define FUSE_MAX (64)
+
+static void fuse_arithmetic(CSOUND *csound, TREE **body)
+{
+    CS_HASH_TABLE *reads = cs_hash_table_create(csound);
+    OENTRY *fused = find_entry(csound, "##fused");
+    TREE *defs[FUSE_MAX], *t, *a, **pt;
+    int n = 0, i;
+
+    if (fused == NULL) {
+      cs_hash_table_free(csound, reads);
+      return;
+    }
+    for (t = *body; t != NULL; t = t->next) {
+      count_reads(csound, reads, t->right);
+      for (a = t->left; a != NULL; a = a->next) {
+        count_reads(csound, reads, a->left);
+        count_reads(csound, reads, a->right);
+      }
+    }
+
+    for (t = *body; t != NULL; t = t->next) {
+      OENTRY *ep = (OENTRY *) t->markup;
+      char op;
+      if (!is_statement(t) || ep->useropinfo != NULL || takes_label(ep)) {
+        n = 0;
+        continue;
+      }
+      if ((op = fusable_op(t)) != 0) {
+        TREE *from[2] = { NULL, NULL };
+        int k, count = 0;
+        for (a = t->right, k = 0; a != NULL; a = a->next, k++) {
+          int *cnt = cs_hash_table_get(csound, reads, a->value->lexeme);
+          from[k] = NULL;
+          if (cnt != NULL && *cnt == 1)
+            for (i = 0; i < n; i++)
+              if (strcmp(defs[i]->left->value->lexeme,
+                         a->value->lexeme) == 0) {
+                from[k] = defs[i];
+                break;
+              }
+          count += (from[k] != NULL ? fused_count(from[k]) : 1);
+        }
+        while (count > FUSED_ARGS) {    /* too long: keep the larger half */
+          k = (from[1] == NULL ||
+               (from[0] != NULL &&
+                fused_count(from[0]) <= fused_count(from[1]))) ? 0 : 1;
+          count -= fused_count(from[k]) - 1;
+          from[k] = NULL;
+        }
+        if (from[0] != NULL || from[1] != NULL) {
+          char prog[2 * FUSED_ARGS + 3] = "\"";
+          TREE *x = t->right, *y = t->right->next, *ops, *str;
+          x->next = NULL;
+          if (from[0] != NULL) {
+            delete_tree(csound, x);
+            x = take_program(from[0], prog, 0);
+          }
+          else strcat(prog, "a");
+          k = 0;
+          for (a = x; a != NULL; a = a->next) k++;
+          if (from[1] != NULL) {
+            delete_tree(csound, y);
+            y = take_program(from[1], prog, k);
+          }
+          else {
+            size_t l = strlen(prog);
+            prog[l] = 'a' + k;
+            prog[l + 1] = '\0';
+          }
+          i = strlen(prog);
+          prog[i] = op;
+          prog[i + 1] = '"';
+          prog[i + 2] = '\0';
+          ops = x;
+          last_of(x)->next = y;
+          str = make_leaf(csound, t->line, t->locn, STRING_TOKEN,
+                          make_token(csound, prog));
+          str->next = ops;
+          t->right = str;
+          set_op(csound, t, fused, "##fused");
+          for (k = 0; k < 2; k++)
+            if (from[k] != NULL) {
+              for (i = 0; defs[i] != from[k]; i++);
+              memmove(&defs[i], &defs[i + 1], (n - i - 1) * sizeof(TREE *));
+              n--;
+              from[k]->markup = &fused_away;
+            }
+        }
+      }
+      /* a def whose inputs change before its reader cannot move there */
+      for (a = t->left; a != NULL; a = a->next)
+        if (a->value != NULL) kill_var(defs, &n, a->value->lexeme);
+      if (ep->flags & WI)
+        for (a = t->right; a != NULL; a = a->next)
+          if (a->value != NULL) kill_var(defs, &n, a->value->lexeme);
+      if ((fusable_op(t) || t->markup == fused) &&
+          t->left->value->lexeme[0] == '#') {
+        if (n == FUSE_MAX) {
+          memmove(defs, defs + 1, (FUSE_MAX - 1) * sizeof(TREE *));
+          n--;
+        }
+        defs[n++] = t;
+      }
+    }
+
+    for (pt = body; *pt != NULL; ) {
+      if ((*pt)->markup == &fused_away) {
+        t = *pt;
+        *pt = t->next;
+        t->next = NULL;
+        delete_tree(csound, t);
+      }
+      else pt = &(*pt)->next;
+    }
+    cs_hash_table_mfree_complete(csound, reads);
+}
+
+static void optimize_body(CSOUND *csound, TREE **body)
+{
+    TREE *t;
+    int straight = 1;
+    for (t = *body; t != NULL; t = t->next) {
+      if (!is_statement(t) || takes_label((OENTRY *) t->markup) ||
+          !leaf_args(t)) {
+        straight = 0;
+        continue;
+      }
+      strength_reduce(csound, t);
+    }
+    common_subexpressions(csound, *body);
+    if (straight) hoist_init_values(csound, *body);
+    fuse_arithmetic(csound, body);
+}
+
 /* Optimizes tree (expressions, etc.) */
 TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
 {
@@ -433,8 +1008,11 @@ TREE * csound_orc_optimize(CSOUND *csound, TREE *root)
       root = root->next;
     }
     //#ifdef JPFF
-    return remove_excess_assigns(csound,original);
-    //#else
-    //return original;
+    original = remove_excess_assigns(csound,original);
     //#endif
+    if (csound->oparms->exprOpt)
+      for (root = original; root != NULL; root = root->next)
+        if (root->type == INSTR_TOKEN || root->type == UDO_TOKEN)
+          optimize_body(csound, &root->right);
+    return original;
 }
@@ -109,15 +109,15 @@ OENTRY opcodlst_1[] = {
   { "ctrlinit",S(CTLINIT),0,1,      "",  "im", ctrlinit, NULL, NULL, NULL},
   { "massign",S(MASSIGN), 0,1,      "",  "iip",massign_p, NULL, NULL, NULL},
   { "massign.iS",S(MASSIGNS), 0,1,  "",  "iSp",massign_S, NULL, NULL, NULL},
-  { "turnon", S(TURNON),  0,1,      "",     "io", turnon, NULL, NULL, NULL},
-  { "turnon.S", S(TURNON),  0,1,    "",     "So", turnon_S, NULL, NULL, NULL},
+  { "turnon", S(TURNON),  SQ,1,      "",     "io", turnon, NULL, NULL, NULL},
+  { "turnon.S", S(TURNON),  SQ,1,    "",     "So", turnon_S, NULL, NULL, NULL},
   { "remoteport", S(REMOTEPORT), 0,1, "",  "i", remoteport, NULL, NULL, NULL},
   { "insremot",S(INSREMOT),0,1,     "",     "SSm",insremot, NULL, NULL, NULL},
   { "midremot",S(MIDREMOT),0,1,     "",     "SSm",midremot, NULL, NULL, NULL},
   { "insglobal",S(INSGLOBAL),0,1,   "",     "Sm", insglobal, NULL, NULL, NULL},
   { "midglobal",S(MIDGLOBAL),0,1,   "",     "Sm", midglobal, NULL, NULL, NULL},
   { "ihold",  S(LINK),0,    1,      "",     "",     ihold, NULL, NULL, NULL  },
-  { "turnoff",S(LINK),0,    2,      "",     "",     NULL,   turnoff, NULL, NULL },
+  { "turnoff",S(LINK),SQ,    2,      "",     "",     NULL,   turnoff, NULL, NULL },
   {  "=.S",   S(STRCPY_OP),0,   1,  "S",    "S",
      (SUBR) strcpy_opcode_S, NULL, (SUBR) NULL, NULL    },
   {  "=.T",   S(STRGET_OP),0,   1,  "S",    "i",
@@ -185,6 +185,7 @@ OENTRY opcodlst_1[] = {
   { "##mul.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   mulaa   },
   { "##div.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   divaa   },
   { "##mod.aa",  S(AOP),0,    2,      "a",    "aa",   NULL,   modaa   },
+  { "##fused",   S(FUSED),0,  3,      "a",    "SM",   fusedset, fused   },
   { "##addin.i", S(ASSIGN),0, 1,      "i",    "i",    addin,  NULL    },
   { "##addin.k", S(ASSIGN),0, 2,      "k",    "k",    NULL,   addin   },
   { "##addin.K", S(ASSIGN),0, 2,      "a",    "k",    NULL,   addinak },
@@ -204,8 +205,8 @@ OENTRY opcodlst_1[] = {
   { "round.i",S(EVAL),0,    1,      "i",    "i",    int1_round              },
   { "floor.i",S(EVAL),0,    1,      "i",    "i",    int1_floor              },
   { "ceil.i", S(EVAL),0,    1,      "i",    "i",    int1_ceil               },
-  { "rnd.i",  S(EVAL),0,    1,      "i",    "i",    rnd1                    },
-  { "birnd.i",S(EVAL),0,    1,      "i",    "i",    birnd1                  },
+  { "rnd.i",  S(EVAL),SQ,    1,      "i",    "i",    rnd1                    },
+  { "birnd.i",S(EVAL),SQ,    1,      "i",    "i",    birnd1                  },
   { "abs.i",  S(EVAL),0,    1,      "i",    "i",    abs1                    },
   { "exp.i",  S(EVAL),0,    1,      "i",    "i",    exp01                   },
   { "log.i",  S(EVAL),0,    1,      "i",    "i",    log01                   },
@@ -229,8 +230,8 @@ OENTRY opcodlst_1[] = {
   { "round.k",S(EVAL),0,    2,      "k",    "k",    NULL,   int1_round      },
   { "floor.k",S(EVAL),0,    2,      "k",    "k",    NULL,   int1_floor      },
   { "ceil.k", S(EVAL),0,    2,      "k",    "k",    NULL,   int1_ceil       },
-  { "rnd.k",  S(EVAL),0,    2,      "k",    "k",    NULL,   rnd1            },
-  { "birnd.k",S(EVAL),0,    2,      "k",    "k",    NULL,   birnd1          },
+  { "rnd.k",  S(EVAL),SQ,    2,      "k",    "k",    NULL,   rnd1            },
+  { "birnd.k",S(EVAL),SQ,    2,      "k",    "k",    NULL,   birnd1          },
   { "abs.k",  S(EVAL),0,    2,      "k",    "k",    NULL,   abs1            },
   { "exp.k",  S(EVAL),0,    2,      "k",    "k",    NULL,   exp01           },
   { "log.k",  S(EVAL),0,    2,      "k",    "k",    NULL,   log01           },
@@ -341,8 +342,10 @@ OENTRY opcodlst_1[] = {
   { "cossegb.a", S(COSSEG),0, 3,      "a",    "iim",  csgset_bkpt, cosseg  },
   { "cossegr", S(COSSEG),0,  3,     "k",    "iim",  csgrset, kcssegr, NULL  },
   { "cossegr.a", S(COSSEG),0,  3,     "a",    "iim",  csgrset, cossegr  },
-  { "linseg", S(LINSEG),0,  3,      "k",    "iim",  lsgset, klnseg, NULL },
-  { "linseg.a", S(LINSEG),0,  3,      "a",    "iim",  lsgset, linseg  },
+  { "linseg", S(LINSEG),0,  3,      "k",    "iim",  lsgset, klnseg, NULL,
+    NULL, klnseg_multi },
+  { "linseg.a", S(LINSEG),0,  3,      "a",    "iim",  lsgset, linseg, NULL,
+    NULL, linseg_multi },
   { "linsegb", S(LINSEG),0,  3,     "k",    "iim", lsgset_bkpt, klnseg, NULL  },
   { "linsegb.a", S(LINSEG),0,  3,     "a",    "iim", lsgset_bkpt, linseg  },
   { "linsegr",S(LINSEG),0,  3,      "k",    "iim",  lsgrset,klnsegr,NULL },
@@ -431,7 +434,8 @@ OENTRY opcodlst_1[] = {
      { "oscil.aa", S(POSC),TR, 3, "a", "aajo", posc_set,  poscaa },
      { "oscil3.kk",  S(POSC),TR,  7, "s", "kkjo", posc_set, kposc3, posc3 },
   */
-  { "oscili.a",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckki  },
+  { "oscili.a",S(OSC),TR,   3,      "a",    "kkjo", oscset, osckki, NULL,
+    NULL, osckki_multi },
   { "oscili.kk",S(OSC),TR,   3,      "k",   "kkjo", oscset, koscli, NULL  },
   { "oscili.ka",S(OSC),TR,   3,      "a",   "kajo", oscset,   osckai  },
   { "oscili.ak",S(OSC),TR,   3,      "a",   "akjo", oscset,   oscaki  },
@@ -463,12 +467,12 @@ OENTRY opcodlst_1[] = {
   { "buzz",   S(BUZZ),TR,  3,      "a",  "xxkio",  bzzset,   buzz    },
   { "gbuzz",  S(GBUZZ),TR,  3,      "a",  "xxkkkio",gbzset,   gbuzz   },
   { "pluck",  S(PLUCK), TR, 3,      "a",  "kkiiioo",plukset,   pluck   },
-  { "rand",   S(RAND),0,    3,      "a",    "xvoo", rndset,  arand   },
-  { "rand.k",   S(RAND),0,    3,      "k",    "xvoo", rndset, krand,  NULL  },
-  { "randh",  S(RANDH),0,   3,      "a",    "xxvoo", rhset, randh   },
-  { "randh.k",  S(RANDH),0,   3,      "k",    "xxvoo", rhset, krandh, NULL   },
-  { "randi",  S(RANDI),0,   3,      "a",    "xxvoo", riset, randi   },
-  { "randi.k",  S(RANDI),0,   3,      "k",    "xxvoo", riset, krandi, NULL  },
+  { "rand",   S(RAND),SQ,    3,      "a",    "xvoo", rndset,  arand   },
+  { "rand.k",   S(RAND),SQ,    3,      "k",    "xvoo", rndset, krand,  NULL  },
+  { "randh",  S(RANDH),SQ,   3,      "a",    "xxvoo", rhset, randh   },
+  { "randh.k",  S(RANDH),SQ,   3,      "k",    "xxvoo", rhset, krandh, NULL   },
+  { "randi",  S(RANDI),SQ,   3,      "a",    "xxvoo", riset, randi   },
+  { "randi.k",  S(RANDI),SQ,   3,      "k",    "xxvoo", riset, krandi, NULL  },
   { "port",   S(PORT),0,    3,      "k",    "kio",  porset, port            },
   { "tone.k", S(TONE),0,    3,      "a",    "ako",  tonset,   tone    },
   { "tonex.k",S(TONEX),0,   3,      "a",    "akoo", tonsetx,  tonex   },
@@ -489,14 +493,14 @@ OENTRY opcodlst_1[] = {
   { "balance",S(BALANCE),0, 3,      "a",    "aaqo", balnset,   balance },
   { "balance2",S(BALANCE),0, 3,      "a",    "aaqo", balnset,   balance2 },
   { "pan",    S(PAN),0,   3, "aaaa", "akkioo",(SUBR)panset, (SUBR)pan  },
-  { "soundin",S(DISKIN2),0,3,"mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm","Soooo",
+  { "soundin",S(DISKIN2),TD,3,"mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm","Soooo",
     sndinset_S, soundin   },
-  { "soundin.i",S(DISKIN2),0,3,"mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm","ioooo",
+  { "soundin.i",S(DISKIN2),TD,3,"mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm","ioooo",
     sndinset, soundin   },
-  { "soundout",S(SNDOUT), _QQ, 3,   "",    "aSo",  sndoutset_S, soundout  },
-  { "soundout.i",S(SNDOUT), _QQ, 3,   "",    "aio",  sndoutset, soundout  },
-  { "soundouts",S(SNDOUTS),_QQ, 3,  "",    "aaSo", sndoutset_S, soundouts },
-  { "soundouts.i",S(SNDOUTS),_QQ, 3,  "",    "aaio", sndoutset, soundouts },
+  { "soundout",S(SNDOUT), _QQ|TD, 3,   "",    "aSo",  sndoutset_S, soundout  },
+  { "soundout.i",S(SNDOUT), _QQ|TD, 3,   "",    "aio",  sndoutset, soundout  },
+  { "soundouts",S(SNDOUTS),_QQ|TD, 3,  "",    "aaSo", sndoutset_S, soundouts },
+  { "soundouts.i",S(SNDOUTS),_QQ|TD, 3,  "",    "aaio", sndoutset, soundouts },
   { "in.a",   S(INM),0,     2,      "a",    "",     NULL,   in      },
   { "in.s",   S(INS),0,     2,      "aa",    "",     NULL,   ins      },
   { "in.A",   S(INA),0,     2,      "a[]",  "",     NULL,   inarray },
@@ -562,71 +566,71 @@ OENTRY opcodlst_1[] = {
   { "##pow.k",  S(POW),0,   2,      "k",    "kkp",  NULL,    ipow,  NULL    },
   { "##pow.a",  S(POW),0,   2,      "a",    "akp",  NULL,  apow    },
   { "oscilx",   S(OSCILN), TR, 3,   "a",    "kiii", oscnset,   osciln  },
-  { "linrand.i",S(PRAND),0, 1,      "i",    "k",    iklinear, NULL, NULL    },
-  { "linrand.k",S(PRAND),0, 2,      "k",    "k",    NULL, iklinear, NULL    },
-  { "linrand.a",S(PRAND),0, 2,      "a",    "k",    NULL,     alinear },
-  { "trirand.i",S(PRAND),0, 1,      "i",    "k",    iktrian, NULL,  NULL    },
-  { "trirand.k",S(PRAND),0, 2,      "k",    "k",    NULL, iktrian,  NULL    },
-  { "trirand.a",S(PRAND),0, 2,      "a",    "k",    NULL,     atrian  },
-  { "exprand.i",S(PRAND),0, 1,      "i",    "k",    ikexp, NULL,    NULL    },
-  { "exprand.k",S(PRAND),0, 2,      "k",    "k",    NULL,    ikexp, NULL    },
-  { "exprand.a",S(PRAND),0, 2,      "a",    "k",    NULL,     aexp    },
-  { "bexprnd.i",S(PRAND),0, 1,      "i",    "k",    ikbiexp, NULL,  NULL    },
-  { "bexprnd.k",S(PRAND),0, 2,      "k",    "k",    NULL, ikbiexp,  NULL    },
-  { "bexprnd.a",S(PRAND),0, 2,      "a",    "k",    NULL,     abiexp  },
-  { "cauchy.i", S(PRAND),0, 1,      "i",    "k",    ikcauchy, NULL, NULL    },
-  { "cauchy.k", S(PRAND),0, 2,      "k",    "k",    NULL, ikcauchy, NULL    },
-  { "cauchy.a", S(PRAND),0, 2,      "a",    "k",    NULL,  acauchy },
-  { "pcauchy.i",S(PRAND),0, 1,      "i",    "k",    ikpcauchy, NULL,NULL    },
-  { "pcauchy.k",S(PRAND),0, 2,      "k",    "k",    NULL, ikpcauchy,NULL    },
-  { "pcauchy.a",S(PRAND),0, 2,      "a",    "k",    NULL,  apcauchy},
-  { "poisson.i",S(PRAND),0, 1,      "i",    "k",    ikpoiss, NULL,  NULL    },
-  { "poisson.k",S(PRAND),0, 2,      "k",    "k",    NULL, ikpoiss,  NULL    },
-  { "poisson.a",S(PRAND),0, 2,      "a",    "k",    NULL,  apoiss  },
-  { "gauss.i" , S(PRAND),0, 1,      "i",    "k",    ikgaus,  NULL,  NULL    },
-  { "gauss.k" , S(PRAND),0, 2,      "k",    "k",    NULL, ikgaus,   NULL    },
-  { "gauss.a" , S(PRAND),0, 2,      "a",    "k",    NULL,  agaus   },
-  { "weibull.i",S(PRAND),0, 1,      "i",    "kk",   ikweib,  NULL,  NULL    },
-  { "weibull.k",S(PRAND),0, 2,      "k",    "kk",   NULL, ikweib,   NULL    },
-  { "weibull.a",S(PRAND),0, 2,      "a",    "kk",   NULL,  aweib   },
-  { "betarand.i",S(PRAND),0,1,      "i",    "kkk",  ikbeta, NULL,  NULL     },
-  { "betarand.k",S(PRAND),0,2,      "k",    "kkk",  NULL,   ikbeta,NULL     },
-  { "betarand.a",S(PRAND),0,2,      "a",    "kkk",  NULL,  abeta    },
-  { "seed",     S(PRAND),0, 1,      "",     "i",    seedrand, NULL, NULL    },
+  { "linrand.i",S(PRAND),SQ, 1,      "i",    "k",    iklinear, NULL, NULL    },
+  { "linrand.k",S(PRAND),SQ, 2,      "k",    "k",    NULL, iklinear, NULL    },
+  { "linrand.a",S(PRAND),SQ, 2,      "a",    "k",    NULL,     alinear },
+  { "trirand.i",S(PRAND),SQ, 1,      "i",    "k",    iktrian, NULL,  NULL    },
+  { "trirand.k",S(PRAND),SQ, 2,      "k",    "k",    NULL, iktrian,  NULL    },
+  { "trirand.a",S(PRAND),SQ, 2,      "a",    "k",    NULL,     atrian  },
+  { "exprand.i",S(PRAND),SQ, 1,      "i",    "k",    ikexp, NULL,    NULL    },
+  { "exprand.k",S(PRAND),SQ, 2,      "k",    "k",    NULL,    ikexp, NULL    },
+  { "exprand.a",S(PRAND),SQ, 2,      "a",    "k",    NULL,     aexp    },
+  { "bexprnd.i",S(PRAND),SQ, 1,      "i",    "k",    ikbiexp, NULL,  NULL    },
+  { "bexprnd.k",S(PRAND),SQ, 2,      "k",    "k",    NULL, ikbiexp,  NULL    },
+  { "bexprnd.a",S(PRAND),SQ, 2,      "a",    "k",    NULL,     abiexp  },
+  { "cauchy.i", S(PRAND),SQ, 1,      "i",    "k",    ikcauchy, NULL, NULL    },
+  { "cauchy.k", S(PRAND),SQ, 2,      "k",    "k",    NULL, ikcauchy, NULL    },
+  { "cauchy.a", S(PRAND),SQ, 2,      "a",    "k",    NULL,  acauchy },
+  { "pcauchy.i",S(PRAND),SQ, 1,      "i",    "k",    ikpcauchy, NULL,NULL    },
+  { "pcauchy.k",S(PRAND),SQ, 2,      "k",    "k",    NULL, ikpcauchy,NULL    },
+  { "pcauchy.a",S(PRAND),SQ, 2,      "a",    "k",    NULL,  apcauchy},
+  { "poisson.i",S(PRAND),SQ, 1,      "i",    "k",    ikpoiss, NULL,  NULL    },
+  { "poisson.k",S(PRAND),SQ, 2,      "k",    "k",    NULL, ikpoiss,  NULL    },
+  { "poisson.a",S(PRAND),SQ, 2,      "a",    "k",    NULL,  apoiss  },
+  { "gauss.i" , S(PRAND),SQ, 1,      "i",    "k",    ikgaus,  NULL,  NULL    },
+  { "gauss.k" , S(PRAND),SQ, 2,      "k",    "k",    NULL, ikgaus,   NULL    },
+  { "gauss.a" , S(PRAND),SQ, 2,      "a",    "k",    NULL,  agaus   },
+  { "weibull.i",S(PRAND),SQ, 1,      "i",    "kk",   ikweib,  NULL,  NULL    },
+  { "weibull.k",S(PRAND),SQ, 2,      "k",    "kk",   NULL, ikweib,   NULL    },
+  { "weibull.a",S(PRAND),SQ, 2,      "a",    "kk",   NULL,  aweib   },
+  { "betarand.i",S(PRAND),SQ,1,      "i",    "kkk",  ikbeta, NULL,  NULL     },
+  { "betarand.k",S(PRAND),SQ,2,      "k",    "kkk",  NULL,   ikbeta,NULL     },
+  { "betarand.a",S(PRAND),SQ,2,      "a",    "kkk",  NULL,  abeta    },
+  { "seed",     S(PRAND),SQ, 1,      "",     "i",    seedrand, NULL, NULL    },
   { "getseed.i",S(GETSEED),0, 1,    "i",     "",    getseed, NULL, NULL     },
   { "getseed.k",S(GETSEED),0, 3,    "k",     "",    getseed, getseed, NULL  },
-  { "unirand.i",S(PRAND),0, 1,     "i",     "k",    ikuniform, NULL,  NULL  },
-  { "unirand.k",S(PRAND),0, 2,     "k",     "k",    NULL,    ikuniform, NULL},
-  { "unirand.a",S(PRAND),0, 2,     "a",     "k",    NULL, auniform },
-  { "diskin",S(DISKIN2_ARRAY),0, 3,    "a[]",
+  { "unirand.i",S(PRAND),SQ, 1,     "i",     "k",    ikuniform, NULL,  NULL  },
+  { "unirand.k",S(PRAND),SQ, 2,     "k",     "k",    NULL,    ikuniform, NULL},
+  { "unirand.a",S(PRAND),SQ, 2,     "a",     "k",    NULL, auniform },
+  { "diskin",S(DISKIN2_ARRAY),TD, 3,    "a[]",
     "SPooooooo",
     (SUBR) diskin_init_array_S,
     (SUBR) diskin2_perf_array                         },
-  { "diskin2",S(DISKIN2_ARRAY),0, 3, "a[]",
+  { "diskin2",S(DISKIN2_ARRAY),TD, 3, "a[]",
     "SPooooooo",
     (SUBR) diskin2_init_array_S,
     (SUBR) diskin2_perf_array                         },
-  { "diskin.i",S(DISKIN2_ARRAY),0, 3,    "a[]",
+  { "diskin.i",S(DISKIN2_ARRAY),TD, 3,    "a[]",
     "iPooooooo",
     (SUBR) diskin_init_array_I,
     (SUBR) diskin2_perf_array                         },
-  { "diskin2.i",S(DISKIN2_ARRAY),0, 3, "a[]",
+  { "diskin2.i",S(DISKIN2_ARRAY),TD, 3, "a[]",
     "iPooooooo",
     (SUBR) diskin2_init_array_I,
     (SUBR) diskin2_perf_array                         },
-  { "diskin",S(DISKIN2),0, 3,    "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
+  { "diskin",S(DISKIN2),TD, 3,    "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
     "SPooooooo",
     (SUBR) diskin_init_S,
     (SUBR) diskin2_perf                         },
-  { "diskin2",S(DISKIN2),0, 3, "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
+  { "diskin2",S(DISKIN2),TD, 3, "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
     "SPooooooo",
     (SUBR) diskin2_init_S,
     (SUBR) diskin2_perf                         },
-  { "diskin.i",S(DISKIN2),0, 3,    "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
+  { "diskin.i",S(DISKIN2),TD, 3,    "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
     "iPooooooo",
     (SUBR) diskin_init,
     (SUBR) diskin2_perf                         },
-  { "diskin2.i",S(DISKIN2),0, 3, "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
+  { "diskin2.i",S(DISKIN2),TD, 3, "mmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmmm",
     "iPooooooo",
     (SUBR) diskin2_init,
     (SUBR) diskin2_perf                         },
@@ -785,33 +789,33 @@ OENTRY opcodlst_1[] = {
   { "xadsr.a", S(EXXPSEG),0,   3,     "a",    "iiiio", xdsrset, expseg    },
   { "mxadsr", S(EXPSEG),0,   3,     "k",    "iiiioj", mxdsrset, kxpsegr, NULL},
   { "mxadsr.a", S(EXPSEG),0,   3,     "a",    "iiiioj", mxdsrset, expsegr},
-  { "schedule", S(SCHED),0,  1,     "",     "iiim",
+  { "schedule", S(SCHED),SQ,  1,     "",     "iiim",
     schedule, NULL, NULL },
-  { "schedule.N", S(SCHED),0,  1,     "",     "iiiN",
+  { "schedule.N", S(SCHED),SQ,  1,     "",     "iiiN",
     schedule_N, NULL, NULL },
-  { "schedule.S", S(SCHED),0,  1,     "",     "Siim",
+  { "schedule.S", S(SCHED),SQ,  1,     "",     "Siim",
     schedule_S, NULL, NULL },
-  { "schedule.SN", S(SCHED),0,  1,     "",     "SiiN",
+  { "schedule.SN", S(SCHED),SQ,  1,     "",     "SiiN",
     schedule_SN, NULL, NULL },
-  { "schedwhen", S(WSCHED),0,3,     "",     "kkkkm",ifschedule, kschedule, NULL },
-  { "schedwhen", S(WSCHED),0,3,     "",     "kSkkm",ifschedule, kschedule, NULL },
-  { "schedkwhen", S(TRIGINSTR),0, 3,"",     "kkkkkz",triginset, ktriginstr, NULL },
-  { "schedkwhen.S", S(TRIGINSTR),0, 3,"",    "kkkSkz",
+  { "schedwhen", S(WSCHED),SQ,3,     "",     "kkkkm",ifschedule, kschedule, NULL },
+  { "schedwhen", S(WSCHED),SQ,3,     "",     "kSkkm",ifschedule, kschedule, NULL },
+  { "schedkwhen", S(TRIGINSTR),SQ, 3,"",     "kkkkkz",triginset, ktriginstr, NULL },
+  { "schedkwhen.S", S(TRIGINSTR),SQ, 3,"",    "kkkSkz",
                                              triginset_S, ktriginstr_S, NULL },
-  { "schedkwhennamed", S(TRIGINSTR),0, 3,"", "kkkkkz",triginset, ktriginstr, NULL },
-  { "schedkwhennamed.S", S(TRIGINSTR),0, 3,"",
+  { "schedkwhennamed", S(TRIGINSTR),SQ, 3,"", "kkkkkz",triginset, ktriginstr, NULL },
+  { "schedkwhennamed.S", S(TRIGINSTR),SQ, 3,"",
                                         "kkkSkz",triginset_S, ktriginstr_S, NULL },
   { "trigseq", S(TRIGSEQ),0, 3,     "",     "kkkkkz", trigseq_set, trigseq, NULL },
-  { "event", S(LINEVENT),0,  2,     "",     "Skz",  NULL, eventOpcode, NULL   },
-  { "event_i", S(LINEVENT),0,1,     "",     "Sim",  eventOpcodeI, NULL, NULL  },
-  { "event.S", S(LINEVENT),0,  2,     "",    "SSz",  NULL, eventOpcode_S, NULL   },
-  { "event_i.S", S(LINEVENT),0,1,     "",    "SSm",  eventOpcodeI_S, NULL, NULL  },
+  { "event", S(LINEVENT),SQ,  2,     "",     "Skz",  NULL, eventOpcode, NULL   },
+  { "event_i", S(LINEVENT),SQ,1,     "",     "Sim",  eventOpcodeI, NULL, NULL  },
+  { "event.S", S(LINEVENT),SQ,  2,     "",    "SSz",  NULL, eventOpcode_S, NULL   },
+  { "event_i.S", S(LINEVENT),SQ,1,     "",    "SSm",  eventOpcodeI_S, NULL, NULL  },
   { "nstance", S(LINEVENT2),0,2,     "k",  "kkz",  NULL, instanceOpcode, NULL   },
   { "nstance.i", S(LINEVENT2),0,1,   "i",  "iiim",  instanceOpcode, NULL, NULL  },
   { "nstance.kS", S(LINEVENT2),0, 2, "k",  "SSz",  NULL, instanceOpcode_S, NULL },
   { "nstance.S", S(LINEVENT2),0, 1,  "i",  "Siim",  instanceOpcode_S, NULL, NULL},
-  { "turnoff.i", S(KILLOP),0,1,     "",     "i", kill_instance, NULL, NULL  },
-  { "turnoff.k", S(KILLOP),0,2,     "",     "k", NULL, kill_instance, NULL},
+  { "turnoff.i", S(KILLOP),SQ,1,     "",     "i", kill_instance, NULL, NULL  },
+  { "turnoff.k", S(KILLOP),SQ,2,     "",     "k", NULL, kill_instance, NULL},
   { "lfo", S(LFO),0,         3,     "k",    "kko",  lfoset,   lfok,   NULL   },
   { "lfo.a", S(LFO),0,         3,     "a",    "kko",  lfoset,   lfoa    },
   { "oscils",   S(OSCILS),0, 3,     "a", "iiio",
@@ -910,11 +914,11 @@ OENTRY opcodlst_1[] = {
   { "nstrstr", S(NSTRSTR),0, 1,       "S",    "i",    nstrstr, NULL, NULL      },
   { "nstrstr.k", S(NSTRSTR),0, 2,     "S",    "k",    NULL, nstrstr, NULL      },
   //{ "turnoff2",   0xFFFB,   _CW,    0, NULL,   NULL,   NULL, NULL, NULL          },
-  { "turnoff2.S",S(TURNOFF2),_CW,2,     "",     "Skk",  NULL, turnoff2S, NULL     },
-  { "turnoff2.c",S(TURNOFF2),_CW,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
-  { "turnoff2.k",S(TURNOFF2),_CW,2,     "",     "kkk",  NULL, turnoff2k, NULL     },
-  { "turnoff2.i",S(TURNOFF2),_CW,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
-  { "turnoff2.r",S(TURNOFF2),_CW,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.S",S(TURNOFF2),_CW|SQ,2,     "",     "Skk",  NULL, turnoff2S, NULL     },
+  { "turnoff2.c",S(TURNOFF2),_CW|SQ,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.k",S(TURNOFF2),_CW|SQ,2,     "",     "kkk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.i",S(TURNOFF2),_CW|SQ,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
+  { "turnoff2.r",S(TURNOFF2),_CW|SQ,2,     "",     "ikk",  NULL, turnoff2k, NULL     },
   { "cngoto", S(CGOTO),0,   3,      "",     "Bl",   ingoto, kngoto, NULL     },
   { "cnkgoto", S(CGOTO),0,   2,      "",     "Bl",   NULL,  kngoto, NULL     },
   { "cingoto", S(CGOTO),0,   1,      "",     "Bl",   ingoto, NULL, NULL     },
@@ -1138,15 +1142,15 @@ OENTRY opcodlst_1[] = {
   //  { "##globalunlock", S(GLOBAL_LOCK_UNLOCK),0, 3, "", "i",
   //    globalunlock, globalunlock, NULL},
   { "##error",S(ERRFN),0, 1,          "i",     "i",   error_fn, NULL,    NULL    },
-  { "exprandi.i",S(PRANDI),0, 1,      "i",    "kxx",  iexprndi, NULL,    NULL    },
-  { "exprandi.k",S(PRANDI),0, 3,      "k",    "kxx",  exprndiset, kexprndi, NULL },
-  { "exprandi.a",S(PRANDI),0, 2,      "a",    "kxx",  exprndiset, aexprndi },
-  { "cauchyi.i", S(PRANDI),0, 1,      "i",    "kxx",  icauchyi, NULL,    NULL    },
-  { "cauchyi.k", S(PRANDI),0, 3,      "k",    "kxx",  cauchyiset, kcauchyi, NULL },
-  { "cauchyi.a", S(PRANDI),0, 2,      "a",    "kxx",  cauchyiset, acauchyi },
-  { "gaussi.i", S(PRANDI),0, 1,      "i",    "kxx",  igaussi, NULL,    NULL    },
-  { "gaussi.k", S(PRANDI),0, 3,      "k",    "kxx",  gaussiset, kgaussi, NULL },
-  { "gaussi.a", S(PRANDI),0, 2,      "a",    "kxx",  gaussiset, agaussi },
+  { "exprandi.i",S(PRANDI),SQ, 1,      "i",    "kxx",  iexprndi, NULL,    NULL    },
+  { "exprandi.k",S(PRANDI),SQ, 3,      "k",    "kxx",  exprndiset, kexprndi, NULL },
+  { "exprandi.a",S(PRANDI),SQ, 2,      "a",    "kxx",  exprndiset, aexprndi },
+  { "cauchyi.i", S(PRANDI),SQ, 1,      "i",    "kxx",  icauchyi, NULL,    NULL    },
+  { "cauchyi.k", S(PRANDI),SQ, 3,      "k",    "kxx",  cauchyiset, kcauchyi, NULL },
+  { "cauchyi.a", S(PRANDI),SQ, 2,      "a",    "kxx",  cauchyiset, acauchyi },
+  { "gaussi.i", S(PRANDI),SQ, 1,      "i",    "kxx",  igaussi, NULL,    NULL    },
+  { "gaussi.k", S(PRANDI),SQ, 3,      "k",    "kxx",  gaussiset, kgaussi, NULL },
+  { "gaussi.a", S(PRANDI),SQ, 2,      "a",    "kxx",  gaussiset, agaussi },
   { "ftresizei", S(RESIZE), TB, 1, "i", "ii", (SUBR) resize_table, NULL, NULL },
   { "ftresize",  S(RESIZE), TB, 2, "k", "kk", NULL, (SUBR) resize_table, NULL },
   { "compileorc",  S(COMPILE), 0, 1, "i", "S",  (SUBR) compile_orc_i, NULL, NULL },
@@ -1154,7 +1158,7 @@ OENTRY opcodlst_1[] = {
   { "compilestr",  S(COMPILE), 0, 1, "i", "S",  (SUBR) compile_str_i, NULL, NULL },
   { "evalstr",  S(COMPILE), 0, 1, "i", "S",  (SUBR) eval_str_i, NULL, NULL },
   { "evalstr",  S(COMPILE), 0, 2, "k", "Sk",  NULL, (SUBR) eval_str_k, NULL },
-  { "readscore",  S(COMPILE), 0, 1, "i", "S",  (SUBR) read_score_i, NULL, NULL },
+  { "readscore",  S(COMPILE), SQ, 1, "i", "S",  (SUBR) read_score_i, NULL, NULL },
   { "return",  S(RETVAL), 0, 1, "", "i",  (SUBR) retval_i, NULL, NULL },
   /* ----------------------------------------------------------------------- */
   { "monitor",  sizeof(MONITOR_OPCODE), IB, 3,  "mmmmmmmmmmmmmmmmmmmmmmmm", "",
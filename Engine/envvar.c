@@ -962,6 +962,32 @@ char *csoundFindOutputFile(CSOUND *csound,
     return name_found;
 }
 
+/* link p into the chain of open files, and unlink it; deinit callbacks
+   may close files on the reclaimer thread (--reclaim-thread) */
+
+static void open_files_link(CSOUND *csound, CSFILE *p)
+{
+    csoundSpinLock(&csound->open_files_lock);
+    p->nxt = (CSFILE*) csound->open_files;
+    p->prv = (CSFILE*) NULL;
+    if (csound->open_files != NULL)
+      ((CSFILE*) csound->open_files)->prv = p;
+    csound->open_files = (void*) p;
+    csoundSpinUnLock(&csound->open_files_lock);
+}
+
+static void open_files_unlink(CSOUND *csound, CSFILE *p)
+{
+    csoundSpinLock(&csound->open_files_lock);
+    if (p->prv == NULL)
+      csound->open_files = (void*) p->nxt;
+    else
+      p->prv->nxt = p->nxt;
+    if (p->nxt != NULL)
+      p->nxt->prv = p->prv;
+    csoundSpinUnLock(&csound->open_files_lock);
+}
+
 /**
  * Open a file and return handle.
  *
@@ -1082,8 +1108,6 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
     p = (CSFILE*) csound->Malloc(csound, (size_t) nbytes);
     if (UNLIKELY(p == NULL))
       goto err_return;
-    p->nxt = (CSFILE*) csound->open_files;
-    p->prv = (CSFILE*) NULL;
     p->type = type;
     p->fd = tmp_fd;
     p->f = tmp_f;
@@ -1166,9 +1190,7 @@ void *csoundFileOpenWithType(CSOUND *csound, void *fd, int type,
       *((int*) fd) = tmp_fd;
     }
     /* link into chain of open files */
-    if (csound->open_files != NULL)
-      ((CSFILE*) csound->open_files)->prv = p;
-    csound->open_files = (void*) p;
+    open_files_link(csound, p);
     /* notify the host if it asked */
     if (csound->FileOpenCallback_ != NULL) {
       int writing = (type == CSFILE_SND_W || type == CSFILE_FD_W ||
@@ -1230,8 +1252,6 @@ void *csoundCreateFileHandle(CSOUND *csound,
     p = (CSFILE*) csound->Malloc(csound, (size_t) nbytes);
     if (p == NULL)
       return NULL;
-    p->nxt = (CSFILE*) csound->open_files;
-    p->prv = (CSFILE*) NULL;
     p->type = type;
     p->fd = -1;
     p->f = (FILE*) NULL;
@@ -1258,9 +1278,7 @@ void *csoundCreateFileHandle(CSOUND *csound,
       return NULL;
     }
     /* link into chain of open files */
-    if (csound->open_files != NULL)
-      ((CSFILE*) csound->open_files)->prv = p;
-    csound->open_files = (void*) p;
+    open_files_link(csound, p);
     /* return with opaque file handle */
     p->cb = NULL;
     return (void*) p;
@@ -1304,12 +1322,7 @@ int csoundFileClose(CSOUND *csound, void *fd)
         break;
       }
       /* unlink from chain of open files */
-      if (p->prv == NULL)
-        csound->open_files = (void*) p->nxt;
-      else
-        p->prv->nxt = p->nxt;
-      if (p->nxt != NULL)
-        p->nxt->prv = p->prv;
+      open_files_unlink(csound, p);
       if (p->buf != NULL) csound->Free(csound, p->buf);
       p->bufsize = 0;
       csound->DestroyCircularBuffer(csound, p->cb);
@@ -1331,13 +1344,12 @@ int csoundFileClose(CSOUND *csound, void *fd)
           retval |= close(p->fd);
         break;
       }
-      /* unlink from chain of open files */
-      if (p->prv == NULL)
-        csound->open_files = (void*) p->nxt;
-      else
-        p->prv->nxt = p->nxt;
-      if (p->nxt != NULL)
-        p->nxt->prv = p->prv;
+      /* unlink from chain of open files, which the I/O thread walks */
+      if (csound->file_io_start)
+        csound->WaitThreadLockNoTimeout(csound->file_io_threadlock);
+      open_files_unlink(csound, p);
+      if (csound->file_io_start)
+        csound->NotifyThreadLock(csound->file_io_threadlock);
     }
     /* free allocated memory */
     csound->Free(csound, fd);
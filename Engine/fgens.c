@@ -112,7 +112,8 @@ typedef struct namedgen {
 
 CS_NOINLINE int  fterror(const FGDATA *, const char *, ...);
 static CS_NOINLINE void ftresdisp(const FGDATA *, FUNC *);
-static CS_NOINLINE FUNC *ftalloc(const FGDATA *);
+static CS_NOINLINE FUNC *ftalloc_table(const FGDATA *, MYFLT *);
+#define ftalloc(ff) ftalloc_table(ff, NULL)
 
 static int GENUL(FGDATA *ff, FUNC *ftp)
 {
@@ -2346,18 +2347,32 @@ static void generate_sine_tab(CSOUND *csound)
     return;
 }
 
+/* release ftable space, which GEN01 may have left in a mapped soundfile */
+
+static void ftfree(CSOUND *csound, MYFLT *ftable)
+{
+    SNDMAP  *m = csoundSndMapFind(csound, ftable);
+
+    if (m != NULL)
+      csoundSndMapClose(csound, m);
+    else
+      csound->Free(csound, ftable);
+}
+
 /* alloc ftable space for fno (or replace one) */
 /*  set ftp to point to that structure         */
+/*  table, if not NULL, is the space to use    */
 
-static CS_NOINLINE FUNC *ftalloc(const FGDATA *ff)
+static CS_NOINLINE FUNC *ftalloc_table(const FGDATA *ff, MYFLT *table)
 {
     CSOUND  *csound = ff->csound;
     FUNC    *ftp = csound->flist[ff->fno];
 
     if (UNLIKELY(ftp != NULL)) {
       csound->Warning(csound, Str("replacing previous ftable %d"), ff->fno);
-      if (ff->flen != (int32)ftp->flen) {       /* if redraw & diff len, */
-        csound->Free(csound, ftp->ftable);
+      if (ff->flen != (int32)ftp->flen ||       /* if redraw & diff len, */
+          table != NULL) {                      /* or given new space,   */
+        ftfree(csound, ftp->ftable);
         csound->Free(csound, (void*) ftp);             /*   release old space   */
         csound->flist[ff->fno] = ftp = NULL;
         if (UNLIKELY(csound->actanchor.nxtact != NULL)) { /*   & chk for danger */
@@ -2376,7 +2391,9 @@ static CS_NOINLINE FUNC *ftalloc(const FGDATA *ff)
     }
     if (ftp == NULL) {                      /*   alloc space as reqd */
       csound->flist[ff->fno] = ftp = (FUNC*) csound->Calloc(csound, sizeof(FUNC));
-      ftp->ftable = (MYFLT*) csound->Calloc(csound, (1+ff->flen) * sizeof(MYFLT));
+      ftp->ftable = (table != NULL ? table :
+                     (MYFLT*) csound->Calloc(csound,
+                                             (1+ff->flen) * sizeof(MYFLT)));
     }
     ftp->fno = (int32) ff->fno;
     ftp->flen = ff->flen;
@@ -2599,8 +2616,66 @@ static const int gen01_format_table[10] = {
     AE_FLOAT,   AE_UNCH,    AE_24INT,   AE_DOUBLE
 };
 
+#ifdef USE_DOUBLE
+#  define GEN01_NATIVE_FORMAT AE_DOUBLE
+#else
+#  define GEN01_NATIVE_FORMAT AE_FLOAT
+#endif
+
+/* map the soundfile sndgetset() opened, if it is uncompressed and the  */
+/* skip time is not negative; *skip is the first frame to read, and     */
+/* *scalefac the gain getsndin() would apply; flags for the table to    */
+/* use the data in place                                                */
+
+static SNDMAP *gen01_map(CSOUND *csound, const SOUNDIN *p, int flags,
+                         int64_t *skip, MYFLT *scalefac)
+{
+    SF_INFO sfinfo;
+
+    if (!csound->oparms->sndMap || p->audrem <= 0)
+      return NULL;
+    memset(&sfinfo, 0, sizeof(SF_INFO));
+    sfinfo.format = TYPE2SF(p->filetyp) | FORMAT2SF(p->format);
+    sfinfo.channels = p->nchanls;
+    sfinfo.frames = (sf_count_t) (p->audrem / p->nchanls);
+    if ((*skip = (int64_t) sfinfo.frames - p->framesrem) < 0)
+      return NULL;
+    if ((p->format == AE_FLOAT || p->format == AE_DOUBLE) &&
+        p->filetyp != TYP_WAV && p->filetyp != TYP_AIFF &&
+        p->filetyp != TYP_W64)
+      *scalefac = FL(1.0);
+    else
+      *scalefac = csound->e0dbfs;
+    return csoundSndMapOpen(csound, csound->GetFileName(p->fd), &sfinfo,
+                            flags);
+}
+
+/* getsndin() from a mapped soundfile */
+
+static int32 gen01_mapread(const SNDMAP *m, MYFLT *fp, int nlocs,
+                           const SOUNDIN *p, int64_t skip, MYFLT scalefac)
+{
+    int64_t n;
+
+    if (p->nchanls == 1 || p->channel == ALLCHNLS) {
+      int     k, chans = p->nchanls;
+      n = csoundSndMapRead(m, fp, skip, nlocs / chans, 0, scalefac) * chans;
+      if (n == nlocs - nlocs % chans)   /* and part of the next frame */
+        for (k = 0; k < nlocs % chans &&
+               csoundSndMapRead(m, &fp[n], skip + n / chans, 1, k + 1,
+                                scalefac); k++)
+          n++;
+    }
+    else
+      n = csoundSndMapRead(m, fp, skip, nlocs, p->channel, scalefac);
+    memset(&(fp[n]), 0, (nlocs-n)*sizeof(MYFLT));   /* if incomplete PAD */
+    return (int32) n;
+}
+
 /* read ftable values from a sound file */
 /* stops reading when table is full     */
+/* with --mmap-soundfiles, a deferred-size table of a whole file in   */
+/* MYFLT format and not rescaled is the mapped file itself            */
 
 static int gen01raw(FGDATA *ff, FUNC *ftp)
 {
@@ -2608,6 +2683,9 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     SOUNDIN *p;
     SOUNDIN tmpspace;
     SNDFILE *fd;
+    SNDMAP  *m;
+    MYFLT   *native = NULL, scalefac = FL(1.0);
+    int64_t skip = 0;
     int     truncmsg = 0;
     int32   inlocs = 0;
     int     def = 0, table_length = ff->flen + 1;
@@ -2672,9 +2750,15 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
       /* sndinset to open the file  */
       return fterror(ff, Str("Failed to open file %s"), p->sfname);
     }
+    m = gen01_map(csound, p,
+                  (ff->flen == 0 && ff->e.p[4] < FL(0.0) &&
+                   (p->channel == ALLCHNLS || p->nchanls == 1) ?
+                   SNDMAP_PRIVATE : 0), &skip, &scalefac);
     if (ff->flen == 0) {                      /* deferred ftalloc requestd: */
       if (UNLIKELY((ff->flen = p->framesrem + 1) <= 0)) {
         /*   get minsize from soundin */
+        if (m != NULL)
+          csoundSndMapClose(csound, m);
         return fterror(ff, Str("deferred size, but filesize unknown"));
       }
       if (UNLIKELY(csound->oparms->msglevel & 7))
@@ -2683,7 +2767,10 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
          ff->flen *= p->nchanls;
       ff->guardreq  = 1;                      /* presum this includes guard */
 /*ff->flen     -= 1;*/ /* VL: this was causing tables to exclude last point */
-      ftp           = ftalloc(ff);            /*   alloc now, and           */
+      if (m != NULL && (m->flags & SNDMAP_PRIVATE) && skip == 0 &&
+          scalefac == FL(1.0))
+        native = (MYFLT*) csoundSndMapNative(m, GEN01_NATIVE_FORMAT);
+      ftp           = ftalloc_table(ff, native); /* alloc now, and        */
       ftp->lenmask  = 0L;                     /*   mark hdr partly filled   */
       /*if (p->channel==ALLCHNLS) ftp->nchanls  = p->nchanls;
       else ftp->nchanls  = 1;
@@ -2765,7 +2852,15 @@ static int gen01raw(FGDATA *ff, FUNC *ftp)
     }
     /* read sound with opt gain */
 
-    if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
+    if (native != NULL) {                       /* table is the file */
+      inlocs = (int32) (p->audrem < table_length ? p->audrem : table_length);
+      memset(&(ftp->ftable[inlocs]), 0, (table_length-inlocs)*sizeof(MYFLT));
+    }
+    else if (m != NULL) {
+      inlocs = gen01_mapread(m, ftp->ftable, table_length, p, skip, scalefac);
+      csoundSndMapClose(csound, m);
+    }
+    else if (UNLIKELY((inlocs=getsndin(csound, fd, ftp->ftable, table_length, p)) < 0)) {
       return fterror(ff, Str("GEN1 read error"));
     }
 
@@ -3402,9 +3497,18 @@ int resize_table(CSOUND *csound, RESIZE *p)
     }
     if (UNLIKELY((ftp = csound->FTFind(csound, p->fn)) == NULL))
       return NOTOK;
-    if (ftp->flen<fsize)
-      ftp->ftable = (MYFLT *) csound->ReAlloc(csound, ftp->ftable,
-                                              sizeof(MYFLT)*(fsize+1));
+    if (ftp->flen<fsize) {
+      SNDMAP *m = csoundSndMapFind(csound, ftp->ftable);
+      if (m != NULL) {              /* GEN01 table in a mapped soundfile */
+        MYFLT *tab = (MYFLT *) csound->Calloc(csound, sizeof(MYFLT)*(fsize+1));
+        memcpy(tab, ftp->ftable, sizeof(MYFLT)*(ftp->flen+1));
+        csoundSndMapClose(csound, m);
+        ftp->ftable = tab;
+      }
+      else
+        ftp->ftable = (MYFLT *) csound->ReAlloc(csound, ftp->ftable,
+                                                sizeof(MYFLT)*(fsize+1));
+    }
     ftp->flen = fsize+1;
     csound->flist[fno] = ftp;
     return OK;
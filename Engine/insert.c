@@ -41,6 +41,7 @@ static  void    schedofftim(CSOUND *, INSDS *);
 void    beatexpire(CSOUND *, double);
 void    timexpire(CSOUND *, double);
 static  void    instance(CSOUND *, int);
+void    insds_free(CSOUND *, INSTRTXT *, INSDS *);
 extern int argsRequired(char* argString);
 static int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn,
                        MEVENT *mep);
@@ -145,6 +146,46 @@ static int reinit_pass(CSOUND *csound, INSDS *ip, OPDS *ids) {
 }
 
 
+/* Latency from enqueueing a realtime event to the start of its
+   allocation, kept in quarter octave bins of microseconds (-m128) */
+static void alloc_latency_add(CSOUND *csound, double stamp)
+{
+    double us = (csoundGetRealTime(csound->csRtClock) - stamp) * 1.0e6;
+    int bin = us > 1.0 ? (int) (4.0 * log2(us)) : 0;
+    if (bin >= ALLOC_LATENCY_BINS) bin = ALLOC_LATENCY_BINS - 1;
+    csound->alloc_latency[bin]++;
+    if (us > csound->alloc_latency_max) csound->alloc_latency_max = us;
+}
+
+void alloc_latency_report(CSOUND *csound)
+{
+    static const double pc[] = { 0.5, 0.9, 0.99 };
+    double val[3];
+    uint32_t *h = csound->alloc_latency;
+    uint64_t n = 0, sum = 0;
+    int i, k = 0;
+    if (h == NULL) return;
+    for (i = 0; i < ALLOC_LATENCY_BINS; i++) n += h[i];
+    if (n == 0) return;
+    for (i = 0; i < ALLOC_LATENCY_BINS && k < 3; i++) {
+      sum += h[i];
+      while (k < 3 && (double) sum >= pc[k] * n)
+        val[k++] = pow(2.0, (i + 1) * 0.25);    /* top of the bin */
+    }
+    csound->Message(csound,
+                    Str("realtime event latency (%lu events): 50%%: %.0fus, "
+                        "90%%: %.0fus, 99%%: %.0fus, max: %.0fus\n"),
+                    (unsigned long) n, val[0], val[1], val[2],
+                    csound->alloc_latency_max);
+}
+
+/* called after queueing an allocation */
+static inline void alloc_queue_notify(CSOUND *csound)
+{
+    if (ATOMIC_GET(csound->alloc_queue_sleeping))
+      csoundNotifyThreadLock(csound->alloc_queue_wakeup);
+}
+
 /*
  * creates a thread to process instance allocations
  */
@@ -178,8 +219,16 @@ uintptr_t event_insert_thread(void *p) {
   while(csound->event_insert_loop) {
     // get the value of items_to_alloc
     items = ATOMIC_GET(csound->alloc_queue_items);
-    if(items == 0)
-       csoundSleep((int) ((int) wakeup > 0 ? wakeup : 1));
+    if(items == 0) {
+      /* sleep until an event is queued; the timeout still flushes the
+         message queue.  The flag is set before the recheck, so either
+         the producer sees it or we see the new item. */
+      ATOMIC_SET(csound->alloc_queue_sleeping, 1);
+      if (ATOMIC_GET(csound->alloc_queue_items) == 0)
+        csoundWaitThreadLock(csound->alloc_queue_wakeup,
+                             (size_t) ((int) wakeup > 0 ? wakeup : 1));
+      ATOMIC_SET(csound->alloc_queue_sleeping, 0);
+    }
     else while(items) {
         if (inst[rp].type == 3)  {
           INSDS *ip = inst[rp].ip;
@@ -197,6 +246,9 @@ uintptr_t event_insert_thread(void *p) {
           csoundSpinUnLock(&csound->alloc_spinlock);
           ATOMIC_SET(ip->init_done, 1);
         }
+        if (csound->alloc_latency != NULL &&
+            (inst[rp].type == 0 || inst[rp].type == 1))
+          alloc_latency_add(csound, inst[rp].stamp);
         if(inst[rp].type == 1) {
           csoundSpinLock(&csound->alloc_spinlock);
           insert_midi(csound, inst[rp].insno, inst[rp].chn, &inst[rp].mep);
@@ -224,6 +276,7 @@ uintptr_t event_insert_thread(void *p) {
   }
 
   csoundSetMessageCallback(csound, csoundMessageCallback);
+  mem_arena_exit(csound);
   return (uintptr_t) NULL;
 }
 
@@ -291,8 +344,11 @@ int insert(CSOUND *csound, int insno, EVTBLK *newevtp) {
     csound->alloc_queue[wp].insno = insno;
     csound->alloc_queue[wp].blk =  *newevtp;
     csound->alloc_queue[wp].type = 0;
+    if (csound->alloc_latency != NULL)
+      csound->alloc_queue[wp].stamp = csoundGetRealTime(csound->csRtClock);
     csound->alloc_queue_wp = wp + 1 < MAX_ALLOC_QUEUE ? wp + 1 : 0;
     ATOMIC_INCR(csound->alloc_queue_items);
+    alloc_queue_notify(csound);
     return 0;
   }
   else return insert_event(csound, insno, newevtp);
@@ -389,10 +445,14 @@ int insert_event(CSOUND *csound, int insno, EVTBLK *newevtp)
     tp->active++;
     tp->instcnt++;
     csound->dag_changed++;      /* Need to remake DAG */
+    ip->dag_task = -1;          /* not yet in the task graph */
     nxtp = &(csound->actanchor);    /* now splice into activ lst */
     while ((prvp = nxtp) && (nxtp = prvp->nxtact) != NULL) {
       if (nxtp->insno > insno ||
-          (nxtp->insno == insno && nxtp->p1.value > newevtp->p[1])) {
+          (nxtp->insno == insno && nxtp->p1.value > newevtp->p[1]) ||
+          (O->instanceLayout && nxtp->insno == insno &&
+           nxtp->p1.value == newevtp->p[1] &&
+           (uintptr_t) nxtp > (uintptr_t) ip)) {
         nxtp->prvact = ip;
         break;
       }
@@ -563,8 +623,11 @@ int MIDIinsert(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep) {
     csound->alloc_queue[wp].chn = chn;
     csound->alloc_queue[wp].mep = *mep;
     csound->alloc_queue[wp].type = 1;
+    if (csound->alloc_latency != NULL)
+      csound->alloc_queue[wp].stamp = csoundGetRealTime(csound->csRtClock);
     csound->alloc_queue_wp = wp + 1 < MAX_ALLOC_QUEUE ? wp + 1 : 0;
     ATOMIC_INCR(csound->alloc_queue_items);
+    alloc_queue_notify(csound);
     return 0;
   }
   else return insert_midi(csound, insno, chn, mep);
@@ -630,6 +693,7 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
   ATOMIC_SET(ip->init_done, 0);
   tp->act_instance = ip->nxtact;
   ip->insno = (int16) insno;
+  ip->dag_task = -1;                    /* not yet in the task graph */
 
   if (UNLIKELY(O->odebug))
     csound->Message(csound, "Now %d active instr %d\n", tp->active, insno);
@@ -649,7 +713,9 @@ int insert_midi(CSOUND *csound, int insno, MCHNBLK *chn, MEVENT *mep)
 
   nxtp = &(csound->actanchor);          /* now splice into activ lst */
   while ((prvp = nxtp) && (nxtp = prvp->nxtact) != NULL) {
-    if (nxtp->insno > insno) {
+    if (nxtp->insno > insno ||
+        (csound->oparms->instanceLayout && nxtp->insno == insno &&
+         (uintptr_t) nxtp > (uintptr_t) ip)) {
       nxtp->prvact = ip;
       break;
     }
@@ -816,7 +882,7 @@ static void showallocs(CSOUND *csound)      /* debugging aid */
   INSDS   *p;
 
   csound->Message(csound, "insno\tinstanc\tnxtinst\tprvinst\tnxtact\t"
-                  "prvact\tnxtoff\tactflg\tofftim\n");
+                  "prvact\toffidx\tactflg\tofftim\n");
   for (txtp = &(csound->engineState.instxtanchor);
        txtp != NULL;
        txtp = txtp->nxtinstxt)
@@ -827,23 +893,76 @@ static void showallocs(CSOUND *csound)      /* debugging aid */
        * and now on all platforms (JPff)
        */
       do {
-        csound->Message(csound, "%d\t%p\t%p\t%p\t%p\t%p\t%p\t%d\t%3.1f\n",
+        csound->Message(csound, "%d\t%p\t%p\t%p\t%p\t%p\t%d\t%d\t%3.1f\n",
                         (int) p->insno, (void*) p,
                         (void*) p->nxtinstance, (void*) p->prvinstance,
                         (void*) p->nxtact, (void*) p->prvact,
-                        (void*) p->nxtoff, p->actflg, p->offtim);
+                        p->offidx, p->actflg, p->offtim);
       } while ((p = p->nxtinstance) != NULL);
     }
 }
 
-static void schedofftim(CSOUND *csound, INSDS *ip)
-{                               /* put an active instr into offtime list  */
-  INSDS *prvp, *nxtp;         /* called by insert() & midioff + xtratim */
+/* Turnoff heap: scheduled instances ordered by offtim, and by the
+   order they were scheduled for equal times, as the old sorted
+   chain did.  ip->offidx lets xturnoff() take a note out early. */
 
-  if ((nxtp = csound->frstoff) == NULL ||
-      nxtp->offtim > ip->offtim) {            /*   set into       */
-    csound->frstoff = ip;                     /*   firstoff chain */
-    ip->nxtoff = nxtp;
+static inline int offheap_before(INSDS *a, INSDS *b)
+{
+  return (a->offtim < b->offtim ||
+          (a->offtim == b->offtim && (int32) (a->offseq - b->offseq) < 0));
+}
+
+static void offheap_place(CSOUND *csound, INSDS *ip, int i)
+{
+  INSDS **h = csound->offheap;
+  int   n = csound->offheap_size, j;
+  /* sift up, then down */
+  while (i > 0 && offheap_before(ip, h[j = (i - 1) >> 1])) {
+    h[i] = h[j];
+    h[i]->offidx = i + 1;
+    i = j;
+  }
+  while ((j = 2 * i + 1) < n) {
+    if (j + 1 < n && offheap_before(h[j + 1], h[j])) j++;
+    if (!offheap_before(h[j], ip)) break;
+    h[i] = h[j];
+    h[i]->offidx = i + 1;
+    i = j;
+  }
+  h[i] = ip;
+  ip->offidx = i + 1;
+}
+
+static void offheap_insert(CSOUND *csound, INSDS *ip)
+{
+  if (csound->offheap_size == csound->offheap_max) {
+    csound->offheap_max = csound->offheap_max ? 2 * csound->offheap_max : 64;
+    csound->offheap = (INSDS **)
+      csound->ReAlloc(csound, csound->offheap,
+                      csound->offheap_max * sizeof(INSDS *));
+  }
+  ip->offseq = csound->offseq++;
+  offheap_place(csound, ip, csound->offheap_size++);
+  csound->frstoff = csound->offheap[0];
+}
+
+static void offheap_remove(CSOUND *csound, INSDS *ip)
+{
+  int   i = ip->offidx - 1;
+  INSDS *last = csound->offheap[--csound->offheap_size];
+  ip->offidx = 0;
+  if (last != ip)
+    offheap_place(csound, last, i);
+  csound->frstoff = csound->offheap_size ? csound->offheap[0] : NULL;
+}
+
+static void schedofftim(CSOUND *csound, INSDS *ip)
+{                               /* put an active instr into offtime heap  */
+                                /* called by insert() & midioff + xtratim */
+  if (UNLIKELY(ip->offidx))
+    offheap_remove(csound, ip);
+  offheap_insert(csound, ip);
+  if (csound->frstoff == ip) {
     /* IV - Feb 24 2006: check if this note already needs to be turned off */
     /* the following comparisons must match those in sensevents() */
 #ifdef BETA
@@ -869,25 +988,168 @@ static void schedofftim(CSOUND *csound, INSDS *ip)
                                     (0.505 * csound->ksmps))/csound->esr));
 #endif
   }
-  else {
-    while ((prvp = nxtp)
-           && (nxtp = nxtp->nxtoff) != NULL
-           && ip->offtim >= nxtp->offtim);
-    prvp->nxtoff = ip;
-    ip->nxtoff = nxtp;
-  }
 }
 
 /* csound.c */
 extern  int     csoundDeinitialiseOpcodes(CSOUND *csound, INSDS *ip);
+extern  int     csoundDeinitThreadSafe(CSOUND *csound, INSDS *ip);
 int     useropcd(CSOUND *, UOPCODE*);
 
+/* Deferred deinitialisation (--reclaim-thread).  deact() hands an
+   instance that has deinit callbacks to the reclaimer thread rather than
+   running them here; once they have run the thread passes it back, and
+   reclaim_collect() puts it on the free list, at most reclaimBudget
+   instances per k-cycle.  Until then the instance is marked reclaiming,
+   so that it is neither reused nor freed.  The thread also closes the
+   files in its fd chain.  Instances with a callback from an opcode not
+   flagged TD (see csoundDeinitThreadSafe) are still deinitialised in
+   place. */
+
+/* returns 0 if the queue is full and the caller must deinit itself */
+static int reclaim_push(CSOUND *csound, INSDS *ip)
+{
+  int queued = 0;
+  csoundSpinLock(&csound->reclaim_spinlock);   /* deact() has two callers */
+  if (ATOMIC_GET(csound->reclaim_pending) < MAX_RECLAIM_QUEUE) {
+    unsigned long wp = csound->reclaim_queue_wp;
+    ip->reclaiming = 1;
+    csound->reclaim_queue[wp] = ip;
+    csound->reclaim_queue_wp = wp + 1 < MAX_RECLAIM_QUEUE ? wp + 1 : 0;
+    ATOMIC_INCR(csound->reclaim_pending);
+    ATOMIC_INCR(csound->reclaim_queue_items);
+    queued = 1;
+  }
+  csoundSpinUnLock(&csound->reclaim_spinlock);
+  if (queued && ATOMIC_GET(csound->reclaim_sleeping))
+    csoundNotifyThreadLock(csound->reclaim_wakeup);
+  return queued;
+}
+
+static uintptr_t reclaim_thread(void *p)
+{
+  CSOUND *csound = (CSOUND *) p;
+  int wait = (int) (1000*csound->ksmps/csound->esr);
+  unsigned long rp = 0, wp = 0;
+
+  /* the queue is drained before the thread stops */
+  while (ATOMIC_GET(csound->reclaim_loop) ||
+         ATOMIC_GET(csound->reclaim_queue_items)) {
+    INSDS *ip;
+    if (ATOMIC_GET(csound->reclaim_queue_items) == 0) {
+      ATOMIC_SET(csound->reclaim_sleeping, 1);
+      if (ATOMIC_GET(csound->reclaim_queue_items) == 0 &&
+          ATOMIC_GET(csound->reclaim_loop))
+        csoundWaitThreadLock(csound->reclaim_wakeup,
+                             (size_t) (wait > 0 ? wait : 1));
+      ATOMIC_SET(csound->reclaim_sleeping, 0);
+      continue;
+    }
+    ip = csound->reclaim_queue[rp];
+    rp = rp + 1 < MAX_RECLAIM_QUEUE ? rp + 1 : 0;
+    /* in realtime mode keep out of the way of init passes */
+    if (csound->init_pass_threadlock)
+      csoundLockMutex(csound->init_pass_threadlock);
+    csoundDeinitialiseOpcodes(csound, ip);
+    if (ip->fdchp != NULL)
+      fdchclose(csound, ip);
+    if (csound->init_pass_threadlock)
+      csoundUnlockMutex(csound->init_pass_threadlock);
+    csound->reclaim_done[wp] = ip;
+    wp = wp + 1 < MAX_RECLAIM_QUEUE ? wp + 1 : 0;
+    ATOMIC_INCR(csound->reclaim_done_items);
+    ATOMIC_DECR(csound->reclaim_queue_items);
+  }
+  mem_arena_exit(csound);
+  return (uintptr_t) NULL;
+}
+
+void reclaim_start(CSOUND *csound)
+{
+  if (csound->reclaim_thread != NULL)
+    return;
+  csound->reclaim_queue = (INSDS **)
+    csound->Calloc(csound, sizeof(INSDS *) * MAX_RECLAIM_QUEUE);
+  csound->reclaim_done = (INSDS **)
+    csound->Calloc(csound, sizeof(INSDS *) * MAX_RECLAIM_QUEUE);
+  csound->reclaim_queue_items = csound->reclaim_done_items = 0;
+  csound->reclaim_queue_wp = csound->reclaim_done_rp = 0;
+  csound->reclaim_pending = 0;
+  csoundSpinLockInit(&csound->reclaim_spinlock);
+  csound->reclaim_wakeup = csoundCreateThreadLock();
+  csound->reclaim_loop = 1;
+  csound->reclaim_thread = csound->CreateThread(reclaim_thread, csound);
+  if (UNLIKELY(csound->reclaim_thread == NULL)) {
+    csound->Warning(csound, Str("could not start the reclaimer thread, "
+                                "deinitialising in place\n"));
+    csoundDestroyThreadLock(csound->reclaim_wakeup);
+    csound->reclaim_wakeup = NULL;
+    csound->Free(csound, csound->reclaim_queue);
+    csound->Free(csound, csound->reclaim_done);
+    csound->reclaim_queue = csound->reclaim_done = NULL;
+  }
+}
+
+/* return a deactivated instance to the free list, closing its files */
+static void instance_release(CSOUND *csound, INSDS *ip)
+{
+  /* link into free instance chain */
+  /* This also destroys ip->nxtact causing loops */
+  if (csound->engineState.instrtxtp[ip->insno] == ip->instr){
+    ip->nxtact = csound->engineState.instrtxtp[ip->insno]->act_instance;
+    csound->engineState.instrtxtp[ip->insno]->act_instance = ip;
+  }
+  if (ip->fdchp != NULL)
+    fdchclose(csound, ip);
+}
+
+/* finish up to budget instances the reclaimer has passed back, or all
+   of them if budget is 0; called once per k-cycle from sensevents() */
+void reclaim_collect(CSOUND *csound, int budget)
+{
+  unsigned long rp = csound->reclaim_done_rp;
+  int n = 0;
+
+  while ((budget <= 0 || n < budget) &&
+         ATOMIC_GET(csound->reclaim_done_items) > 0) {
+    INSDS *ip = csound->reclaim_done[rp];
+    rp = rp + 1 < MAX_RECLAIM_QUEUE ? rp + 1 : 0;
+    ATOMIC_DECR(csound->reclaim_done_items);
+    ip->reclaiming = 0;
+    instance_release(csound, ip);
+    ATOMIC_DECR(csound->reclaim_pending);
+    n++;
+  }
+  csound->reclaim_done_rp = rp;
+}
+
+/* stop the thread once it has run every queued deinit, and finish
+   the instances it returns; later deacts deinitialise in place */
+void reclaim_stop(CSOUND *csound)
+{
+  if (csound->reclaim_thread == NULL)
+    return;
+  ATOMIC_SET(csound->reclaim_loop, 0);
+  csoundNotifyThreadLock(csound->reclaim_wakeup);
+  csound->JoinThread(csound->reclaim_thread);
+  csound->reclaim_thread = NULL;
+  reclaim_collect(csound, 0);
+  csoundDestroyThreadLock(csound->reclaim_wakeup);
+  csound->reclaim_wakeup = NULL;
+  csound->Free(csound, csound->reclaim_queue);
+  csound->Free(csound, csound->reclaim_done);
+  csound->reclaim_queue = csound->reclaim_done = NULL;
+}
+
 static void deact(CSOUND *csound, INSDS *ip)
 {                               /* unlink single instr from activ chain */
   INSDS  *nxtp;               /*      and mark it inactive            */
   /*   close any files in fd chain        */
 
-  if (ip->nxtd != NULL)
+  if (UNLIKELY(ip->offidx))           /* still waiting for its turnoff */
+    offheap_remove(csound, ip);
+  if (ip->nxtd != NULL &&
+      (csound->reclaim_queue == NULL ||
+       !csoundDeinitThreadSafe(csound, ip) || !reclaim_push(csound, ip)))
     csoundDeinitialiseOpcodes(csound, ip);
   /* remove an active instrument */
   csound->engineState.instrtxtp[ip->insno]->active--;
@@ -920,14 +1182,8 @@ static void deact(CSOUND *csound, INSDS *ip)
   if (ip->prvact && (nxtp = ip->prvact->nxtact = ip->nxtact) != NULL)
     nxtp->prvact = ip->prvact;
   ip->actflg = 0;
-  /* link into free instance chain */
-  /* This also destroys ip->nxtact causing loops */
-  if (csound->engineState.instrtxtp[ip->insno] == ip->instr){
-    ip->nxtact = csound->engineState.instrtxtp[ip->insno]->act_instance;
-    csound->engineState.instrtxtp[ip->insno]->act_instance = ip;
-  }
-  if (ip->fdchp != NULL)
-    fdchclose(csound, ip);
+  if (!ip->reclaiming)          /* else reclaim_collect() will do it */
+    instance_release(csound, ip);
   csound->dag_changed++;
 }
 
@@ -966,19 +1222,9 @@ void xturnoff(CSOUND *csound, INSDS *ip)  /* turnoff a particular insalloc  */
       }
     }
   }
-  /* remove from schedoff chain first if finite duration */
-  if (csound->frstoff != NULL && ip->offtim >= 0.0) {
-    INSDS *prvip;
-    prvip = csound->frstoff;
-    if (prvip == ip)
-      csound->frstoff = ip->nxtoff;
-    else {
-      while (prvip != NULL && prvip->nxtoff != ip)
-        prvip = prvip->nxtoff;
-      if (prvip != NULL)
-        prvip->nxtoff = ip->nxtoff;
-    }
-  }
+  /* remove from turnoff heap first if finite duration */
+  if (ip->offidx)
+    offheap_remove(csound, ip);
   /* if extra time needed: schedoff at new time */
   if (ip->xtratim > 0) {
     set_xtratim(csound, ip);
@@ -1034,7 +1280,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
       prvip = NULL;
       prvnxtloc = &txtp->instance;
       do {
-        if (!ip->actflg) {
+        if (!ip->actflg && !ip->reclaiming) {
           cnt++;
           if (ip->opcod_iobufs && ip->insno > csound->engineState.maxinsno)
             csound->Free(csound, ip->opcod_iobufs);   /* IV - Nov 10 2002 */
@@ -1046,7 +1292,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
           if ((nxtip = ip->nxtinstance) != NULL)
             nxtip->prvinstance = prvip;
           *prvnxtloc = nxtip;
-          csound->Free(csound, (char *)ip);
+          insds_free(csound, txtp, ip);
         }
         else {
           prvip = ip;
@@ -1074,7 +1320,7 @@ void orcompact(CSOUND *csound)          /* free all inactive instr spaces */
       if (csound->dead_instr_pool[i] != NULL) {
         INSDS *active = csound->dead_instr_pool[i]->instance;
         while (active != NULL) {
-          if (active->actflg) {
+          if (active->actflg || active->reclaiming) {
             // add_to_deadpool(csound,csound->dead_instr_pool[i]);
             break;
           }
@@ -1363,6 +1609,7 @@ int subinstrset(CSOUND *csound, SUBINST *p){
 
 */
 int useropcd1(CSOUND *, UOPCODE*), useropcd2(CSOUND *, UOPCODE*);
+static void udo_xfer_build(CSOUND *, UOPCODE *);
 
 int useropcdset(CSOUND *csound, UOPCODE *p)
 {
@@ -1532,6 +1779,7 @@ int useropcdset(CSOUND *csound, UOPCODE *p)
       ksmps_scale = CS_KSMPS / local_ksmps;
       parent_ip->xtratim = lcurip->xtratim / ksmps_scale;
       p->h.opadr = (SUBR) useropcd1;
+      udo_xfer_build(csound, p);
     }
     else {
       parent_ip->xtratim = lcurip->xtratim;
@@ -1708,30 +1956,27 @@ int nstrstr(CSOUND *csound, NSTRSTR *p)
 void beatexpire(CSOUND *csound, double beat)
 {
   INSDS  *ip;
- strt:
-  if ((ip = csound->frstoff) != NULL && ip->offbet <= beat) {
-    do {
-      if (!ip->relesing && ip->xtratim) {
-        /* IV - Nov 30 2002: */
-        /*   allow extra time for finite length (p3 > 0) score notes */
-        set_xtratim(csound, ip);      /* enter release stage */
-        csound->frstoff = ip->nxtoff; /* update turnoff list */
+  int    done = 0;
+
+  while ((ip = csound->frstoff) != NULL && ip->offbet <= beat) {
+    offheap_remove(csound, ip);     /* update turnoff list */
+    if (!ip->relesing && ip->xtratim) {
+      /* IV - Nov 30 2002: */
+      /*   allow extra time for finite length (p3 > 0) score notes */
+      set_xtratim(csound, ip);      /* enter release stage */
 #ifdef BETA
-        if (UNLIKELY(csound->oparms->odebug))
-          csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
+      if (UNLIKELY(csound->oparms->odebug))
+        csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
 #endif
-        schedofftim(csound, ip);
-        goto strt;                    /* and start again */
-      }
-      else
-        deact(csound, ip);    /* IV - Sep 5 2002: use deact() as it also */
-    }                         /* deactivates subinstrument instances */
-    while ((ip = ip->nxtoff) != NULL && ip->offbet <= beat);
-    csound->frstoff = ip;
-    if (UNLIKELY(csound->oparms->odebug)) {
-      csound->Message(csound, "deactivated all notes to beat %7.3f\n", beat);
-      csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
+      schedofftim(csound, ip);
     }
+    else
+      deact(csound, ip);    /* IV - Sep 5 2002: use deact() as it also */
+    done = 1;               /* deactivates subinstrument instances */
+  }
+  if (UNLIKELY(done && csound->oparms->odebug)) {
+    csound->Message(csound, "deactivated all notes to beat %7.3f\n", beat);
+    csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
   }
 }
 
@@ -1744,33 +1989,27 @@ void beatexpire(CSOUND *csound, double beat)
 void timexpire(CSOUND *csound, double time)
 {
   INSDS  *ip;
-
- strt:
-  if ((ip = csound->frstoff) != NULL && ip->offtim <= time) {
-    do {
-      if (!ip->relesing && ip->xtratim) {
-        /* IV - Nov 30 2002: */
-        /*   allow extra time for finite length (p3 > 0) score notes */
-        set_xtratim(csound, ip);      /* enter release stage */
-        csound->frstoff = ip->nxtoff; /* update turnoff list */
+  int    done = 0;
+
+  while ((ip = csound->frstoff) != NULL && ip->offtim <= time) {
+    offheap_remove(csound, ip);     /* update turnoff list */
+    if (!ip->relesing && ip->xtratim) {
+      /* IV - Nov 30 2002: */
+      /*   allow extra time for finite length (p3 > 0) score notes */
+      set_xtratim(csound, ip);      /* enter release stage */
 #ifdef BETA
-        if (UNLIKELY(csound->oparms->odebug))
-          csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
+      if (UNLIKELY(csound->oparms->odebug))
+        csound->Message(csound, "Calling schedofftim line %d\n", __LINE__);
 #endif
-        schedofftim(csound, ip);
-
-        goto strt;                    /* and start again */
-      }
-      else {
-        deact(csound, ip);    /* IV - Sep 5 2002: use deact() as it also */
-      }
-    }                         /* deactivates subinstrument instances */
-    while ((ip = ip->nxtoff) != NULL && ip->offtim <= time);
-    csound->frstoff = ip;
-    if (UNLIKELY(csound->oparms->odebug)) {
-      csound->Message(csound, "deactivated all notes to time %7.3f\n", time);
-      csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
+      schedofftim(csound, ip);
     }
+    else
+      deact(csound, ip);    /* IV - Sep 5 2002: use deact() as it also */
+    done = 1;               /* deactivates subinstrument instances */
+  }
+  if (UNLIKELY(done && csound->oparms->odebug)) {
+    csound->Message(csound, "deactivated all notes to time %7.3f\n", time);
+    csound->Message(csound, "frstoff = %p\n", (void*) csound->frstoff);
   }
 }
 
@@ -1885,15 +2124,182 @@ int subinstr(CSOUND *csound, SUBINST *p)
 
 /* IV - Sep 17 2002 -- case 1: local ksmps is used */
 
+void local_ksmps_schedule(LKSMPS_SCHED *s, int ksmps, int lksmps,
+                          int offset, int early)
+{
+    int end = ksmps - early;
+    s->first = offset / lksmps;
+    s->offset = offset % lksmps;
+    if (UNLIKELY(end <= offset)) {
+      s->count = s->early = 0;
+      return;
+    }
+    s->count = (end - 1) / lksmps - s->first + 1;
+    s->early = (lksmps - end % lksmps) % lksmps;
+}
+
+/* An output opcode that writes first in a k-cycle clears the spout buffer
+   from its own spout on, which is past the start of the buffer when the
+   schedule skips sub-blocks: clear all of it before then. */
+void local_ksmps_spout(CSOUND *csound, LKSMPS_SCHED *s)
+{
+    if (s->first == 0)
+      return;
+    csoundSpinLock(&csound->spoutlock);
+    if (!csound->spoutactive) {
+      memset(csound->spraw, 0, csound->nspout * sizeof(MYFLT));
+      csound->spoutactive = 1;
+    }
+    csoundSpinUnLock(&csound->spoutlock);
+}
+
+/* number of signals in an a-rate array */
+static int udo_array_count(ARRAYDAT *a)
+{
+    int j, count = 1;
+    for (j = 0; j < a->dimensions; j++)
+      count *= a->sizes[j];
+    return count;
+}
+
+/* classify the arguments that useropcd1() copies each local k-cycle: all
+   inputs but i-time ones, and the a-rate outputs */
+static void udo_xfer_build(CSOUND *csound, UOPCODE *p)
+{
+    OPCODINFO   *inm = p->buf->opcode_info;
+    MYFLT       **internal_ptrs = p->buf->iobufp_ptrs;
+    CS_VARIABLE *current;
+    UDO_XFER    *x;
+    int         i, n = inm->inchns + inm->outchns;
+
+    if (p->xfer.auxp == NULL || p->xfer.size < n * sizeof(UDO_XFER))
+      csound->AuxAlloc(csound, n * sizeof(UDO_XFER), &p->xfer);
+    x = (UDO_XFER*) p->xfer.auxp;
+    p->nxin = p->nxout = 0;
+    current = inm->in_arg_pool->head;
+    for (i = 0; i < inm->inchns; i++, current = current->next) {
+      if (current->varType == &CS_VAR_TYPE_A)
+        x->kind = UDO_XFER_A;
+      else if (current->varType == &CS_VAR_TYPE_ARRAY &&
+               current->subType == &CS_VAR_TYPE_A)
+        x->kind = UDO_XFER_AARRAY;
+      else if (current->varType != &CS_VAR_TYPE_I &&
+               current->varType != &CS_VAR_TYPE_b &&
+               current->subType != &CS_VAR_TYPE_I)
+        x->kind = (current->varType == &CS_VAR_TYPE_K ?
+                   UDO_XFER_K : UDO_XFER_VALUE);
+      else continue;
+      x->type = current->varType;
+      x->ext = p->ar[i + inm->outchns];
+      x->lcl = internal_ptrs[i + inm->outchns];
+      x++; p->nxin++;
+    }
+    current = inm->out_arg_pool->head;
+    for (i = 0; i < inm->outchns; i++, current = current->next) {
+      if (current->varType == &CS_VAR_TYPE_A)
+        x->kind = UDO_XFER_A;
+      else if (current->varType == &CS_VAR_TYPE_ARRAY &&
+               current->subType == &CS_VAR_TYPE_A)
+        x->kind = UDO_XFER_AARRAY;
+      else continue;
+      x->type = current->varType;
+      x->ext = p->ar[i];
+      x->lcl = internal_ptrs[i];
+      x++; p->nxout++;
+    }
+}
+
+/* copy one local k-cycle of arguments, at sample ofs of the caller's
+   signals: into the UDO if out is zero, else out of it */
+static void udo_xfer(CSOUND *csound, UDO_XFER *x, int n, int ofs,
+                     int lksmps, int out)
+{
+    for ( ; n > 0; n--, x++) {
+      switch (x->kind) {
+      case UDO_XFER_K:
+        *(MYFLT*) x->lcl = *(MYFLT*) x->ext;
+        break;
+      case UDO_XFER_VALUE:
+        x->type->copyValue(csound, x->lcl, x->ext);
+        break;
+      case UDO_XFER_A:
+        {
+          MYFLT *ext = (MYFLT*) x->ext + ofs, *lcl = (MYFLT*) x->lcl;
+          if (lksmps == 1) {
+            if (out) *ext = *lcl;
+            else *lcl = *ext;
+          }
+          else if (out) memcpy(ext, lcl, lksmps * sizeof(MYFLT));
+          else memcpy(lcl, ext, lksmps * sizeof(MYFLT));
+        }
+        break;
+      case UDO_XFER_AARRAY:
+        {
+          ARRAYDAT *ext = (ARRAYDAT*) x->ext, *lcl = (ARRAYDAT*) x->lcl;
+          int j, count = udo_array_count(out ? lcl : ext);
+          int span = ext->arrayMemberSize / sizeof(MYFLT);
+          for (j = 0; j < count; j++) {
+            MYFLT *e = ext->data + j * span + ofs, *l = lcl->data + j * span;
+            if (out) memcpy(e, l, lksmps * sizeof(MYFLT));
+            else memcpy(l, e, lksmps * sizeof(MYFLT));
+          }
+        }
+        break;
+      }
+    }
+}
+
+/* one pass of the perf chain of a UDO body; returns non-zero if the UDO
+   was found deactivated before an opcode.  A body without jumps runs from
+   its pre-resolved table (see perf_table_run() in csound.c) as far as it
+   can, the rest follows the nxtp chain. */
+static int udo_chain_run(CSOUND *csound, UOPCODE *p)
+{
+    INSDS   *ip = p->ip;
+    OPDS    *start = (OPDS*) ip;
+    int     error = 0;
+
+    if (ip->perf != NULL) {
+      OPCALL *c;
+      for (c = ip->perf; c->op != NULL; c++) {
+        ip->pds = c->op;
+        if (UNLIKELY((error = (*c->op->opadr)(csound, c->op)) != 0 ||
+                     ip->pds != c->op || p->ip == NULL))
+          break;
+      }
+      if (c->op == NULL || error != 0 || p->ip == NULL)
+        return 0;
+      if ((start = ip->pds) == NULL)
+        return 0;
+      if (UNLIKELY(!ATOMIC_GET8(ip->actflg)))
+        return 1;
+    }
+    if ((CS_PDS = start->nxtp) != NULL) {
+      CS_PDS->insdshead->pds = NULL;
+      do {
+        if (UNLIKELY(!ATOMIC_GET8(p->ip->actflg))) return 1;
+        error = (*CS_PDS->opadr)(csound, CS_PDS);
+        if (CS_PDS->insdshead->pds != NULL &&
+            CS_PDS->insdshead->pds->insdshead) {
+          CS_PDS = CS_PDS->insdshead->pds;
+          CS_PDS->insdshead->pds = NULL;
+        }
+      } while (error == 0 && p->ip != NULL
+               && (CS_PDS = CS_PDS->nxtp));
+    }
+    return 0;
+}
+
 int useropcd1(CSOUND *csound, UOPCODE *p)
 {
   OPDS    *saved_pds = CS_PDS;
-  int    g_ksmps, ofs, early, offset, i;
+  int    g_ksmps, early, offset, i, b, ofs, lksmps, incr;
   OPCODINFO   *inm;
   CS_VARIABLE* current;
   INSDS    *this_instr = p->ip;
   MYFLT** internal_ptrs = p->buf->iobufp_ptrs;
   MYFLT** external_ptrs = p->ar;
+  LKSMPS_SCHED sched;
   int done;
 
   done = ATOMIC_GET(p->ip->init_done);
@@ -1903,230 +2309,38 @@ int useropcd1(CSOUND *csound, UOPCODE *p)
   p->ip->relesing = p->parent_ip->relesing;   /* IV - Nov 16 2002 */
   early = p->h.insdshead->ksmps_no_end;
   offset = p->h.insdshead->ksmps_offset;
-  p->ip->spin = p->parent_ip->spin;
-  p->ip->spout = p->parent_ip->spout;
   inm = p->buf->opcode_info;
 
   /* global ksmps is the caller instr ksmps minus sample-accurate end */
   g_ksmps = CS_KSMPS - early;
 
-  /* sample-accurate offset */
-  ofs = offset;
-
-  /* clear offsets, since with CS_KSMPS=1
-     they don't apply to opcodes, but to the
-     calling code (ie. this code)
-  */
+  /* whole local k-cycles before the offset and after the early end are
+     skipped; the remainders go to the opcodes of the first and last
+     ones.  With a local ksmps of 1 there are none. */
+  lksmps = this_instr->ksmps;
+  incr = csound->nchnls * lksmps;
+  local_ksmps_schedule(&sched, CS_KSMPS, lksmps, offset, early);
+  local_ksmps_spout(csound, &sched);
+  ofs = sched.first * lksmps;
+  this_instr->spin = p->parent_ip->spin + sched.first * incr;
+  this_instr->spout = p->parent_ip->spout + sched.first * incr;
+  this_instr->kcounter += sched.first;
+
+  for (b = 0; b < sched.count; b++, ofs += lksmps) {
+    UDO_XFER *x = (UDO_XFER*) p->xfer.auxp;
+    this_instr->ksmps_offset = (b == 0 ? sched.offset : 0);
+    this_instr->ksmps_no_end = (b == sched.count - 1 ? sched.early : 0);
+    udo_xfer(csound, x, p->nxin, ofs, lksmps, 0);
+    if (udo_chain_run(csound, p))
+      goto endop;
+    udo_xfer(csound, x + p->nxin, p->nxout, ofs, lksmps, 1);
+    this_instr->spout += incr;
+    this_instr->spin  += incr;
+    this_instr->kcounter++;
+  }
   this_instr->ksmps_offset = 0;
   this_instr->ksmps_no_end = 0;
 
-  if (this_instr->ksmps == 1) {           /* special case for local kr == sr */
-    do {
-      /* copy inputs */
-      current = inm->in_arg_pool->head;
-      for (i = 0; i < inm->inchns; i++) {
-        // this hardcoded type check for non-perf time vars needs to change
-        //to use generic code...
-        // skip a-vars for now, handle uniquely within performance loop
-        if (current->varType != &CS_VAR_TYPE_I &&
-            current->varType != &CS_VAR_TYPE_b &&
-            current->varType != &CS_VAR_TYPE_A &&
-            current->subType != &CS_VAR_TYPE_I &&
-            current->subType != &CS_VAR_TYPE_A) {
-          // This one checks if an array has a subtype of 'i'
-          void* in = (void*)external_ptrs[i + inm->outchns];
-          void* out = (void*)internal_ptrs[i + inm->outchns];
-          current->varType->copyValue(csound, out, in);
-        } else if (current->varType == &CS_VAR_TYPE_A) {
-          MYFLT* in = (void*)external_ptrs[i + inm->outchns];
-          MYFLT* out = (void*)internal_ptrs[i + inm->outchns];
-          *out = *(in + ofs);
-        } else if (current->varType == &CS_VAR_TYPE_ARRAY &&
-                   current->subType == &CS_VAR_TYPE_A) {
-          ARRAYDAT* src = (ARRAYDAT*)external_ptrs[i + inm->outchns];
-          ARRAYDAT* target = (ARRAYDAT*)internal_ptrs[i + inm->outchns];
-          int count = src->sizes[0];
-          int j;
-          if (src->dimensions > 1) {
-            for (j = 0; j < src->dimensions; j++) {
-              count *= src->sizes[j];
-            }
-          }
-
-          for (j = 0; j < count; j++) {
-            int memberOffset = j * (src->arrayMemberSize / sizeof(MYFLT));
-            MYFLT* in = src->data + memberOffset;
-            MYFLT* out = target->data + memberOffset;
-            *out = *(in + ofs);
-          }
-        }
-        current = current->next;
-      }
-
-      if ((CS_PDS = (OPDS *) (this_instr->nxtp)) != NULL) {
-        int error = 0;
-        CS_PDS->insdshead->pds = NULL;
-        do {
-          if(UNLIKELY(!ATOMIC_GET8(p->ip->actflg))) goto endop;
-          error = (*CS_PDS->opadr)(csound, CS_PDS);
-          if (CS_PDS->insdshead->pds != NULL &&
-              CS_PDS->insdshead->pds->insdshead) {
-            CS_PDS = CS_PDS->insdshead->pds;
-            CS_PDS->insdshead->pds = NULL;
-          }
-        } while (error == 0 && p->ip != NULL
-                 && (CS_PDS = CS_PDS->nxtp));
-      }
-
-      /* copy a-sig outputs, accounting for offset */
-      current = inm->out_arg_pool->head;
-      for (i = 0; i < inm->outchns; i++) {
-        if (current->varType == &CS_VAR_TYPE_A) {
-          MYFLT* in = (void*)internal_ptrs[i];
-          MYFLT* out = (void*)external_ptrs[i];
-          *(out + ofs) = *in;
-        } else if (current->varType == &CS_VAR_TYPE_ARRAY &&
-                   current->subType == &CS_VAR_TYPE_A) {
-          ARRAYDAT* src = (ARRAYDAT*)internal_ptrs[i];
-          ARRAYDAT* target = (ARRAYDAT*)external_ptrs[i];
-          int count = src->sizes[0];
-          int j;
-          if (src->dimensions > 1) {
-            for (j = 0; j < src->dimensions; j++) {
-              count *= src->sizes[j];
-            }
-          }
-
-          for (j = 0; j < count; j++) {
-            int memberOffset = j * (src->arrayMemberSize / sizeof(MYFLT));
-            MYFLT* in = src->data + memberOffset;
-            MYFLT* out = target->data + memberOffset;
-            *(out + ofs) = *in;
-          }
-        }
-
-        current = current->next;
-      }
-
-
-      this_instr->kcounter++;
-      this_instr->spout += csound->nchnls;
-      this_instr->spin  += csound->nchnls;
-    } while (++ofs < g_ksmps);
-  }
-  else {
-    /* generic case for local kr != sr */
-    /* we have to deal with sample-accurate code
-       whole CS_KSMPS blocks are offset here, the
-       remainder is left to each opcode to deal with.
-    */
-    int start = 0;
-    int lksmps = this_instr->ksmps;
-    while (ofs >= lksmps) {
-      ofs -= lksmps;
-      start++;
-    }
-    this_instr->ksmps_offset = ofs;
-    ofs = start;
-    if (UNLIKELY(early)) this_instr->ksmps_no_end = early % lksmps;
-
-    do {
-      /* copy a-sig inputs, accounting for offset */
-      size_t asigSize = (this_instr->ksmps * sizeof(MYFLT));
-      current = inm->in_arg_pool->head;
-      for (i = 0; i < inm->inchns; i++) {
-        // this hardcoded type check for non-perf time vars needs to change
-        // to use generic code...
-        // skip a-vars for now, handle uniquely within performance loop
-        if (current->varType != &CS_VAR_TYPE_I &&
-            current->varType != &CS_VAR_TYPE_b &&
-            current->varType != &CS_VAR_TYPE_A &&
-            current->subType != &CS_VAR_TYPE_I &&
-            current->subType != &CS_VAR_TYPE_A) {
-          // This one checks if an array has a subtype of 'i'
-          void* in = (void*)external_ptrs[i + inm->outchns];
-          void* out = (void*)internal_ptrs[i + inm->outchns];
-          current->varType->copyValue(csound, out, in);
-        } else if (current->varType == &CS_VAR_TYPE_A) {
-          MYFLT* in = (void*)external_ptrs[i + inm->outchns];
-          MYFLT* out = (void*)internal_ptrs[i + inm->outchns];
-          memcpy(out, in + ofs, asigSize);
-        } else if (current->varType == &CS_VAR_TYPE_ARRAY &&
-                   current->subType == &CS_VAR_TYPE_A) {
-          ARRAYDAT* src = (ARRAYDAT*)external_ptrs[i + inm->outchns];
-          ARRAYDAT* target = (ARRAYDAT*)internal_ptrs[i + inm->outchns];
-          int count = src->sizes[0];
-          int j;
-          if (src->dimensions > 1) {
-            for (j = 0; j < src->dimensions; j++) {
-              count *= src->sizes[j];
-            }
-          }
-
-          for (j = 0; j < count; j++) {
-            int memberOffset = j * (src->arrayMemberSize / sizeof(MYFLT));
-            MYFLT* in = src->data + memberOffset;
-            MYFLT* out = target->data + memberOffset;
-            memcpy(out, in + ofs, asigSize);
-          }
-        }
-        current = current->next;
-      }
-
-      /*  run each opcode  */
-      if ((CS_PDS = (OPDS *) (this_instr->nxtp)) != NULL) {
-        int error = 0;
-        CS_PDS->insdshead->pds = NULL;
-        do {
-          if(UNLIKELY(!ATOMIC_GET8(p->ip->actflg))) goto endop;
-          error = (*CS_PDS->opadr)(csound, CS_PDS);
-          if (CS_PDS->insdshead->pds != NULL &&
-              CS_PDS->insdshead->pds->insdshead) {
-            CS_PDS = CS_PDS->insdshead->pds;
-            CS_PDS->insdshead->pds = NULL;
-          }
-        } while (error == 0 && p->ip != NULL
-                 && (CS_PDS = CS_PDS->nxtp));
-      }
-
-      /* copy a-sig outputs, accounting for offset */
-      current = inm->out_arg_pool->head;
-      for (i = 0; i < inm->outchns; i++) {
-        if (current->varType == &CS_VAR_TYPE_A) {
-          MYFLT* in = (void*)internal_ptrs[i];
-          MYFLT* out = (void*)external_ptrs[i];
-          memcpy(out + ofs, in, asigSize);
-        } else if (current->varType == &CS_VAR_TYPE_ARRAY &&
-                   current->subType == &CS_VAR_TYPE_A) {
-          ARRAYDAT* src = (ARRAYDAT*)internal_ptrs[i];
-          ARRAYDAT* target = (ARRAYDAT*)external_ptrs[i];
-          int count = src->sizes[0];
-          int j;
-          if (src->dimensions > 1) {
-            for (j = 0; j < src->dimensions; j++) {
-              count *= src->sizes[j];
-            }
-          }
-
-          for (j = 0; j < count; j++) {
-            int memberOffset = j * (src->arrayMemberSize / sizeof(MYFLT));
-            MYFLT* in = src->data + memberOffset;
-            MYFLT* out = target->data + memberOffset;
-            memcpy(out + ofs, in, asigSize);
-          }
-
-        }
-
-        current = current->next;
-      }
-
-      this_instr->spout += csound->nchnls*lksmps;
-      this_instr->spin  += csound->nchnls*lksmps;
-      this_instr->kcounter++;
-    } while ((ofs += this_instr->ksmps) < g_ksmps);
-  }
-
-
   /* copy outputs */
   current = inm->out_arg_pool->head;
   for (i = 0; i < inm->outchns; i++) {
@@ -2146,19 +2360,14 @@ int useropcd1(CSOUND *csound, UOPCODE *p)
 
         /* clear the end portion of outputs for sample accurate end */
         if (early) {
-          memset((char*)out + g_ksmps, '\0', sizeof(MYFLT) * early);
+          memset((MYFLT*)out + g_ksmps, '\0', sizeof(MYFLT) * early);
         }
       } else if (current->varType == &CS_VAR_TYPE_ARRAY &&
                  current->subType == &CS_VAR_TYPE_A) {
         if (offset || early) {
           ARRAYDAT* outDat = (ARRAYDAT*)out;
-          int count = outDat->sizes[0];
+          int count = udo_array_count(outDat);
           int j;
-          if (outDat->dimensions > 1) {
-            for (j = 0; j < outDat->dimensions; j++) {
-              count *= outDat->sizes[j];
-            }
-          }
 
           if (offset) {
             for (j = 0; j < count; j++) {
@@ -2313,6 +2522,149 @@ int findLabelMemOffset(CSOUND* csound, INSTRTXT* ip, char* labelName) {
   return offset;
 }
 
+/* Pre-resolved perf chains.
+ * Each instance of an instrument with no perf-time jumps (no opcode
+ * taking a label) carries a flat array of its perf opcodes, after the
+ * opds, so that kperf can call them in a tight loop instead of
+ * following nxtp.  Each routine is read from the opds at the call, as
+ * opcodes choose theirs at init and some replace it at perf time (the
+ * bus.c opcodes on an error).  An opcode that still moves pds (a
+ * turnoff) hands the rest of the k-period back to the nxtp chain.
+ */
+#define PERF_ALIGN(n) (((n) + sizeof(void*) - 1) & ~(sizeof(void*) - 1))
+
+/* entries in the dispatch table of tp, or -1 for none */
+static int perf_table_size(INSTRTXT *tp)
+{
+  OPTXT *optxt = (OPTXT*) tp;
+  int   n = 1;
+  if (tp->perfops != 0) return tp->perfops;
+  while ((optxt = optxt->nxtop) != NULL) {
+    const OENTRY *ep = optxt->t.oentry;
+    if (strcmp(ep->opname, "endin") == 0 || strcmp(ep->opname, "endop") == 0)
+      break;
+    if (strcmp(ep->opname, "pset") == 0 || strcmp(ep->opname, "$label") == 0)
+      continue;
+    if ((ep->thread & 03) == 0 ? optxt->t.pftype != 'b' : (ep->thread & 02)) {
+      if (ep->intypes != NULL && strchr(ep->intypes, 'l') != NULL)
+        return (tp->perfops = -1);
+      n++;
+    }
+  }
+  return (tp->perfops = n);
+}
+
+/* bytes needed for an instance of tp, and the pfield space before lclbas */
+static size_t instance_size(CSOUND *csound, INSTRTXT *tp, int *pextent)
+{
+  OPARMS    *O = csound->oparms;
+  int       n = 3, i, pextrab;
+  if (O->midiKey>n) n = O->midiKey;
+  if (O->midiKeyCps>n) n = O->midiKeyCps;
+  if (O->midiKeyOct>n) n = O->midiKeyOct;
+  if (O->midiKeyPch>n) n = O->midiKeyPch;
+  if (O->midiVelocity>n) n = O->midiVelocity;
+  if (O->midiVelocityAmp>n) n = O->midiVelocityAmp;
+  pextrab = ((i = tp->pmax - 3L) > 0 ? (int) i * sizeof(CS_VAR_MEM) : 0);
+  *pextent = sizeof(INSDS) + pextrab + (n-3)*sizeof(CS_VAR_MEM);
+  i = perf_table_size(tp);
+  return (size_t) *pextent + tp->varPool->poolSize +
+    (tp->varPool->varCount * CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
+    (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
+    tp->opdstot + (i > 0 ? sizeof(void*) + i * sizeof(OPCALL) : 0);
+}
+
+/* Instance slabs (--instance-slab=N).
+ * All instances of an instrument have the same size, so each INSTRTXT can
+ * carve them out of chunks of N blocks: a new instance is a pop from the
+ * free list or a pointer bump, and only every Nth one goes to Calloc.
+ * Freed instances go back on the free list; the chunks are released with
+ * the instrument.
+ * --instance-layout turns slabs on by default, and insert() then keeps
+ * the instances of one instrument in address order in the active chain,
+ * so kperf walks each slab forwards.
+ */
+#define SLAB_HDR 16             /* chunk link, keeps blocks aligned */
+#define SLAB_ALIGN(n) (((n) + 15) & ~((size_t) 15))
+#define SLAB_LAYOUT_DEFAULT 32
+
+static inline int slab_nper(CSOUND *csound)
+{
+  OPARMS *O = csound->oparms;
+  if (O->instanceSlab > 0) return O->instanceSlab;
+  return O->instanceLayout ? SLAB_LAYOUT_DEFAULT : 0;
+}
+
+static void insds_slab_grow(CSOUND *csound, INSDS_SLAB *s)
+{
+  char *chunk = (char *) csound->Calloc(csound, SLAB_HDR + s->nper*s->blksiz);
+  *(void **) chunk = s->chunks;
+  s->chunks = chunk;
+  s->next = chunk + SLAB_HDR;
+  s->end = s->next + s->nper*s->blksiz;
+}
+
+static INSDS_SLAB *insds_slab_new(CSOUND *csound, INSTRTXT *tp)
+{
+  int pextent;
+  INSDS_SLAB *s = (INSDS_SLAB *) csound->Calloc(csound, sizeof(INSDS_SLAB));
+  s->blksiz = SLAB_ALIGN(instance_size(csound, tp, &pextent));
+  s->nper = slab_nper(csound);
+  tp->slab = s;
+  return s;
+}
+
+/* called when an instrument has been compiled, to take the first chunk
+   off the performance thread */
+void insds_slab_prewarm(CSOUND *csound, INSTRTXT *tp)
+{
+  if (slab_nper(csound) > 0 && tp->slab == NULL)
+    insds_slab_grow(csound, insds_slab_new(csound, tp));
+}
+
+static INSDS *insds_alloc(CSOUND *csound, INSTRTXT *tp, size_t size)
+{
+  INSDS_SLAB *s = tp->slab;
+  char *p;
+  if (slab_nper(csound) <= 0)
+    return (INSDS *) csound->Calloc(csound, size);
+  if (s == NULL) s = insds_slab_new(csound, tp);
+  if ((p = (char *) s->free) != NULL) {
+    s->free = *(void **) p;
+    memset(p, '\0', s->blksiz);
+    return (INSDS *) p;
+  }
+  if (s->next == s->end) insds_slab_grow(csound, s);
+  p = s->next;
+  s->next += s->blksiz;
+  return (INSDS *) p;
+}
+
+/* release the memory of an instance of tp */
+void insds_free(CSOUND *csound, INSTRTXT *tp, INSDS *ip)
+{
+  if (tp->slab == NULL) {
+    csound->Free(csound, ip);
+    return;
+  }
+  *(void **) ip = tp->slab->free;
+  tp->slab->free = ip;
+}
+
+/* release all chunks of tp, after its instances */
+void insds_slab_free(CSOUND *csound, INSTRTXT *tp)
+{
+  INSDS_SLAB *s = tp->slab;
+  if (s == NULL) return;
+  while (s->chunks != NULL) {
+    void *nxt = *(void **) s->chunks;
+    csound->Free(csound, s->chunks);
+    s->chunks = nxt;
+  }
+  csound->Free(csound, s);
+  tp->slab = NULL;
+}
+
 /* create instance of an instr template */
 /*   allocates and sets up all pntrs    */
 
@@ -2323,7 +2675,7 @@ static void instance(CSOUND *csound, int insno)
   OPTXT     *optxt;
   OPDS      *opds, *prvids, *prvpds;
   const OENTRY  *ep;
-  int       i, n, pextent, pextra, pextrab;
+  int       n, pextent;
   char      *nxtopds, *opdslim;
   MYFLT     **argpp, *lclbas;
   CS_VAR_MEM *lcloffbas; // start of pfields
@@ -2336,24 +2688,8 @@ static void instance(CSOUND *csound, int insno)
   CS_VARIABLE* current;
 
   tp = csound->engineState.instrtxtp[insno];
-  n = 3;
-  if (O->midiKey>n) n = O->midiKey;
-  if (O->midiKeyCps>n) n = O->midiKeyCps;
-  if (O->midiKeyOct>n) n = O->midiKeyOct;
-  if (O->midiKeyPch>n) n = O->midiKeyPch;
-  if (O->midiVelocity>n) n = O->midiVelocity;
-  if (O->midiVelocityAmp>n) n = O->midiVelocityAmp;
-  pextra = n-3;
-  pextrab = ((i = tp->pmax - 3L) > 0 ? (int) i * sizeof(CS_VAR_MEM) : 0);
   /* alloc new space,  */
-  pextent = sizeof(INSDS) + pextrab + pextra*sizeof(CS_VAR_MEM);
-  ip =
-    (INSDS*) csound->Calloc(csound,
-                            (size_t) pextent + tp->varPool->poolSize +
-                            (tp->varPool->varCount *
-                             CS_FLOAT_ALIGN(CS_VAR_TYPE_OFFSET)) +
-                            (tp->varPool->varCount * sizeof(CS_VARIABLE*)) +
-                            tp->opdstot);
+  ip = insds_alloc(csound, tp, instance_size(csound, tp, &pextent));
   ip->csound = csound;
   ip->m_chnbp = (MCHNBLK*) NULL;
   ip->instr = tp;
@@ -2544,6 +2880,15 @@ static void instance(CSOUND *csound, int insno)
   if (UNLIKELY(nxtopds > opdslim))
     csoundDie(csound, Str("inconsistent opds total"));
 
+  if ((n = perf_table_size(tp)) > 0) {
+    OPCALL *c = (OPCALL*) PERF_ALIGN((uintptr_t) opdslim);
+    ip->perf = c;
+    for (opds = ip->nxtp; opds != NULL; opds = opds->nxtp, c++) {
+      if (UNLIKELY(--n <= 0))
+        csoundDie(csound, Str("inconsistent perf chain"));
+      c->op = opds;
+    }
+  }
 }
 
 int prealloc_(CSOUND *csound, AOP *p, int instname)
@@ -2599,7 +2944,8 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
   active = ip->instance;
   while (active != NULL) {    /* Check there are no active instances */
     INSDS   *nxt = active->nxtinstance;
-    if (UNLIKELY(active->actflg)) { /* Can only remove non-active instruments */
+    if (UNLIKELY(active->actflg || active->reclaiming)) {
+      /* Can only remove non-active instruments */
       char *name = csound->engineState.instrtxtp[n]->insname;
       if (name)
         return csound->InitError(csound,
@@ -2617,9 +2963,10 @@ int delete_instr(CSOUND *csound, DELETEIN *p)
     if (active->auxchp != NULL)
       auxchfree(csound, active);
     free_instr_var_memory(csound, active);
-    csound->Free(csound, active);
+    insds_free(csound, ip, active);
     active = nxt;
   }
+  insds_slab_free(csound, ip);
   csound->engineState.instrtxtp[n] = NULL;
   /* Now patch it out */
   for (txtp = &(csound->engineState.instxtanchor);
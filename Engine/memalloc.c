@@ -34,9 +34,34 @@
 
 #define MEMALLOC_MAGIC  0x6D426C6B
 /* The memory list must be controlled by mutex */
-#define CSOUND_MEM_SPINLOCK csoundSpinLock(&csound->memlock);
+#define CSOUND_MEM_SPINLOCK                                         \
+    if (UNLIKELY(csoundSpinTryLock(&csound->memlock) != CSOUND_SUCCESS)) { \
+      csoundSpinLock(&csound->memlock);                             \
+      csound->mem_lock_contended++;                                 \
+    }                                                               \
+    csound->mem_lock_count++;
 #define CSOUND_MEM_SPINUNLOCK csoundSpinUnLock(&csound->memlock);
 
+/* With --mem-arenas every thread links the blocks it allocates into a
+   list of its own, so only the first allocation of a thread takes the
+   lock.  A block freed by a thread other than its owner is pushed onto
+   a lock-free stack of the owning arena, and is unlinked and released
+   by the owner at its next allocation or free.  A thread leaving the
+   engine releases that stack and gives up its arena, which the next new
+   thread takes over; until then other threads free its blocks directly,
+   under the lock.  memRESET() walks all the arenas.  This needs a
+   thread-local variable and atomic pointer exchange; without them
+   everything stays on the one locked list. */
+#if defined(MSVC)
+#  define MEM_THREAD_LOCAL __declspec(thread)
+#  define MEM_ARENAS 1
+#elif defined(__GNUC__) && defined(HAVE_ATOMIC_BUILTIN)
+#  define MEM_THREAD_LOCAL __thread
+#  define MEM_ARENAS 1
+#endif
+
+struct memArena_s;
+
 typedef struct memAllocBlock_s {
 #ifdef MEMDEBUG
     int                     magic;      /* 0x6D426C6B ("mBlk")          */
@@ -44,6 +69,13 @@ typedef struct memAllocBlock_s {
 #endif
     struct memAllocBlock_s  *prv;       /* previous structure in chain  */
     struct memAllocBlock_s  *nxt;       /* next structure in chain      */
+#ifdef MEM_ARENAS
+    struct memArena_s       *arena;     /* owner, NULL for global chain */
+    union {
+      size_t                 size;      /* size of the data area        */
+      struct memAllocBlock_s *rnxt;     /* next on remote free stack    */
+    } u;
+#endif
 } memAllocBlock_t;
 
 #define HDR_SIZE    (((int) sizeof(memAllocBlock_t) + 7) & (~7))
@@ -53,6 +85,175 @@ typedef struct memAllocBlock_s {
 
 #define MEMALLOC_DB (csound->memalloc_db)
 
+#ifdef MEM_ARENAS
+
+typedef struct memArena_s {
+    memAllocBlock_t     *db;            /* blocks owned by this thread  */
+    memAllocBlock_t     *volatile remote;  /* freed by other threads    */
+    void                *owner;         /* thread tag, NULL once left   */
+    struct memArena_s   *nxt;
+    uint64_t            allocs, remote_frees;
+} memArena_t;
+
+/* the address of this variable identifies the calling thread */
+static MEM_THREAD_LOCAL struct {
+    CSOUND      *csound;
+    int         epoch;
+    memArena_t  *arena;
+} mem_tls;
+
+static int mem_epoch_next = 0;
+
+#if defined(MSVC)
+#define MEM_LOAD_PTR(p) (*(p))
+#define MEM_XCHG_PTR(p, v) \
+    InterlockedExchangePointer((PVOID volatile *) (p), (v))
+#define MEM_CAS_PTR(p, nv, ov) \
+    (InterlockedCompareExchangePointer((PVOID volatile *) (p), (nv), (ov)) \
+     == (ov))
+#else
+#define MEM_LOAD_PTR(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define MEM_XCHG_PTR(p, v) __atomic_exchange_n(p, v, __ATOMIC_ACQ_REL)
+#define MEM_CAS_PTR(p, nv, ov) \
+    __atomic_compare_exchange_n(p, &(ov), nv, 0, \
+                                __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+#endif
+
+/* arena of the calling thread, NULL if arenas are off */
+static memArena_t *mem_arena(CSOUND *csound)
+{
+    memArena_t *a, *spare = NULL;
+
+    if (csound->oparms == NULL || !csound->oparms->memArenas)
+      return NULL;
+    if (LIKELY(mem_tls.csound == csound && mem_tls.epoch != 0 &&
+               mem_tls.epoch == csound->mem_arena_epoch))
+      return mem_tls.arena;
+    CSOUND_MEM_SPINLOCK
+    /* the epoch tells a live arena from one a reset has freed */
+    while (csound->mem_arena_epoch == 0)
+      csound->mem_arena_epoch = ATOMIC_INCR(mem_epoch_next);
+    for (a = (memArena_t*) csound->mem_arenas; a != NULL; a = a->nxt) {
+      if (a->owner == (void*) &mem_tls)
+        break;
+      if (a->owner == NULL && spare == NULL)
+        spare = a;
+    }
+    if (a == NULL && spare != NULL) {
+      a = spare;                        /* left by a thread that exited */
+      a->owner = (void*) &mem_tls;
+    }
+    else if (a == NULL &&
+             (a = (memArena_t*) calloc(1, sizeof(memArena_t))) != NULL) {
+      a->owner = (void*) &mem_tls;
+      a->nxt = (memArena_t*) csound->mem_arenas;
+      csound->mem_arenas = (void*) a;
+    }
+    CSOUND_MEM_SPINUNLOCK
+    if (a != NULL) {
+      mem_tls.csound = csound;
+      mem_tls.epoch = csound->mem_arena_epoch;
+      mem_tls.arena = a;
+    }
+    return a;
+}
+
+static inline void arena_unlink(memArena_t *a, memAllocBlock_t *pp)
+{
+    memAllocBlock_t *prv = pp->prv, *nxt = pp->nxt;
+    if (nxt != NULL)
+      nxt->prv = prv;
+    if (prv != NULL)
+      prv->nxt = nxt;
+    else
+      a->db = nxt;
+}
+
+/* release the blocks other threads have handed back */
+static void arena_drain(memArena_t *a)
+{
+    memAllocBlock_t *pp, *nxt;
+
+    if (LIKELY(MEM_LOAD_PTR(&a->remote) == NULL))
+      return;
+    pp = (memAllocBlock_t*) MEM_XCHG_PTR(&a->remote, NULL);
+    while (pp != NULL) {
+      nxt = pp->u.rnxt;
+      arena_unlink(a, pp);
+      free((void*) pp);
+      a->remote_frees++;
+      pp = nxt;
+    }
+}
+
+static void *arena_link(memArena_t *a, memAllocBlock_t *pp, size_t size)
+{
+    arena_drain(a);
+    pp->arena = a;
+    pp->u.size = size;
+    pp->prv = (memAllocBlock_t*) NULL;
+    pp->nxt = a->db;
+    if (a->db != NULL)
+      a->db->prv = pp;
+    a->db = pp;
+    a->allocs++;
+    return DATA_PTR(pp);
+}
+
+/* free a block owned by another thread's arena */
+static void arena_free_remote(memArena_t *a, memAllocBlock_t *pp)
+{
+    memAllocBlock_t *old = MEM_LOAD_PTR(&a->remote);
+    do {
+      pp->u.rnxt = old;
+    } while (!MEM_CAS_PTR(&a->remote, pp, old));
+}
+
+/* free a block of an arena whose thread has exited; the lock keeps
+   other threads from taking the arena over meanwhile.  Returns 0 if the
+   arena has an owner. */
+static int arena_free_orphan(CSOUND *csound, memArena_t *a,
+                             memAllocBlock_t *pp)
+{
+    if (MEM_LOAD_PTR(&a->owner) != NULL)
+      return 0;
+    CSOUND_MEM_SPINLOCK
+    if (a->owner != NULL) {
+      CSOUND_MEM_SPINUNLOCK
+      return 0;
+    }
+    arena_unlink(a, pp);
+    free((void*) pp);
+    a->remote_frees++;
+    arena_drain(a);             /* pushed while the owner was leaving */
+    CSOUND_MEM_SPINUNLOCK
+    return 1;
+}
+
+#endif  /* MEM_ARENAS */
+
+/* link a block at the head of the global chain, with the lock held */
+static inline void global_link(CSOUND *csound, memAllocBlock_t *pp)
+{
+    pp->prv = (memAllocBlock_t*) NULL;
+    pp->nxt = (memAllocBlock_t*) MEMALLOC_DB;
+    if (MEMALLOC_DB != NULL)
+      ((memAllocBlock_t*) MEMALLOC_DB)->prv = pp;
+    MEMALLOC_DB = (void*) pp;
+}
+
+/* unlink a block from the global chain, with the lock held */
+static inline void global_unlink(CSOUND *csound, memAllocBlock_t *pp)
+{
+    memAllocBlock_t *prv = pp->prv, *nxt = pp->nxt;
+    if (nxt != NULL)
+      nxt->prv = prv;
+    if (prv != NULL)
+      prv->nxt = nxt;
+    else
+      MEMALLOC_DB = (void*) nxt;
+}
+
 static void memdie(CSOUND *csound, size_t nbytes)
 {
     csound->ErrorMsg(csound, Str("memory allocate failure for %zd"),
@@ -79,6 +280,15 @@ void *mmalloc(CSOUND *csound, size_t size)
 #ifdef MEMDEBUG
     ((memAllocBlock_t*) p)->magic = MEMALLOC_MAGIC;
     ((memAllocBlock_t*) p)->ptr = DATA_PTR(p);
+#endif
+#ifdef MEM_ARENAS
+    {
+      memArena_t *a = mem_arena(csound);
+      if (a != NULL)
+        return arena_link(a, (memAllocBlock_t*) p, size);
+      ((memAllocBlock_t*) p)->arena = NULL;
+      ((memAllocBlock_t*) p)->u.size = size;
+    }
 #endif
     CSOUND_MEM_SPINLOCK
     ((memAllocBlock_t*) p)->prv = (memAllocBlock_t*) NULL;
@@ -117,6 +327,15 @@ void *mcalloc(CSOUND *csound, size_t size)
 #ifdef MEMDEBUG
     ((memAllocBlock_t*) p)->magic = MEMALLOC_MAGIC;
     ((memAllocBlock_t*) p)->ptr = DATA_PTR(p);
+#endif
+#ifdef MEM_ARENAS
+    {
+      memArena_t *a = mem_arena(csound);
+      if (a != NULL)
+        return arena_link(a, (memAllocBlock_t*) p, size);
+      ((memAllocBlock_t*) p)->arena = NULL;
+      ((memAllocBlock_t*) p)->u.size = size;
+    }
 #endif
     CSOUND_MEM_SPINLOCK
     ((memAllocBlock_t*) p)->prv = (memAllocBlock_t*) NULL;
@@ -157,6 +376,19 @@ void mfree(CSOUND *csound, void *p)
     }
     pp->magic = 0;
  #endif
+#ifdef MEM_ARENAS
+    if (pp->arena != NULL) {
+      memArena_t *a = mem_arena(csound);
+      if (pp->arena == a) {
+        arena_unlink(a, pp);
+        free((void*) pp);
+        arena_drain(a);
+      }
+      else if (!arena_free_orphan(csound, pp->arena, pp))
+        arena_free_remote(pp->arena, pp);
+      return;
+    }
+#endif
     CSOUND_MEM_SPINLOCK
     /* unlink from chain */
     {
@@ -184,6 +416,7 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
 {
     memAllocBlock_t *pp;
     void            *p;
+    int             locked = 1;
 
     if (UNLIKELY(oldp == NULL))
       return mmalloc(csound, size);
@@ -200,6 +433,28 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
       /* as a result of a bug */
       exit(-1);
     }
+#endif
+#ifdef MEM_ARENAS
+    if (pp->arena != NULL && pp->arena != mem_arena(csound)) {
+      /* cannot relink into another thread's chain: move the data */
+      size_t  n = pp->u.size < size ? pp->u.size : size;
+      p = mmalloc(csound, size);
+      memcpy(p, oldp, n);
+      mfree(csound, oldp);
+      return p;
+    }
+#endif
+#ifdef MEM_ARENAS
+    locked = (pp->arena == NULL);
+#endif
+    /* a block on the global chain is unlinked while it moves, so that the
+       lock is not held across realloc() copying it */
+    if (locked) {
+      CSOUND_MEM_SPINLOCK
+      global_unlink(csound, pp);
+      CSOUND_MEM_SPINUNLOCK
+    }
+#ifdef MEMDEBUG
     /* mark old header as invalid */
     pp->magic = 0;
     pp->ptr = NULL;
@@ -208,32 +463,43 @@ void *mrealloc(CSOUND *csound, void *oldp, size_t size)
     p = realloc((void*) pp, ALLOC_BYTES(size));
     if (UNLIKELY(p == NULL)) {
 #ifdef MEMDEBUG
-      CSOUND_MEM_SPINLOCK
       /* alloc failed, restore original header */
       pp->magic = MEMALLOC_MAGIC;
       pp->ptr = oldp;
-      CSOUND_MEM_SPINUNLOCK
 #endif
+      if (locked) {
+        CSOUND_MEM_SPINLOCK
+        global_link(csound, pp);
+        CSOUND_MEM_SPINUNLOCK
+      }
       memdie(csound, size);
       return NULL;
     }
-    CSOUND_MEM_SPINLOCK
     /* create new header and update chain pointers */
     pp = (memAllocBlock_t*) p;
 #ifdef MEMDEBUG
     pp->magic = MEMALLOC_MAGIC;
     pp->ptr = DATA_PTR(pp);
 #endif
-    {
+#ifdef MEM_ARENAS
+    pp->u.size = size;
+#endif
+    if (locked) {
+      CSOUND_MEM_SPINLOCK
+      global_link(csound, pp);
+      CSOUND_MEM_SPINUNLOCK
+    }
+#ifdef MEM_ARENAS
+    else {                              /* our own chain, in place */
       memAllocBlock_t *prv = pp->prv, *nxt = pp->nxt;
       if (nxt != NULL)
         nxt->prv = pp;
       if (prv != NULL)
         prv->nxt = pp;
       else
-        MEMALLOC_DB = (void*) pp;
+        pp->arena->db = pp;
     }
-    CSOUND_MEM_SPINUNLOCK
+#endif
     /* return with data pointer */
     return DATA_PTR(pp);
 }
@@ -259,4 +525,68 @@ void memRESET(CSOUND *csound)
       free((void*) pp);
       pp = nxtp;
     }
+#ifdef MEM_ARENAS
+    /* blocks on the remote stacks are still in their owner's chain */
+    while (csound->mem_arenas != NULL) {
+      memArena_t *a = (memArena_t*) csound->mem_arenas;
+      csound->mem_arenas = (void*) a->nxt;
+      pp = a->db;
+      while (pp != NULL) {
+        nxtp = pp->nxt;
+#ifdef MEMDEBUG
+        pp->magic = 0;
+#endif
+        free((void*) pp);
+        pp = nxtp;
+      }
+      free((void*) a);
+    }
+    csound->mem_arena_epoch = 0;
+#endif
+}
+
+/* called by an engine thread before it exits: releases the blocks other
+   threads have freed from its arena and leaves the arena to the next
+   thread, so that they do not pile up until the reset */
+void mem_arena_exit(CSOUND *csound)
+{
+#ifdef MEM_ARENAS
+    memArena_t *a;
+
+    if (mem_tls.csound != csound || mem_tls.epoch == 0 ||
+        mem_tls.epoch != csound->mem_arena_epoch)
+      return;
+    a = mem_tls.arena;
+    CSOUND_MEM_SPINLOCK
+    arena_drain(a);
+    a->owner = NULL;
+    CSOUND_MEM_SPINUNLOCK
+    mem_tls.csound = NULL;
+    mem_tls.epoch = 0;
+    mem_tls.arena = NULL;
+#else
+    (void) csound;
+#endif
+}
+
+void mem_contention_report(CSOUND *csound)
+{
+    uint64_t allocs = 0, remote = 0;
+#ifdef MEM_ARENAS
+    memArena_t *a;
+    int n = 0;
+    for (a = (memArena_t*) csound->mem_arenas; a != NULL; a = a->nxt, n++) {
+      allocs += a->allocs;
+      remote += a->remote_frees;
+    }
+    if (n)
+      csound->Message(csound,
+                      Str("memory: %d thread arenas, %lu allocations, "
+                          "%lu freed by other threads\n"),
+                      n, (unsigned long) allocs, (unsigned long) remote);
+#endif
+    csound->Message(csound,
+                    Str("memory: %lu locked list operations, %lu contended\n"),
+                    (unsigned long) csound->mem_lock_count,
+                    (unsigned long) csound->mem_lock_contended);
 }
@@ -32,6 +32,12 @@
 #include <sndfile.h>
 #include <string.h>
 #include <inttypes.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 static int Load_Het_File_(CSOUND *csound, const char *filnam,
                           char **allocp, int32 *len)
@@ -564,6 +570,339 @@ int PVOCEX_LoadFile(CSOUND *csound, const char *fname, PVOCEX_MEMFILE *p)
 
  /* ------------------------------------------------------------------------ */
 
+/* Memory-mapped soundfiles.  The sample data of an uncompressed WAV, AIFF
+   or raw file is used straight from a mapping of the file, so its pages
+   come from the system's file cache and are shared by every process and
+   Csound instance playing the same file.  SNDMAP_PRIVATE maps are
+   writable copy-on-write, for tables that point into the data in place;
+   the others are read-only.  All maps of an instance go at reset. */
+
+#ifdef HAVE_MMAP
+
+static int sndmap_host_bigendian(void)
+{
+    const uint16_t one = 1;
+    return (*((const unsigned char*) &one) == 0);
+}
+
+static uint32_t sndmap_get32(const unsigned char *p, int bigEndian)
+{
+    if (bigEndian)
+      return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16)
+        | ((uint32_t) p[2] << 8) | (uint32_t) p[3];
+    return ((uint32_t) p[3] << 24) | ((uint32_t) p[2] << 16)
+      | ((uint32_t) p[1] << 8) | (uint32_t) p[0];
+}
+
+/* offset of the sample data in a WAV or AIFF file of len bytes, and the
+   byte order of the samples; -1 if the header is not understood */
+
+static int64_t sndmap_data_offset(const unsigned char *h, size_t len,
+                                  int type, int *bigEndian)
+{
+    size_t  pos = 12;
+    int64_t offs = -1;
+    int     aifc;
+
+    if (type == TYP_RAW) {
+      *bigEndian = sndmap_host_bigendian();
+      return 0;
+    }
+    if (len < 12)
+      return -1;
+    if (type == TYP_WAV || type == TYP_WAVEX || type == TYP_RF64) {
+      if (memcmp(h + 8, "WAVE", 4) != 0)
+        return -1;
+      *bigEndian = (memcmp(h, "RIFX", 4) == 0);
+      while (pos + 8 <= len) {
+        uint32_t size = sndmap_get32(h + pos + 4, *bigEndian);
+        if (memcmp(h + pos, "data", 4) == 0)
+          return (int64_t) pos + 8;
+        if (size > len - pos - 8)
+          break;
+        pos += 8 + (size_t) size + (size & 1);
+      }
+    }
+    else if (type == TYP_AIFF) {
+      if (memcmp(h, "FORM", 4) != 0)
+        return -1;
+      aifc = (memcmp(h + 8, "AIFC", 4) == 0);
+      *bigEndian = 1;
+      while (pos + 16 <= len) {
+        uint32_t size = sndmap_get32(h + pos + 4, 1);
+        /* the compression type of AIFC says which byte order */
+        if (aifc && memcmp(h + pos, "COMM", 4) == 0 && pos + 30 <= len)
+          *bigEndian = (memcmp(h + pos + 26, "sowt", 4) != 0);
+        else if (memcmp(h + pos, "SSND", 4) == 0)
+          offs = (int64_t) pos + 16 + sndmap_get32(h + pos + 8, 1);
+        if (size > len - pos - 8)
+          break;
+        pos += 8 + (size_t) size + (size & 1);
+      }
+    }
+    return offs;
+}
+
+#endif
+
+/**
+ * Map the sample data of an uncompressed soundfile, already opened with
+ * libsndfile as 'sfinfo' (SF_INFO *), into memory.  Returns NULL if the
+ * file is compressed, the header is not understood, or memory mapping is
+ * not available; the caller then reads the file as usual.
+ * With SNDMAP_PRIVATE the data is writable, without changing the file,
+ * and at least one frame and a sample more can be written after its end.
+ * Unless loading is deferred (--mmap-soundfiles=defer), the pages of a
+ * private map are read in now rather than when first used.
+ */
+
+SNDMAP *csoundSndMapOpen(CSOUND *csound, const char *fullName,
+                         const void *sfi, int flags)
+{
+#ifdef HAVE_MMAP
+    const SF_INFO *sfinfo = (const SF_INFO *) sfi;
+    SNDMAP      *m;
+    struct stat st;
+    char        *base;
+    size_t      size, page, len;
+    int64_t     offs, nbytes;
+    int         fd, bigEndian = 0, sampleSize, fmt;
+
+    fmt = SF2FORMAT(sfinfo->format);
+    switch (fmt) {
+    case AE_CHAR:
+    case AE_UNCH:   sampleSize = 1; break;
+    case AE_SHORT:  sampleSize = 2; break;
+    case AE_24INT:  sampleSize = 3; break;
+    case AE_LONG:
+    case AE_FLOAT:  sampleSize = 4; break;
+    case AE_DOUBLE: sampleSize = 8; break;
+    default:        return NULL;
+    }
+    if (UNLIKELY(sfinfo->frames <= 0 || sfinfo->channels < 1))
+      return NULL;
+    if ((fd = open(fullName, O_RDONLY)) < 0)
+      return NULL;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+      close(fd);
+      return NULL;
+    }
+    size = (size_t) st.st_size;
+    page = (size_t) sysconf(_SC_PAGESIZE);
+    if (flags & SNDMAP_PRIVATE) {
+      /* reserve the room after the data, then map the file over it */
+      len = (size + page - 1) / page * page
+        + (((size_t) sfinfo->channels + 1) * 8 + page - 1) / page * page;
+      base = mmap(NULL, len, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANON, -1, 0);
+      if (base != MAP_FAILED &&
+          mmap(base, size, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, len);
+        base = MAP_FAILED;
+      }
+    }
+    else {
+      len = size;
+      base = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (base == MAP_FAILED)
+      return NULL;
+    nbytes = (int64_t) sfinfo->frames * sfinfo->channels * sampleSize;
+    offs = sndmap_data_offset((unsigned char*) base, size,
+                              SF2TYPE(sfinfo->format), &bigEndian);
+    if (offs < 0 || offs + nbytes > (int64_t) size) {
+      munmap(base, len);
+      return NULL;
+    }
+    m = (SNDMAP*) csound->Calloc(csound, sizeof(SNDMAP));
+    m->base = base;
+    m->size = len;
+    m->data = base + offs;
+    m->nFrames = (int64_t) sfinfo->frames;
+    m->nChannels = sfinfo->channels;
+    m->sampleFormat = fmt;
+    m->sampleSize = sampleSize;
+    m->bigEndian = bigEndian;
+    m->flags = flags;
+    if (!(flags & SNDMAP_PRIVATE))
+      madvise(base, len, MADV_SEQUENTIAL);
+    else {
+      char    *p = (char*) m->data - ((uintptr_t) m->data % page);
+      madvise(p, (size_t) (m->data + nbytes - p), MADV_WILLNEED);
+      if (csound->oparms->sndMap != 2) {
+        volatile char sum = 0;          /* fault every page in now */
+        for ( ; p < m->data + nbytes; p += page)
+          sum += *p;
+      }
+    }
+    csoundSpinLock(&csound->sndmaps_lock);
+    m->nxt = csound->sndmaps;
+    csound->sndmaps = m;
+    csoundSpinUnLock(&csound->sndmaps_lock);
+    return m;
+#else
+    (void) csound; (void) fullName; (void) sfi; (void) flags;
+    return NULL;
+#endif
+}
+
+/* the sample data, if it can be used in place as sampleFormat values */
+
+void *csoundSndMapNative(const SNDMAP *m, int sampleFormat)
+{
+#ifdef HAVE_MMAP
+    if (m->sampleFormat != sampleFormat ||
+        m->bigEndian != sndmap_host_bigendian() ||
+        ((uintptr_t) m->data % (uintptr_t) m->sampleSize) != 0)
+      return NULL;
+    return (void*) m->data;
+#else
+    (void) m; (void) sampleFormat;
+    return NULL;
+#endif
+}
+
+/**
+ * Convert nFrames frames from 'frame' on to MYFLT, with all channels
+ * interleaved if 'channel' is zero, otherwise only that one (1 is the
+ * first).  Integer samples are scaled to -1..1, as libsndfile does, and
+ * then everything by 'scale'.  Returns the number of frames converted,
+ * fewer than nFrames at the end of the file.
+ */
+
+int64_t csoundSndMapRead(const SNDMAP *m, MYFLT *out, int64_t frame,
+                         int64_t nFrames, int channel, MYFLT scale)
+{
+#ifdef HAVE_MMAP
+    const unsigned char *s;
+    int64_t i, n;
+    size_t  step;
+    int     swap = (m->bigEndian != sndmap_host_bigendian());
+
+    if (frame < 0 || frame >= m->nFrames || nFrames <= 0)
+      return 0;
+    if (nFrames > m->nFrames - frame)
+      nFrames = m->nFrames - frame;
+    s = (const unsigned char*) m->data
+      + (size_t) frame * m->nChannels * m->sampleSize;
+    if (channel > 0) {
+      s += (size_t) (channel - 1) * m->sampleSize;
+      step = (size_t) m->nChannels * m->sampleSize;
+      n = nFrames;
+    }
+    else {
+      step = (size_t) m->sampleSize;
+      n = nFrames * m->nChannels;
+    }
+    switch (m->sampleFormat) {
+    case AE_UNCH:
+      scale /= FL(128.0);
+      for (i = 0; i < n; i++, s += step)
+        out[i] = (MYFLT) ((int) s[0] - 128) * scale;
+      break;
+    case AE_CHAR:
+      scale /= FL(128.0);
+      for (i = 0; i < n; i++, s += step)
+        out[i] = (MYFLT) ((signed char) s[0]) * scale;
+      break;
+    case AE_SHORT:
+      scale /= FL(32768.0);
+      for (i = 0; i < n; i++, s += step)
+        out[i] = (MYFLT) (int16_t) (m->bigEndian ? (s[0] << 8) | s[1]
+                                                 : (s[1] << 8) | s[0])
+          * scale;
+      break;
+    case AE_24INT:
+      scale /= FL(2147483648.0);
+      for (i = 0; i < n; i++, s += step)
+        out[i] = (MYFLT) (int32_t) (m->bigEndian ?
+                                    ((uint32_t) s[0] << 24) | (s[1] << 16)
+                                    | (s[2] << 8) :
+                                    ((uint32_t) s[2] << 24) | (s[1] << 16)
+                                    | (s[0] << 8))
+          * scale;
+      break;
+    case AE_LONG:
+      scale /= FL(2147483648.0);
+      for (i = 0; i < n; i++, s += step)
+        out[i] = (MYFLT) (int32_t) sndmap_get32(s, m->bigEndian) * scale;
+      break;
+    case AE_FLOAT:
+      for (i = 0; i < n; i++, s += step) {
+        uint32_t u;
+        float    f;
+        if (swap)
+          u = sndmap_get32(s, m->bigEndian);
+        else
+          memcpy(&u, s, 4);
+        memcpy(&f, &u, 4);
+        out[i] = (MYFLT) f * scale;
+      }
+      break;
+    case AE_DOUBLE:
+      for (i = 0; i < n; i++, s += step) {
+        unsigned char b[8];
+        double  d;
+        int     j;
+        if (swap)
+          for (j = 0; j < 8; j++)
+            b[j] = s[7 - j];
+        else
+          memcpy(b, s, 8);
+        memcpy(&d, b, 8);
+        out[i] = (MYFLT) d * scale;
+      }
+      break;
+    }
+    return nFrames;
+#else
+    (void) m; (void) out; (void) frame; (void) nFrames;
+    (void) channel; (void) scale;
+    return 0;
+#endif
+}
+
+/* the private map whose sample data is at 'data', if any */
+
+SNDMAP *csoundSndMapFind(CSOUND *csound, const void *data)
+{
+    SNDMAP  *m;
+
+    csoundSpinLock(&csound->sndmaps_lock);
+    for (m = csound->sndmaps; m != NULL; m = m->nxt)
+      if ((m->flags & SNDMAP_PRIVATE) && (const void*) m->data == data)
+        break;
+    csoundSpinUnLock(&csound->sndmaps_lock);
+    return m;
+}
+
+void csoundSndMapClose(CSOUND *csound, SNDMAP *m)
+{
+    SNDMAP  **pp;
+
+    csoundSpinLock(&csound->sndmaps_lock);
+    for (pp = &csound->sndmaps; *pp != NULL; pp = &(*pp)->nxt)
+      if (*pp == m) {
+        *pp = m->nxt;
+        break;
+      }
+    csoundSpinUnLock(&csound->sndmaps_lock);
+#ifdef HAVE_MMAP
+    munmap(m->base, m->size);
+#endif
+    csound->Free(csound, m);
+}
+
+void rlssndmaps(CSOUND *csound)
+{
+    while (csound->sndmaps != NULL)
+      csoundSndMapClose(csound, csound->sndmaps);
+}
+
+ /* ------------------------------------------------------------------------ */
+
 /**
  * Load an entire sound file into memory.
  * 'fileName' is the file name (searched in the current directory first,
@@ -574,7 +913,8 @@ int PVOCEX_LoadFile(CSOUND *csound, const char *fname, PVOCEX_MEMFILE *p)
  * it is not NULL).
  * Multiple calls of csoundLoadSoundFile() with the same file name will
  * share the same SNDMEMFILE structure, and the file is loaded only once
- * from disk.
+ * from disk.  With --mmap-soundfiles, 32-bit float data in host byte
+ * order is used from a mapping of the file instead of being read.
  * The return value is NULL if an error occurs (the contents of sfinfo may
  * be undefined in this case).
  */
@@ -585,6 +925,7 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
     SNDFILE       *sf;
     void          *fd;
     SNDMEMFILE    *p = NULL;
+    SNDMAP        *m = NULL;
     SF_INFO       tmp;
 
 
@@ -623,9 +964,21 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
                        fileName, Str(sf_strerror(NULL)));
       return NULL;
     }
+    /* float data in host byte order can be used straight from the file */
+    if (csound->oparms->sndMap &&
+        (m = csoundSndMapOpen(csound, csound->GetFileName(fd), sfinfo,
+                              SNDMAP_PRIVATE)) != NULL &&
+        csoundSndMapNative(m, AE_FLOAT) == NULL) {
+      csoundSndMapClose(csound, m);
+      m = NULL;
+    }
     p = (SNDMEMFILE*)
             csound->Malloc(csound, sizeof(SNDMEMFILE)
-                           + (size_t)  sfinfo->frames * sizeof(float));
+                           + (m != NULL ? (size_t) 0 :
+                              ((size_t) sfinfo->frames * sfinfo->channels + 1)
+                              * sizeof(float)));
+    p->data = (m != NULL ? (float*) csoundSndMapNative(m, AE_FLOAT)
+                         : (float*) (p + 1));
     /* set parameters */
     p->name = (char*) csound->Malloc(csound, strlen(fileName) + 1);
     strcpy(p->name, fileName);
@@ -664,7 +1017,9 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
         p->scaleFac = pow(10.0, (double) lpd.gain * 0.05);
       }
     }
-    if (UNLIKELY((size_t) sf_readf_float(sf, &(p->data[0]), (sf_count_t) p->nFrames)
+    if (UNLIKELY(m == NULL &&
+                 (size_t) sf_readf_float(sf, &(p->data[0]),
+                                         (sf_count_t) p->nFrames)
                  != p->nFrames)) {
       csound->FileClose(csound, fd);
       csound->Free(csound, p->name);
@@ -674,13 +1029,14 @@ SNDMEMFILE *csoundLoadSoundFile(CSOUND *csound, const char *fileName, void *sfi)
                                fileName);
       return NULL;
     }
-    p->data[p->nFrames] = 0.0f;
+    p->data[p->nFrames * p->nChannels] = 0.0f;
     csound->FileClose(csound, fd);
     csound->Message(csound, "%s '%s' (sr = %d Hz, %d %s, %" PRId64 " %s) %s",
                     Str("File"), p->fullName, sfinfo->samplerate,
                     sfinfo->channels, Str("channel(s)"), (int64_t)sfinfo->frames,
                     Str("sample frames"),
-                    Str("loaded into memory\n"));
+                    m != NULL ? Str("mapped into memory\n")
+                              : Str("loaded into memory\n"));
 
     /* link into database */
     cs_hash_table_put(csound, csound->sndmemfiles, (char*)fileName, p);
@@ -43,6 +43,8 @@ int     MIDIinsert(CSOUND *, int, MCHNBLK*, MEVENT*);
 //  char *  scsortstr(CSOUND *, CORFIL *);
   void    infoff(CSOUND*, MYFLT), orcompact(CSOUND*);
   void    beatexpire(CSOUND *, double), timexpire(CSOUND *, double);
+  void    reclaim_start(CSOUND *), reclaim_stop(CSOUND *);
+  void    reclaim_collect(CSOUND *, int);
   void    sfopenin(CSOUND *), sfopenout(CSOUND*), sfnopenout(CSOUND*);
   void    iotranset(CSOUND *), sfclosein(CSOUND*), sfcloseout(CSOUND*);
   void    MidiClose(CSOUND *);
@@ -391,12 +393,20 @@ int musmon(CSOUND *csound)
       csound->event_insert_loop = 1;
       csound->alloc_queue = (ALLOC_DATA *)
         csound->Calloc(csound, sizeof(ALLOC_DATA)*MAX_ALLOC_QUEUE);
+      csound->alloc_queue_wakeup = csoundCreateThreadLock();
+      if ((csound->oparms->msglevel & TIMEMSG) && csound->csRtClock != NULL) {
+        csound->alloc_latency = (uint32_t *)
+          csound->Calloc(csound, sizeof(uint32_t)*ALLOC_LATENCY_BINS);
+        csound->alloc_latency_max = 0.0;
+      }
       csound->event_insert_thread =
         csound->CreateThread((uintptr_t (*)(void*)) event_insert_thread,
                              (void*)csound);
       csound->Message(csound, "Starting realtime mode queue: %p thread: %p\n",
                       csound->alloc_queue, csound->event_insert_thread );
     }
+    if (csound->oparms->reclaimThread)
+      reclaim_start(csound);
 #endif
 
     /* since we are running in components, we exit here to playevents later */
@@ -414,12 +424,124 @@ static void deactivate_all_notes(CSOUND *csound)
     }
 }
 
-static void delete_pending_rt_events(CSOUND *csound)
+/* Realtime event queue.  An event due within EVTQ_SLOTS k-cycles of
+   the wheel base is appended to the FIFO of its k-cycle; events that
+   are already late, or further away, go on a heap.  Both keep the
+   order of the old sorted list: by start_kcnt, then by insertion. */
+
+#define EVTQ_MASK (EVTQ_SLOTS - 1)
+
+static inline int evt_before(EVTNODE *a, EVTNODE *b)
+{
+  return (a->start_kcnt < b->start_kcnt ||
+          (a->start_kcnt == b->start_kcnt && (int32) (a->seq - b->seq) < 0));
+}
+
+static void evtq_heap_push(CSOUND *csound, EVTQUEUE *q, EVTNODE *e)
+{
+  int i, j;
+  if (q->heapsize == q->heapmax) {
+    q->heapmax = q->heapmax ? q->heapmax * 2 : 64;
+    q->heap = (EVTNODE **) csound->ReAlloc(csound, q->heap,
+                                           q->heapmax * sizeof(EVTNODE *));
+  }
+  for (i = q->heapsize++; i > 0; i = j) {
+    j = (i - 1) >> 1;
+    if (!evt_before(e, q->heap[j])) break;
+    q->heap[i] = q->heap[j];
+  }
+  q->heap[i] = e;
+}
+
+static void evtq_heap_pop(EVTQUEUE *q)
+{
+  EVTNODE *e = q->heap[--q->heapsize];
+  int i = 0, j, n = q->heapsize;
+  while ((j = 2 * i + 1) < n) {
+    if (j + 1 < n && evt_before(q->heap[j + 1], q->heap[j])) j++;
+    if (!evt_before(q->heap[j], e)) break;
+    q->heap[i] = q->heap[j];
+    i = j;
+  }
+  if (n) q->heap[i] = e;
+}
+
+static int evtq_insert(CSOUND *csound, EVTNODE *e)
+{
+  EVTQUEUE *q = csound->OrcTrigEvts;
+  uint32   k = e->start_kcnt;
+  if (UNLIKELY(q == NULL)) {
+    q = (EVTQUEUE *) csound->Calloc(csound, sizeof(EVTQUEUE));
+    if (UNLIKELY(q == NULL)) return CSOUND_MEMORY;
+    q->base = (uint32) csound->global_kcounter;
+    csound->OrcTrigEvts = q;
+  }
+  e->seq = q->seq++;
+  e->nxt = NULL;
+  if (k - q->base < EVTQ_SLOTS && k >= q->base) {
+    EVTNODE **tl = &q->tail[k & EVTQ_MASK];
+    if (*tl != NULL) (*tl)->nxt = e;
+    else q->head[k & EVTQ_MASK] = e;
+    *tl = e;
+    q->count++;
+  }
+  else
+    evtq_heap_push(csound, q, e);
+  return 0;
+}
+
+/* the next event due at k-cycle kcnt, or NULL */
+static EVTNODE *evtq_due(CSOUND *csound, uint32 kcnt)
 {
-  EVTNODE *ep = csound->OrcTrigEvts;
+  EVTQUEUE *q = csound->OrcTrigEvts;
+  EVTNODE  *w = NULL, *h = NULL;
+  if (q == NULL) return NULL;
+  if (q->count == 0)
+    q->base = kcnt + 1;
+  else {
+    /* skip k-cycles that have been drained */
+    while (q->base <= kcnt && q->head[q->base & EVTQ_MASK] == NULL)
+      q->base++;
+    if (q->base <= kcnt)
+      w = q->head[q->base & EVTQ_MASK];
+  }
+  if (q->heapsize && q->heap[0]->start_kcnt <= kcnt)
+    h = q->heap[0];
+  if (w == NULL) return h;
+  return (h != NULL && evt_before(h, w)) ? h : w;
+}
+
+/* remove e, which was just returned by evtq_due() */
+static void evtq_remove(CSOUND *csound, EVTNODE *e)
+{
+  EVTQUEUE *q = csound->OrcTrigEvts;
+  int      slot = q->base & EVTQ_MASK;
+  if (q->count && q->head[slot] == e) {
+    if ((q->head[slot] = e->nxt) == NULL)
+      q->tail[slot] = NULL;
+    q->count--;
+  }
+  else
+    evtq_heap_pop(q);
+}
 
-  while (ep != NULL) {
-    EVTNODE *nxt = ep->nxt;
+static void delete_pending_rt_events(CSOUND *csound)
+{
+  EVTQUEUE *q = csound->OrcTrigEvts;
+  EVTNODE  *ep;
+  int      i = 0;
+
+  if (q == NULL) return;
+  while (q->count || q->heapsize) {
+    if (q->count) {
+      while ((ep = q->head[i]) == NULL) i++;
+      q->head[i] = ep->nxt;
+      if (ep->nxt == NULL) q->tail[i] = NULL;
+      q->count--;
+    }
+    else {
+      ep = q->heap[--q->heapsize];
+    }
     if (ep->evt.strarg != NULL) {
       csound->Free(csound,ep->evt.strarg);
       ep->evt.strarg = NULL;
@@ -427,9 +549,7 @@ static void delete_pending_rt_events(CSOUND *csound)
     /* push to stack of free event nodes */
     ep->nxt = csound->freeEvtNodes;
     csound->freeEvtNodes = ep;
-    ep = nxt;
   }
-  csound->OrcTrigEvts = NULL;
 }
 
 static inline void cs_beep(CSOUND *csound)
@@ -437,6 +557,11 @@ static inline void cs_beep(CSOUND *csound)
     csound->Message(csound, Str("%c\tbeep!\n"), '\a');
 }
 
+PUBLIC int csoundGetScoreSection(CSOUND *csound)
+{
+    return STA(sectno);
+}
+
 PUBLIC int csoundCleanup(CSOUND *csound)
 {
     void    *p;
@@ -475,12 +600,25 @@ PUBLIC int csoundCleanup(CSOUND *csound)
 
 #ifndef __EMSCRIPTEN__
     if (csound->event_insert_loop == 1) {
+      extern void alloc_latency_report(CSOUND *);
       csound->event_insert_loop = 0;
+      csoundNotifyThreadLock(csound->alloc_queue_wakeup);
       csound->JoinThread(csound->event_insert_thread);
+      reclaim_stop(csound);     /* before its init pass lock goes */
       csoundDestroyMutex(csound->init_pass_threadlock);
+      csoundDestroyThreadLock(csound->alloc_queue_wakeup);
+      csound->alloc_queue_wakeup = NULL;
       csound->event_insert_thread = 0;
+      alloc_latency_report(csound);
+      csound->Free(csound, csound->alloc_latency);
+      csound->alloc_latency = NULL;
     }
 #endif
+    reclaim_stop(csound);
+    if (csound->oparms->msglevel & TIMEMSG) {
+      extern void mem_contention_report(CSOUND *);
+      mem_contention_report(csound);
+    }
 
     while (csound->freeEvtNodes != NULL) {
       p = (void*) csound->freeEvtNodes;
@@ -717,11 +855,8 @@ static int process_score_event(CSOUND *csound, EVTBLK *evt, int rtEvt)
     /* fall through */
   case 'l':
   case 's':
-    while (csound->frstoff != NULL) {
-      INSDS *nxt = csound->frstoff->nxtoff;
+    while (csound->frstoff != NULL)   /* removes it from the turnoff heap */
       xturnoff_now(csound, csound->frstoff);
-      csound->frstoff = nxt;
-    }
     csound->currevent = saved_currevent;
     return (evt->opcod == 'l' ? 3 : (evt->opcod == 's' ? 1 : 2));
   case 'q':
@@ -891,8 +1026,7 @@ static int process_rt_event(CSOUND *csound, int sensType)
       print_amp_values(csound, 0);
   }
   if (sensType == 4) {                  /* RM: Realtime orc event   */
-    EVTNODE *e = csound->OrcTrigEvts;
-    /* RM: Events are sorted on insertion, so just check the first */
+    EVTNODE *e = evtq_due(csound, (uint32) csound->global_kcounter);
     evt = &(e->evt);
     insno = MYFLT2LONG(evt->p[1]);
     if ((rfd = getRemoteInsRfd(csound, insno))) {
@@ -902,8 +1036,8 @@ static int process_rt_event(CSOUND *csound, int sensType)
         insSendevt(csound, evt, rfd);  /* RM: or send to single remote Csound */
       return 0;
     }
-    /* pop from the list */
-    csound->OrcTrigEvts = e->nxt;
+    /* pop from the queue */
+    evtq_remove(csound, e);
     retval = process_score_event(csound, evt, 1);
     if (evt->strarg != NULL) {
       csound->Free(csound, evt->strarg);
@@ -971,6 +1105,9 @@ int sensevents(CSOUND *csound)
         timexpire(csound, tval);
     }
   }
+  /* and return instances whose deinit has run to the free lists */
+  if (csound->reclaim_done != NULL)
+    reclaim_collect(csound, O->reclaimBudget);
   RT_SPIN_UNLOCK
 
   e = &(csound->evt);
@@ -1036,6 +1173,19 @@ int sensevents(CSOUND *csound)
         }
       csound->currevent = e;
 
+      if (UNLIKELY(STA(sectno) < O->renderSection) && e->opcod != 'w' &&
+          e->opcod != 'e') {
+        /* --render-section: run the f and q statements of the sections
+           before it straight away and drop their notes */
+        if (e->opcod == 'f' || e->opcod == 'q')
+          process_score_event(csound, e, 0);
+        else if (e->opcod == 's') {
+          if (++STA(sectno) == O->renderSection)
+            csound->Message(csound, Str("SECTION %d:\n"), STA(sectno));
+        }
+        e->opcod = '\0';
+        continue;
+      }
       switch (e->opcod) {
       case 'w':
         if (!O->Beatmode)                   /* Not beatmode: read 'w' */
@@ -1110,9 +1260,7 @@ int sensevents(CSOUND *csound)
     }
 
     /* check for pending real time events */
-    while (csound->OrcTrigEvts != NULL &&
-           csound->OrcTrigEvts->start_kcnt <=
-           (uint32) csound->global_kcounter) {
+    while (evtq_due(csound, (uint32) csound->global_kcounter) != NULL) {
 
       if ((retval = process_rt_event(csound, 4)) != 0){
         goto scode;
@@ -1173,6 +1321,8 @@ int sensevents(CSOUND *csound)
  scode:
   /* end of section (retval == 1), score (retval == 2), */
   /* or lplay list (retval == 3) */
+  if (retval == 1 && O->renderSection)      /* the one section wanted */
+    retval = 2;
   if (getRemoteInsRfdCount(csound))
     insGlobevt(csound, e);/* RM: send s,e, or l to any remotes */
   e->opcod = '\0';
@@ -1238,7 +1388,7 @@ static inline uint64_t time2kcnt(CSOUND *csound, double tval)
 int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
 {
   double        start_time;
-  EVTNODE       *e, *prv;
+  EVTNODE       *e;
   CSOUND        *st = csound;
   MYFLT         *p;
   uint32        start_kcnt;
@@ -1371,17 +1521,9 @@ int insert_score_event_at_sample(CSOUND *csound, EVTBLK *evt, int64_t time_ofs)
   }
   /* queue new event */
   e->start_kcnt = start_kcnt;
-  prv = csound->OrcTrigEvts;
-  /* if list is empty, or at beginning of list: */
-  if (prv == NULL || start_kcnt < prv->start_kcnt) {
-    e->nxt = prv;
-    csound->OrcTrigEvts = e;
-  }
-  else {                                      /* otherwise sort by time */
-    while (prv->nxt != NULL && start_kcnt >= prv->nxt->start_kcnt)
-      prv = prv->nxt;
-    e->nxt = prv->nxt;
-    prv->nxt = e;
+  if (UNLIKELY(evtq_insert(csound, e) != 0)) {
+    retval = CSOUND_MEMORY;
+    goto err_return;
   }
   /* Make sure sensevents() looks for RT events */
   csound->oparms->RTevents = 1;
@@ -38,6 +38,9 @@
 #ifdef LINUX
 extern int set_rt_priority(int argc, const char **argv);
 #endif
+extern void sections_usage(CSOUND *csound);
+extern int render_sections(int argc, const char **argv, int nthreads,
+                           int check);
 
 static FILE *logFile = NULL;
 
@@ -259,7 +262,8 @@ int main(int argc, char **argv)
 {
     CSOUND  *csound;
     char    *fname = NULL;
-    int     i, result, nomessages=0;
+    int     i, j, result, nomessages=0;
+    int     sections = 0, check = 0, help = 0;
 #ifdef GNU_GETTEXT
     const char* lang;
 #endif
@@ -310,18 +314,40 @@ int main(int argc, char **argv)
         return -1;
       }
     }
+    /* batch rendering by sections, options of this program alone */
+    for (i = j = 1; i < argc; i++) {
+      if (strncmp(argv[i], "--parallel-sections=", 20) == 0)
+        sections = atoi(argv[i] + 20);
+      else if (strcmp(argv[i], "--check-sections") == 0)
+        check = 1;
+      else {
+        if (strcmp(argv[i], "--help") == 0)
+          help = 1;
+        argv[j++] = argv[i];
+      }
+    }
+    argc = j;
     /* if logging to file, set message callback */
     if (logFile != NULL)
       csoundSetDefaultMessageCallback(msg_callback);
     else if (nomessages)
       csoundSetDefaultMessageCallback(nomsg_callback);
 
+    if (sections > 0) {
+      result = render_sections(argc, (const char **)argv, sections, check);
+      if (logFile != NULL)
+        fclose(logFile);
+      return (result >= 0 ? 0 : result);
+    }
+
     /*  Create Csound. */
     csound = csoundCreate(NULL);
     _csound = csound;
 
     /*  One complete performance cycle. */
     result = csoundCompile(csound, argc, (const char **)argv);
+    if (help)
+      sections_usage(csound);
 
      if(!result) csoundPerform(csound);
 
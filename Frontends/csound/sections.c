@@ -0,0 +1,360 @@
+/*
+    sections.c:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Batch rendering of score sections in parallel (--parallel-sections=N).
+   Every section is performed by an instance of its own with
+   --render-section, so sections are only independent if no note
+   outlasts its section and the orchestra keeps no state from one
+   section to the next: global variables written during performance,
+   tables made or changed by opcodes, and so on.  An orchestra whose
+   instruments write such state (see csoundOrchestraSharesState) is
+   rendered in order by one instance instead.  Section 1 is played
+   by the instance that writes the output; the others run on N - 1
+   threads, each into a temporary file of raw samples, and are then
+   passed to the output in order.  --check-sections renders the score
+   again in the ordinary way and compares checksums of the samples. */
+
+#include "csound.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <limits.h>
+#include <stdint.h>
+
+typedef struct {
+    FILE    *tmp;                   /* raw spout samples */
+    int     done;                   /* 1 rendered, -1 failed */
+} SECTION;
+
+typedef struct {
+    int     argc;
+    const char **argv;
+    void    *lock;                  /* guards everything below */
+    void    *cond;                  /* signalled as sections end */
+    SECTION *sect;                  /* indexed by section number */
+    int     nsect;
+    int     next;                   /* next section to take */
+    int     last;                   /* last section of the score */
+} BATCH;
+
+static void quiet_callback(CSOUND *csound,
+                           int attr, const char *format, va_list args)
+{
+    (void) csound;
+    if ((attr & CSOUNDMSG_TYPE_MASK) == CSOUNDMSG_ERROR)
+      vfprintf(stderr, format, args);
+}
+
+/* compile the command line with extra options added at the end, where
+   they override the orchestra's and the user's own */
+static CSOUND *section_instance(BATCH *b, int quiet,
+                                const char *opt1, const char *opt2)
+{
+    CSOUND      *csound = csoundCreate(NULL);
+    const char  **argv;
+    int         argc = b->argc;
+
+    if (csound == NULL)
+      return NULL;
+    if (quiet)
+      csoundSetMessageCallback(csound, quiet_callback);
+    argv = (const char **) malloc((argc + 2) * sizeof(char *));
+    memcpy(argv, b->argv, argc * sizeof(char *));
+    if (opt1 != NULL) argv[argc++] = opt1;
+    if (opt2 != NULL) argv[argc++] = opt2;
+    if (csoundCompile(csound, argc, argv) != 0) {
+      csoundDestroy(csound);
+      csound = NULL;
+    }
+    free(argv);
+    return csound;
+}
+
+/* perform to the end, appending each k-cycle of spout to tmp if given */
+static int perform_into(CSOUND *csound, FILE *tmp)
+{
+    size_t  nspout = csoundGetKsmps(csound) * csoundGetNchnls(csound);
+
+    while (csoundPerformKsmps(csound) == 0)
+      if (tmp != NULL &&
+          fwrite(csoundGetSpout(csound), sizeof(MYFLT), nspout, tmp) != nspout)
+        return -1;
+    return 0;
+}
+
+static SECTION *section_slot(BATCH *b, int k)
+{
+    if (k >= b->nsect) {
+      int n = b->nsect ? b->nsect : 16;
+      while (n <= k) n *= 2;
+      b->sect = (SECTION *) realloc(b->sect, n * sizeof(SECTION));
+      memset(b->sect + b->nsect, 0, (n - b->nsect) * sizeof(SECTION));
+      b->nsect = n;
+    }
+    return &b->sect[k];
+}
+
+static uintptr_t section_thread(void *p)
+{
+    BATCH   *b = (BATCH *) p;
+
+    while (1) {
+      CSOUND  *csound;
+      FILE    *tmp;
+      char    opt[32];
+      int     k, last, ok = 0, present = 1;
+
+      csoundLockMutex(b->lock);
+      k = b->next++;
+      last = b->last;
+      csoundUnlockMutex(b->lock);
+      if (k > last)                 /* past the end: nothing left */
+        return 0;
+      snprintf(opt, sizeof(opt), "--render-section=%d", k);
+      tmp = tmpfile();
+      if (tmp != NULL &&
+          (csound = section_instance(b, 1, "-n", opt)) != NULL) {
+        ok = (perform_into(csound, tmp) == 0);
+        present = (csoundGetScoreSection(csound) >= k);
+        csoundDestroy(csound);
+      }
+      csoundLockMutex(b->lock);
+      if (!present) {
+        if (k - 1 < b->last)
+          b->last = k - 1;
+        fclose(tmp);
+        csoundCondSignal(b->cond);
+      }
+      else {
+        SECTION *s = section_slot(b, k);
+        if (ok)
+          rewind(tmp);
+        else if (tmp != NULL) {
+          fclose(tmp);
+          tmp = NULL;
+        }
+        s->tmp = tmp;
+        s->done = ok ? 1 : -1;
+        csoundCondSignal(b->cond);
+      }
+      csoundUnlockMutex(b->lock);
+    }
+}
+
+/* wait for section k; returns its samples, or NULL if the score ended
+   before it, or if it failed (*failed is then set) */
+static FILE *section_wait(BATCH *b, int k, int *failed)
+{
+    FILE    *tmp = NULL;
+
+    csoundLockMutex(b->lock);
+    while (k <= b->last && (k >= b->nsect || !b->sect[k].done))
+      csoundCondWait(b->cond, b->lock);
+    if (k <= b->last) {
+      *failed = (b->sect[k].done < 0);
+      tmp = b->sect[k].tmp;
+    }
+    csoundUnlockMutex(b->lock);
+    return tmp;
+}
+
+/* FNV-1a over the bytes of n samples */
+static uint64_t checksum(uint64_t h, const MYFLT *smps, size_t n)
+{
+    const unsigned char *c = (const unsigned char *) smps;
+    size_t  i;
+    for (i = 0; i < n * sizeof(MYFLT); i++)
+      h = (h ^ c[i]) * 0x100000001b3ULL;
+    return h;
+}
+
+/* render the score again in one instance and compare it, k-cycle by
+   k-cycle, with the sections as written */
+static int check_sections(BATCH *b, FILE *first, int nsect)
+{
+    CSOUND  *csound = section_instance(b, 1, "-n", NULL);
+    MYFLT   *smps;
+    size_t  nspout, frames = 0, got = 0;
+    uint64_t hseq = 0xcbf29ce484222325ULL, hsec = hseq;
+    long    differ = -1;
+    int     k = 1;
+    FILE    *tmp = first;
+
+    if (csound == NULL)
+      return -1;
+    nspout = csoundGetKsmps(csound) * csoundGetNchnls(csound);
+    smps = (MYFLT *) malloc(nspout * sizeof(MYFLT));
+    while (csoundPerformKsmps(csound) == 0) {
+      const MYFLT *spout = csoundGetSpout(csound);
+      hseq = checksum(hseq, spout, nspout);
+      while (tmp != NULL &&
+             (got = fread(smps, sizeof(MYFLT), nspout, tmp)) == 0) {
+        tmp = (++k <= nsect ? b->sect[k].tmp : NULL);
+      }
+      if (tmp != NULL && got == nspout) {
+        hsec = checksum(hsec, smps, nspout);
+        if (differ < 0 && memcmp(smps, spout, nspout * sizeof(MYFLT)))
+          differ = (long) frames;
+      }
+      else if (differ < 0)
+        differ = (long) frames;     /* sections ended early */
+      frames += csoundGetKsmps(csound);
+    }
+    while (tmp != NULL) {           /* sections ran on longer */
+      while ((got = fread(smps, sizeof(MYFLT), nspout, tmp)) > 0) {
+        hsec = checksum(hsec, smps, got);
+        if (differ < 0)
+          differ = (long) frames;
+      }
+      tmp = (++k <= nsect ? b->sect[k].tmp : NULL);
+    }
+    csoundDestroy(csound);
+    free(smps);
+    fprintf(stderr, "sample checksums: sequential %016llx, "
+            "sections %016llx\n",
+            (unsigned long long) hseq, (unsigned long long) hsec);
+    if (differ >= 0) {
+      fprintf(stderr, "--check-sections: the sections differ from the "
+              "sequential render from frame %ld on\n", differ);
+      return -1;
+    }
+    fprintf(stderr, "--check-sections: sections match the sequential "
+            "render\n");
+    return 0;
+}
+
+/* the options above, for --help: the library does not know them */
+void sections_usage(CSOUND *csound)
+{
+    csoundMessage(csound,
+                  "\nOptions of the csound command:\n\n"
+                  "--parallel-sections=N   render the score sections on N "
+                  "threads and join\n"
+                  "                          them; for sections that share "
+                  "no state\n"
+                  "--check-sections        with --parallel-sections, compare "
+                  "with an\n"
+                  "                          ordinary render\n");
+}
+
+/* returns 1 if the score was rendered in order, as the orchestra
+   shares state between sections, 0 if in sections, -1 on failure */
+int render_sections(int argc, const char **argv, int nthreads, int check)
+{
+    BATCH   b;
+    CSOUND  *csound;
+    void    **threads;
+    FILE    *first = NULL;
+    MYFLT   *spout;
+    size_t  nspout;
+    int     i, k, nsect, started, result = 0;
+
+    memset(&b, 0, sizeof(BATCH));
+    b.argc = argc;
+    b.argv = argv;
+
+    /* section 1 in the instance that writes the output */
+    csound = section_instance(&b, 0, "--render-section=1", NULL);
+    if (csound != NULL && csoundOrchestraSharesState(csound)) {
+      fprintf(stderr, "--parallel-sections: the instruments keep state "
+              "from one section to the next, rendering the score in "
+              "order\n");
+      csoundDestroy(csound);
+      if ((csound = section_instance(&b, 0, NULL, NULL)) == NULL)
+        return -1;
+      result = perform_into(csound, NULL);
+      csoundDestroy(csound);
+      return (result == 0 ? 1 : -1);
+    }
+
+    b.lock = csoundCreateMutex(0);
+    b.cond = csoundCreateCondVar();
+    b.next = 2;
+    b.last = INT_MAX;
+    if (nthreads < 2)
+      nthreads = 2;
+    threads = (void **) calloc(nthreads - 1, sizeof(void *));
+    for (i = started = 0; i < nthreads - 1; i++)
+      if ((threads[i] = csoundCreateThread(section_thread, &b)) != NULL)
+        started++;
+    if (csound == NULL)
+      result = -1;
+    else {
+      if (check && (first = tmpfile()) == NULL)
+        check = 0;
+      if (perform_into(csound, first) != 0)
+        result = -1;
+      if (first != NULL)
+        rewind(first);
+    }
+    if (started == 0)               /* no threads: render them here */
+      section_thread(&b);
+
+    /* then the others in order, as they are done */
+    spout = csound != NULL ? csoundGetSpout(csound) : NULL;
+    nspout = csound != NULL ?
+      csoundGetKsmps(csound) * csoundGetNchnls(csound) : 0;
+    for (k = 2; result == 0; k++) {
+      int failed = 0;
+      FILE *tmp = section_wait(&b, k, &failed);
+      if (failed) {
+        fprintf(stderr, "--parallel-sections: section %d failed\n", k);
+        result = -1;
+      }
+      if (tmp == NULL)
+        break;
+      while (fread(spout, sizeof(MYFLT), nspout, tmp) == nspout)
+        csoundWriteSpout(csound);
+      if (check)                    /* kept to compare */
+        rewind(tmp);
+      else {
+        fclose(tmp);
+        csoundLockMutex(b.lock);    /* b.sect may be moving */
+        b.sect[k].tmp = NULL;
+        csoundUnlockMutex(b.lock);
+      }
+    }
+    if (result != 0) {              /* stop the threads early */
+      csoundLockMutex(b.lock);
+      b.last = 0;
+      csoundUnlockMutex(b.lock);
+    }
+    for (i = 0; i < nthreads - 1; i++)
+      if (threads[i] != NULL)
+        csoundJoinThread(threads[i]);
+    nsect = b.last < b.nsect ? b.last : b.nsect - 1;
+    if (csound != NULL)
+      csoundDestroy(csound);        /* closes the output */
+    if (result == 0 && check)
+      result = check_sections(&b, first, nsect);
+
+    if (first != NULL)
+      fclose(first);
+    for (k = 0; k < b.nsect; k++)
+      if (b.sect[k].tmp != NULL)
+        fclose(b.sect[k].tmp);
+    free(b.sect);
+    free(threads);
+    csoundDestroyCondVar(b.cond);
+    csoundDestroyMutex(b.lock);
+    return result;
+}
@@ -83,6 +83,27 @@ typedef struct {
     MYFLT   *r, *a, *b;
 } AOP;
 
+/* A chain of a-rate + - * / compiled by the orchestra optimiser into one
+   opcode.  prog is the chain in reverse Polish notation, operand n
+   written as the letter 'a'+n; it is turned into FUSEDOPs at init. */
+#define FUSED_ARGS  (24)
+#define FUSED_CHUNK (64)
+
+typedef struct {
+    char    op;                 /* '+', '-', '*' or '/' */
+    char    x, y;               /* operand kinds, see aops.c */
+    uint8_t xi, yi;             /* argument or register numbers */
+} FUSEDOP;
+
+typedef struct {
+    OPDS    h;
+    MYFLT   *r;
+    STRINGDAT *prog;
+    MYFLT   *args[FUSED_ARGS];
+    int32_t ncode;
+    FUSEDOP code[FUSED_ARGS];
+} FUSED;
+
 typedef struct {
     OPDS    h;
     MYFLT   *r, *a, *b, *def;
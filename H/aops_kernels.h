@@ -0,0 +1,78 @@
+/*
+    aops_kernels.h:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+#ifndef CSOUND_AOPS_KERNELS_H
+#define CSOUND_AOPS_KERNELS_H
+
+#include "sysdep.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  /* indices into the kernel arrays */
+  enum { AOPK_ADD, AOPK_SUB, AOPK_MUL, AOPK_DIV, AOPK_NUM };
+
+  /* the peak kernel's lane count must be a multiple of this */
+#define AOPK_LANES 8
+
+  /**
+   * Inner loops of the a-rate arithmetic opcodes, r[i] = a op b over n
+   * samples.  vv takes two signals, vs a signal and a scalar, sv a scalar
+   * and a signal.  r may be the same buffer as a signal argument but the
+   * buffers need not be aligned.  Every implementation rounds exactly as
+   * the plain C loop does, so results do not depend on the one chosen.
+   *
+   * peak is the output peak meter.  x is read as n / lanes rows of lanes
+   * samples (n a multiple of lanes, lanes of AOPK_LANES); for each column
+   * j, amax[j] becomes the largest |x| seen, ignoring NaNs, and over[j]
+   * grows by the count of |x| greater than lim.
+   */
+  typedef struct {
+    const char *name;
+    void (*vv[AOPK_NUM])(MYFLT *r, const MYFLT *a, const MYFLT *b,
+                         uint32_t n);
+    void (*vs[AOPK_NUM])(MYFLT *r, const MYFLT *a, MYFLT b, uint32_t n);
+    void (*sv[AOPK_NUM])(MYFLT *r, MYFLT a, const MYFLT *b, uint32_t n);
+    void (*peak)(MYFLT *amax, MYFLT *over, const MYFLT *x, uint32_t n,
+                 uint32_t lanes, MYFLT lim);
+  } AOP_KERNELS;
+
+  /* the set in use; plain C until csound_aops_select_kernels() runs */
+  extern const AOP_KERNELS *csound_aop_kernels;
+
+  /**
+   * Returns the n-th kernel set that this build contains and this CPU
+   * can run, starting with plain C at 0, or NULL past the last one.
+   */
+  const AOP_KERNELS *csound_aops_kernel_set(int n);
+
+  /**
+   * Points csound_aop_kernels at the widest set the CPU supports.
+   * Called once from csoundInitialize().
+   */
+  void csound_aops_select_kernels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* CSOUND_AOPS_KERNELS_H */
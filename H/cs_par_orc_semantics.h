@@ -61,7 +61,8 @@ void csp_orc_sa_instr_add(CSOUND *csound, char *name);
 void csp_orc_sa_instr_add_tree(CSOUND *csound, TREE *x);
 /* finish the current instrument */
 #define csp_orc_sa_instr_finalize(csound) \
-  { csound->instCurr = NULL; csound->inInstr = 0; }
+  { csound->instCurr = NULL; csound->inInstr = 0; \
+    csound->dag_conflicts_stale = 1; }
 
 /* add the globals read and written to the current instrument; second case
  * if write and read contain the same global and size of both is 1 then
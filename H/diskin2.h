@@ -70,8 +70,9 @@ typedef struct {
     AUXCH   auxData2;
     MYFLT   *aOut_buf;
     MYFLT   aOut_bufsize;
-    void    *cb;
+    void    *stream;            /* DISKIN_STREAM if read asynchronously */
     int     async;
+    void    *sndmap;            /* SNDMAP if the file is memory-mapped */
 } DISKIN2;
 
 typedef struct {
@@ -112,8 +113,9 @@ typedef struct {
     AUXCH   auxData2;
   MYFLT *aOut_buf;
   MYFLT aOut_bufsize;
-  void *cb;
+  void *stream;                 /* DISKIN_STREAM if read asynchronously */
   int  async;
+  void *sndmap;                 /* SNDMAP if the file is memory-mapped */
 } DISKIN2_ARRAY;
 
 int diskin2_init(CSOUND *csound, DISKIN2 *p);
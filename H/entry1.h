@@ -86,6 +86,7 @@ int32_t modak(CSOUND *, void *);
 int32_t addaa(CSOUND *, void *), subaa(CSOUND *, void *);
 int32_t mulaa(CSOUND *, void *), divaa(CSOUND *, void *);
 int32_t modaa(CSOUND *, void *);
+int32_t fusedset(CSOUND *, void *), fused(CSOUND *, void *);
 int32_t addin(CSOUND *, void *), addina(CSOUND *, void *);
 int32_t subin(CSOUND *, void *), subina(CSOUND *, void *);
 int32_t addinak(CSOUND *, void *), subinak(CSOUND *, void *);
@@ -152,6 +153,8 @@ int32_t kline(CSOUND *, void *), aline(CSOUND *, void *);
 int32_t expset(CSOUND *, void *), kexpon(CSOUND *, void *);
 int32_t expon(CSOUND *, void *), lsgset(CSOUND *, void *);
 int32_t klnseg(CSOUND *, void *), linseg(CSOUND *, void *);
+int32_t klnseg_multi(CSOUND *, void **, int32_t);
+int32_t linseg_multi(CSOUND *, void **, int32_t);
 int32_t csgset(CSOUND *, void *), kosseg(CSOUND *, void *);
 int32_t csgset_bkpt(CSOUND *, void *), cosseg(CSOUND *, void *);
 int32_t csgrset(CSOUND *, void *);
@@ -180,6 +183,7 @@ int32_t oscsetA(CSOUND *, void *);
 int32_t osckk(CSOUND *, void *), oscka(CSOUND *, void *);
 int32_t oscak(CSOUND *, void *), oscaa(CSOUND *, void *);
 int32_t koscli(CSOUND *, void *), osckki(CSOUND *, void *);
+int32_t osckki_multi(CSOUND *, void **, int32_t);
 int32_t osckai(CSOUND *, void *), oscaki(CSOUND *, void *);
 int32_t oscaai(CSOUND *, void *), foscset(CSOUND *, void *);
 int32_t foscil(CSOUND *, void *), foscili(CSOUND *, void *);
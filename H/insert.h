@@ -72,10 +72,21 @@ typedef struct {                        /* IV - Oct 16 2002 */
     OPCOD_IOBUFS    buf;
 } SUBINST;
 
+/* An argument that useropcd1() copies in or out on every local k-cycle,
+   classified once at init */
+enum { UDO_XFER_VALUE, UDO_XFER_K, UDO_XFER_A, UDO_XFER_AARRAY };
+typedef struct {
+    int           kind;
+    CS_TYPE       *type;
+    void          *ext, *lcl;           /* caller's and UDO's variable */
+} UDO_XFER;
+
 typedef struct {                /* IV - Sep 8 2002: new structure: UOPCODE */
     OPDS          h;
     INSDS         *ip, *parent_ip;
     OPCOD_IOBUFS  *buf;
+    AUXCH         xfer;                 /* UDO_XFER[nxin + nxout] */
+    int           nxin, nxout;
     /*unsigned int  l_ksmps;
     int           ksmps_scale;
     MYFLT         l_ekr, l_onedkr, l_onedksmps, l_kicvt;
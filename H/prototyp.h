@@ -38,6 +38,7 @@ void    *mmallocDebug(CSOUND *, size_t, char*, int);
 void    *mcallocDebug(CSOUND *, size_t, char*, int);
 void    *mreallocDebug(CSOUND *, void *, size_t, char*, int);
 void    mfreeDebug(CSOUND *, void *, char*, int);
+void    mem_arena_exit(CSOUND *);
 char    *cs_strdup(CSOUND*, char*);
 char    *cs_strndup(CSOUND*, char*, size_t);
 void    csoundAuxAlloc(CSOUND *, size_t, AUXCH *), auxchfree(CSOUND *, INSDS *);
@@ -86,6 +87,16 @@ void    add_tmpfile(CSOUND *, char *);
 void    xturnoff(CSOUND *, INSDS *);
 void    xturnoff_now(CSOUND *, INSDS *);
 int     insert_score_event(CSOUND *, EVTBLK *, double);
+/* The part of a k-cycle that an instance with a local ksmps runs: count
+   sub-blocks from number first on, with the sample-accurate offset left
+   in the first and the early end in the last. */
+typedef struct {
+    int     first, count;
+    int     offset, early;
+} LKSMPS_SCHED;
+void    local_ksmps_schedule(LKSMPS_SCHED *, int ksmps, int lksmps,
+                             int offset, int early);
+void    local_ksmps_spout(CSOUND *, LKSMPS_SCHED *);
 //MEMFIL  *ldmemfile(CSOUND *, const char *);
 //MEMFIL  *ldmemfile2(CSOUND *, const char *, int);
 MEMFIL  *ldmemfile2withCB(CSOUND *csound, const char *filnam, int csFileType,
@@ -99,6 +110,28 @@ void    *sndgetset(CSOUND *, void *);
 void    dbfs_init(CSOUND *, MYFLT dbfs);
 int     csoundLoadExternals(CSOUND *);
 SNDMEMFILE  *csoundLoadSoundFile(CSOUND *, const char *name, void *sfinfo);
+/* The sample data of an uncompressed soundfile, mapped into memory. */
+typedef struct SNDMAP_ {
+    char    *base;              /* the mapping */
+    size_t  size;
+    const char *data;           /* first sample frame */
+    int64_t nFrames;
+    int     nChannels;
+    int     sampleFormat;       /* AE_SHORT, AE_FLOAT, etc. */
+    int     sampleSize;         /* in bytes */
+    int     bigEndian;
+    int     flags;
+    struct SNDMAP_ *nxt;
+} SNDMAP;
+#define SNDMAP_PRIVATE  1       /* writable, copy on write, room after data */
+SNDMAP  *csoundSndMapOpen(CSOUND *, const char *fullName, const void *sfinfo,
+                          int flags);
+void    *csoundSndMapNative(const SNDMAP *, int sampleFormat);
+int64_t csoundSndMapRead(const SNDMAP *, MYFLT *, int64_t frame,
+                         int64_t nFrames, int channel, MYFLT scale);
+SNDMAP  *csoundSndMapFind(CSOUND *, const void *data);
+void    csoundSndMapClose(CSOUND *, SNDMAP *);
+void    rlssndmaps(CSOUND *);
 int     PVOCEX_LoadFile(CSOUND *, const char *fname, PVOCEX_MEMFILE *p);
 void    print_opcodedir_warning(CSOUND *);
 int     check_rtaudio_name(char *fName, char **devName, int isOutput);
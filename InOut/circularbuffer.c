@@ -62,27 +62,33 @@ static int checkspace(circular_buffer *p, int writeCheck){
     }
 }
 
+/* copy items elements out of the buffer from rp, wrapping at most once;
+   returns the new read position */
+static int copy_out(circular_buffer *p, void *out, int rp, int items)
+{
+    int elemsize = p->elemsize, n = p->numelem - rp;
+    if (n > items) n = items;
+    memcpy(out, &(p->buffer[elemsize * rp]), (size_t) n * elemsize);
+    if (n < items)
+      memcpy((char *) out + (size_t) n * elemsize, p->buffer,
+             (size_t) (items - n) * elemsize);
+    rp += items;
+    return rp >= p->numelem ? rp - p->numelem : rp;
+}
+
 int csoundReadCircularBuffer(CSOUND *csound, void *p, void *out, int items)
 {
     IGN(csound);
     if (p == NULL) return 0;
     {
       int remaining;
-      int itemsread, numelem = ((circular_buffer *)p)->numelem;
-      int elemsize = ((circular_buffer *)p)->elemsize;
-      int i=0, rp = ((circular_buffer *)p)->rp;
-      char *buffer = ((circular_buffer *)p)->buffer;
+      int itemsread, rp;
       if ((remaining = checkspace(p, 0)) == 0) {
         return 0;
       }
       itemsread = items > remaining ? remaining : items;
-      for (i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-          rp = 0;
-        }
-      }
+      rp = copy_out((circular_buffer *) p, out,
+                    ((circular_buffer *)p)->rp, itemsread);
 #if defined(MSVC)
       InterlockedExchange(&((circular_buffer *)p)->rp, rp);
 #elif defined(HAVE_ATOMIC_BUILTIN)
@@ -99,21 +105,12 @@ int csoundPeekCircularBuffer(CSOUND *csound, void *p, void *out, int items)
     IGN(csound);
     if (p == NULL) return 0;
     int remaining;
-    int itemsread, numelem = ((circular_buffer *)p)->numelem;
-    int elemsize = ((circular_buffer *)p)->elemsize;
-    int i=0, rp = ((circular_buffer *)p)->rp;
-    char *buffer = ((circular_buffer *)p)->buffer;
+    int itemsread;
     if ((remaining = checkspace(p, 0)) == 0) {
         return 0;
     }
     itemsread = items > remaining ? remaining : items;
-    for(i=0; i < itemsread; i++){
-        memcpy((char *) out + (i * elemsize),
-               &(buffer[elemsize * rp++]),  elemsize);
-        if (rp == numelem) {
-            rp = 0;
-        }
-    }
+    copy_out((circular_buffer *) p, out, ((circular_buffer *)p)->rp, itemsread);
     return itemsread;
 }
 
@@ -148,19 +145,22 @@ int csoundWriteCircularBuffer(CSOUND *csound, void *p, const void *in, int items
     IGN(csound);
     if (p == NULL) return 0;
     int remaining;
-    int itemswrite, numelem = ((circular_buffer *)p)->numelem;
+    int itemswrite, n, numelem = ((circular_buffer *)p)->numelem;
     int elemsize = ((circular_buffer *)p)->elemsize;
-    int i=0, wp = ((circular_buffer *)p)->wp;
+    int wp = ((circular_buffer *)p)->wp;
     char *buffer = ((circular_buffer *)p)->buffer;
     if ((remaining = checkspace(p, 1)) == 0) {
         return 0;
     }
     itemswrite = items > remaining ? remaining : items;
-    for(i=0; i < itemswrite; i++){
-        memcpy(&(buffer[elemsize * wp++]),
-                ((char *) in) + (i * elemsize),  elemsize);
-        if(wp == numelem) wp = 0;
-    }
+    /* at most two spans: up to the end of the buffer, then from its start */
+    n = numelem - wp < itemswrite ? numelem - wp : itemswrite;
+    memcpy(&(buffer[elemsize * wp]), in, (size_t) n * elemsize);
+    if (n < itemswrite)
+      memcpy(buffer, (const char *) in + (size_t) n * elemsize,
+             (size_t) (itemswrite - n) * elemsize);
+    wp += itemswrite;
+    if (wp >= numelem) wp -= numelem;
 #if defined(MSVC)
       InterlockedExchange(&((circular_buffer *)p)->wp, wp);
 #elif defined(HAVE_ATOMIC_BUILTIN)
@@ -23,6 +23,7 @@
 
 #include "csoundCore.h"                 /*             SNDLIB.C         */
 #include "soundio.h"
+#include "aops_kernels.h"
 #include <stdlib.h>
 #include <time.h>
 #include <inttypes.h>
@@ -60,14 +61,74 @@ static inline void alloc_globals(CSOUND *csound)
    audtran to flush when this happens.
 */
 
-static void spoutsf(CSOUND *csound)
+/* Peak and out-of-range accounting for one spout block, which always
+   holds whole frames.  The kernel keeps a maximum and a count for each
+   of peaklanes interleaved samples, peaklanes being the first multiple
+   of nchnls that is a whole number of vectors; they are folded into the
+   channels afterwards.  A new peak is placed at the first frame that
+   reaches it, as the running maximum taken one sample at a time gives. */
+
+static void spout_peaks(CSOUND *csound, const MYFLT *sp, int checkrng)
 {
-    uint32_t   chn = 0;
-    int     n;
-    int spoutrem = csound->nspout;
+    uint32_t nchnls = csound->nchnls, lanes = STA(peaklanes);
+    uint32_t nsmps = csound->nspout, whole, i, c;
+    MYFLT    *amax = STA(peakacc), *over;
+
+    if (UNLIKELY(amax == NULL)) {
+      for (lanes = nchnls; lanes % AOPK_LANES; lanes += nchnls)
+        ;
+      STA(peaklanes) = lanes;
+      amax = STA(peakacc) =
+        (MYFLT*) csound->Malloc(csound, 2 * lanes * sizeof(MYFLT));
+    }
+    over = amax + lanes;
+    memset(amax, 0, 2 * lanes * sizeof(MYFLT));
+    whole = nsmps - nsmps % lanes;
+    csound_aop_kernels->peak(amax, over, sp, whole, lanes,
+                             csound->e0dbfs);
+    for (i = nchnls; i < lanes; i++) {
+      c = i % nchnls;
+      if (amax[i] > amax[c])
+        amax[c] = amax[i];
+      over[c] += over[i];
+    }
+    for (i = whole; i < nsmps; i++) {   /* the frames left over */
+      MYFLT absamp = sp[i];
+      c = i % nchnls;
+      if (absamp < FL(0.0))
+        absamp = -absamp;
+      if (absamp > amax[c])
+        amax[c] = absamp;
+      if (absamp > csound->e0dbfs)
+        over[c] += FL(1.0);
+    }
+    for (c = 0; c < nchnls; c++) {
+      if (amax[c] > csound->maxamp[c]) {  /*  maxamp this seg  */
+        for (i = c; ; i += nchnls) {
+          MYFLT absamp = sp[i];
+          if (absamp < FL(0.0))
+            absamp = -absamp;
+          if (absamp == amax[c])
+            break;
+        }
+        csound->maxamp[c] = amax[c];
+        csound->maxpos[c] = STA(nframes) + i / nchnls;
+      }
+      if (checkrng && over[c] > FL(0.0)) {  /* out of range?     */
+        csound->rngcnt[c] += (int32) over[c]; /*  report it        */
+        csound->rngflg = 1;
+      }
+    }
+    STA(nframes) += nsmps / nchnls;
+}
+
+/* copy a spout block into outbuf, scaled by scal unless it is NULL,
+   flushing the buffer whenever it fills */
+
+static inline void spout_buffer(CSOUND *csound, const MYFLT *scal)
+{
+    int     n, spoutrem = csound->nspout;
     MYFLT   *sp = csound->spout;
-    MYFLT   absamp = FL(0.0);
-    uint32  nframes = csound->libsndStatics.nframes;
  nchk:
     /* if nspout remaining > buf rem, prepare to send in parts */
     if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem) {
@@ -75,31 +136,15 @@ static void spoutsf(CSOUND *csound)
     }
     spoutrem -= n;
     csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen) {
-        *csound->libsndStatics.outbufp++ = (absamp * csound->dbfs_to_float);
-      }
-      if (absamp < FL(0.0)) {
-        absamp = -absamp;
-      }
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (absamp > csound->e0dbfs) {        /* out of range?     */
-        csound->rngcnt[chn]++;              /*  report it        */
-        csound->rngflg = 1;
-      }
-      if (csound->multichan) {
-        if (++chn >= csound->nchnls) {
-            chn = 0;
-            nframes++;
-        }
-      } else {
-        nframes++;
-      }
-    } while (--n);
+    if (csound->libsndStatics.osfopen) {
+      if (scal != NULL)
+        csound_aop_kernels->vs[AOPK_MUL](csound->libsndStatics.outbufp,
+                                         sp, *scal, n);
+      else
+        memcpy(csound->libsndStatics.outbufp, sp, n * sizeof(MYFLT));
+      csound->libsndStatics.outbufp += n;
+    }
+    sp += n;
     if (!csound->libsndStatics.outbufrem) {
       if (csound->libsndStatics.osfopen) {
         csound->nrecs++;
@@ -112,50 +157,159 @@ static void spoutsf(CSOUND *csound)
         goto nchk;
       }
     }
-    csound->libsndStatics.nframes = nframes;
+}
+
+static void spoutsf(CSOUND *csound)
+{
+    spout_peaks(csound, csound->spout, 1);
+    spout_buffer(csound, &csound->dbfs_to_float);
 }
 
 /* special version of spoutsf for "raw" floating point files */
 
 static void spoutsf_noscale(CSOUND *csound)
 {
-    uint32_t chn = 0;
-    int      n, spoutrem = csound->nspout;
-    MYFLT    *sp = csound->spout;
-    MYFLT    absamp = FL(0.0);
-    uint32   nframes = csound->libsndStatics.nframes;
+    spout_peaks(csound, csound->spout, 0);
+    spout_buffer(csound, NULL);
+}
 
- nchk:
-    /* if nspout remaining > buf rem, prepare to send in parts */
-    if ((n = spoutrem) > (int) csound->libsndStatics.outbufrem)
-      n = (int)csound->libsndStatics.outbufrem;
-    spoutrem -= n;
-    csound->libsndStatics.outbufrem -= n;
-    do {
-      absamp = *sp++;
-      if (csound->libsndStatics.osfopen)
-        *csound->libsndStatics.outbufp++ = absamp;
-      if (absamp < FL(0.0))
-        absamp = -absamp;
-      if (absamp > csound->maxamp[chn]) {   /*  maxamp this seg  */
-        csound->maxamp[chn] = absamp;
-        csound->maxpos[chn] = nframes;
-      }
-      if (++chn >= csound->nchnls)
-        chn = 0, nframes++;
-    } while (--n);
+static int sndfile_write(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
+    int     n;
 
-    if (!csound->libsndStatics.outbufrem) {
-      if (csound->libsndStatics.osfopen) {
-        csound->nrecs++;
-        csound->audtran(csound, csound->libsndStatics.outbuf,
-                        csound->libsndStatics.outbufsiz); /* Flush buffer */
-        csound->libsndStatics.outbufp = (MYFLT*) csound->libsndStatics.outbuf;
+    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
+                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
+    if (UNLIKELY(csound->oparms->rewrt_hdr))
+      rewriteheader((void *)STA(outfile));
+    return n;
+}
+
+/* Background writer for soundfile output (--write-buffers=N).  The
+   buffers form a ring of N + 1: spoutsf fills one while up to N full
+   ones wait for the writer thread, so the performance only stops when
+   the file falls N buffers behind.  Errors are passed back and reported
+   from the performance thread at the next buffer or at close. */
+
+typedef struct SNDWRITER_ {
+    CSOUND  *csound;
+    void    *thread;
+    void    *filled, *freed;            /* signalled per buffer */
+    MYFLT   **bufs;
+    int     *nbytes;
+    int     nbufs;
+    int     head, tail;                 /* next to write, next to fill */
+    volatile int32_t queued;
+    volatile int32_t running;
+    volatile int32_t failed;
+    int     written, wanted;            /* the first short write */
+} SNDWRITER;
+
+static uintptr_t sndwriter_thread(void *p)
+{
+    SNDWRITER *w = (SNDWRITER *) p;
+    CSOUND    *csound = w->csound;
+
+    while (1) {
+      int n;
+      if (ATOMIC_GET(w->queued) == 0) {
+        if (!ATOMIC_GET(w->running))    /* drained and stopped */
+          break;
+        csound->WaitThreadLockNoTimeout(w->filled);
+        continue;
       }
-      csound->libsndStatics.outbufrem = csound->oparms_.outbufsamps;
-      if (spoutrem) goto nchk;
+      if (LIKELY(!w->failed)) {         /* after an error just discard */
+        n = sndfile_write(csound, w->bufs[w->head], w->nbytes[w->head]);
+        if (UNLIKELY(n < w->nbytes[w->head])) {
+          w->written = n;
+          w->wanted = w->nbytes[w->head];
+          ATOMIC_SET(w->failed, 1);
+        }
+      }
+      w->head = (w->head + 1) % w->nbufs;
+      ATOMIC_SUB(w->queued, 1);
+      csound->NotifyThreadLock(w->freed);
+    }
+    return 0;
+}
+
+static void sndwriter_start(CSOUND *csound, int depth)
+{
+    SNDWRITER *w;
+    int       i;
+
+    w = (SNDWRITER *) csound->Calloc(csound, sizeof(SNDWRITER));
+    w->csound = csound;
+    w->nbufs = depth + 1;
+    w->bufs = (MYFLT **) csound->Malloc(csound, w->nbufs * sizeof(MYFLT *));
+    w->nbytes = (int *) csound->Calloc(csound, w->nbufs * sizeof(int));
+    w->bufs[0] = STA(outbuf);
+    for (i = 1; i < w->nbufs; i++)
+      w->bufs[i] = (MYFLT *) csound->Malloc(csound, STA(outbufsiz));
+    w->filled = csound->CreateThreadLock();
+    w->freed = csound->CreateThreadLock();
+    w->running = 1;
+    if (w->filled == NULL || w->freed == NULL ||
+        (w->thread = csound->CreateThread(sndwriter_thread, w)) == NULL) {
+      csound->Warning(csound, Str("could not start the soundfile writer "
+                                  "thread, writing in the performance "
+                                  "thread\n"));
+      if (w->filled != NULL) csound->DestroyThreadLock(w->filled);
+      if (w->freed != NULL) csound->DestroyThreadLock(w->freed);
+      for (i = 1; i < w->nbufs; i++)
+        csound->Free(csound, w->bufs[i]);
+      csound->Free(csound, w->bufs);
+      csound->Free(csound, w->nbytes);
+      csound->Free(csound, w);
+      return;
+    }
+    STA(writer) = w;
+}
+
+/* write out what is queued and end the thread; a write error is
+   reported here, after the thread has gone */
+
+static void sndwriter_stop(CSOUND *csound)
+{
+    SNDWRITER *w = (SNDWRITER *) STA(writer);
+    int       i, n, nbytes;
+
+    ATOMIC_SET(w->running, 0);
+    csound->NotifyThreadLock(w->filled);
+    csound->JoinThread(w->thread);
+    csound->DestroyThreadLock(w->filled);
+    csound->DestroyThreadLock(w->freed);
+    STA(writer) = NULL;
+    /* outbuf goes back to being the one in use */
+    for (i = 0; i < w->nbufs; i++)
+      if (w->bufs[i] != STA(outbuf))
+        csound->Free(csound, w->bufs[i]);
+    csound->Free(csound, w->bufs);
+    csound->Free(csound, w->nbytes);
+    n = w->written;
+    nbytes = w->wanted;
+    csound->Free(csound, w);
+    if (UNLIKELY(nbytes))
+      sndwrterr(csound, n, nbytes);
+}
+
+/* queue the full outbuf and move outbuf on to the next free buffer,
+   waiting for the writer if all of them are queued */
+
+static void sndwriter_queue(CSOUND *csound, int nbytes)
+{
+    SNDWRITER *w = (SNDWRITER *) STA(writer);
+
+    if (UNLIKELY(ATOMIC_GET(w->failed))) {
+      sndwriter_stop(csound);           /* reports it and dies */
+      return;
     }
-    csound->libsndStatics.nframes = nframes;
+    w->nbytes[w->tail] = nbytes;
+    w->tail = (w->tail + 1) % w->nbufs;
+    ATOMIC_ADD(w->queued, 1);
+    csound->NotifyThreadLock(w->filled);
+    while (ATOMIC_GET(w->queued) >= w->nbufs)
+      csound->WaitThreadLockNoTimeout(w->freed);
+    STA(outbuf) = w->bufs[w->tail];
 }
 
 /* diskfile write option for audtran's */
@@ -168,12 +322,13 @@ static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader((void *)STA(outfile));
+    if (STA(writer) != NULL)
+      sndwriter_queue(csound, nbytes);
+    else {
+      n = sndfile_write(csound, outbuf, nbytes);
+      if (UNLIKELY(n < nbytes))
+        sndwrterr(csound, n, nbytes);
+    }
     switch (O->heartbeat) {
       case 1:
         csound->MessageS(csound, CSOUNDMSG_REALTIME,
@@ -200,216 +355,77 @@ static void writesf(CSOUND *csound, const MYFLT *outbuf, int nbytes)
     }
 }
 
-static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+/* Add dither of one bit at the given full scale before writing to a
+   16 or 8 bit file; triangular sums two values of the generator, else
+   it is used alone.  The generator is serial, so its values are taken
+   into a block and then scaled and added with the vector kernels,
+   dividing exactly as the one sample at a time loop did. */
+
+#define DITHER_BLK  256
+
+static void add_dither(CSOUND *csound, MYFLT *buf, int m, int triangular,
+                       MYFLT range)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int    dith;
+    MYFLT   d[DITHER_BLK];
+    int     dith = STA(dither);
 
-    if (UNLIKELY(STA(outfile) == NULL))
-      return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   tmp = ((dith * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      dith = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
-    }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
+    while (m > 0) {
+      int   i, n = (m < DITHER_BLK ? m : DITHER_BLK);
+      for (i = 0; i < n; i++) {
+        int   rnd = ((dith * 15625) + 1) & 0xFFFF;
+        if (triangular) {
+          int   tmp = rnd;
+          rnd = ((tmp * 15625) + 1) & 0xFFFF;
+          dith = rnd;
+          rnd = (rnd+tmp)>>1;       /* triangular distribution */
         }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
+        else
+          dith = rnd;
+        d[i] = (MYFLT) (rnd - 0x8000);
+      }
+      csound_aop_kernels->vs[AOPK_DIV](d, d, (MYFLT) 0x10000, n);
+      csound_aop_kernels->vs[AOPK_DIV](d, d, range, n);
+      csound_aop_kernels->vv[AOPK_ADD](buf, buf, d, n);
+      buf += n;
+      m -= n;
     }
+    STA(dither) = dith;
 }
 
-static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+static void writesf_dither_16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
+    if (UNLIKELY(STA(outfile) == NULL))
+      return;
+    add_dither(csound, (MYFLT*) outbuf, nbytes / (int) sizeof(MYFLT),
+               1, (MYFLT) 0x7fff);
+    writesf(csound, outbuf, nbytes);
+}
 
+static void writesf_dither_8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
+{
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   tmp = ((dith * 15625) + 1) & 0xFFFF;
-      int   rnd = ((tmp * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      dith = rnd;
-      rnd = (rnd+tmp)>>1;           /* triangular distribution */
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    add_dither(csound, (MYFLT*) outbuf, nbytes / (int) sizeof(MYFLT),
+               1, (MYFLT) 0x7f);
+    writesf(csound, outbuf, nbytes);
 }
 
 static void writesf_dither_u16(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
-
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      dith =  rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7fff);
-      buf[n] += result;
-    }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s",  "\a");
-        break;
-    }
+    add_dither(csound, (MYFLT*) outbuf, nbytes / (int) sizeof(MYFLT),
+               0, (MYFLT) 0x7fff);
+    writesf(csound, outbuf, nbytes);
 }
 
 static void writesf_dither_u8(CSOUND *csound, const MYFLT *outbuf, int nbytes)
 {
-    OPARMS  *O = csound->oparms;
-    int     n;
-    int m = nbytes / sizeof(MYFLT);
-    MYFLT *buf = (MYFLT*) outbuf;
-    int dith;
-
     if (UNLIKELY(STA(outfile) == NULL))
       return;
-    dith = STA(dither);
-    for (n=0; n<m; n++) {
-      int   rnd = ((dith * 15625) + 1) & 0xFFFF;
-      MYFLT result;
-      STA(dither) = rnd;
-      result = (MYFLT) (rnd - 0x8000)  / ((MYFLT) 0x10000);
-      result /= ((MYFLT) 0x7f);
-      buf[n] += result;
-    }
-    STA(dither) = dith;
-    n = (int) sf_write_MYFLT(STA(outfile), (MYFLT*) outbuf,
-                             nbytes / sizeof(MYFLT)) * (int) sizeof(MYFLT);
-    if (UNLIKELY(n < nbytes))
-      sndwrterr(csound, n, nbytes);
-    if (UNLIKELY(O->rewrt_hdr))
-      rewriteheader(STA(outfile));
-    switch (O->heartbeat) {
-      case 1:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME,
-                                 "%c\010", "|/-\\"[csound->nrecs & 3]);
-        break;
-      case 2:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, ".");
-        break;
-      case 3:
-        {
-          char    s[512];
-          CS_SPRINTF(s, "%ld(%.3f)%n", (long) csound->nrecs,
-                  csound->icurTime/csound->esr, &n);
-          if (n > 0) {
-            memset(&(s[n]), '\b', n);
-            s[n + n] = '\0';
-            csound->MessageS(csound, CSOUNDMSG_REALTIME, "%s", s);
-          }
-        }
-        break;
-      case 4:
-        csound->MessageS(csound, CSOUNDMSG_REALTIME, "\a");
-        break;
-    }
+    add_dither(csound, (MYFLT*) outbuf, nbytes / (int) sizeof(MYFLT),
+               0, (MYFLT) 0x7f);
+    writesf(csound, outbuf, nbytes);
 }
 
 static int readsf(CSOUND *csound, MYFLT *inbuf, int inbufsize)
@@ -866,6 +882,8 @@ void sfopenout(CSOUND *csound)                  /* init for sound out       */
     /* calc outbuf size & alloc bufspace */
     STA(outbufsiz) = O->outbufsamps * sizeof(MYFLT);
     STA(outbufp)   = STA(outbuf) = csound->Malloc(csound, STA(outbufsiz));
+    if (O->writeBuffers > 0 && STA(outfile) != NULL)
+      sndwriter_start(csound, O->writeBuffers);
     if (STA(pipdevout) == 2)
       csound->Message(csound,
                       Str("writing %d sample blks of %lu-bit floats to %s\n"),
@@ -921,6 +939,8 @@ void sfcloseout(CSOUND *csound)
       csound->nrecs++;
       csound->audtran(csound, STA(outbuf), nb);
     }
+    if (STA(writer) != NULL)
+      sndwriter_stop(csound);
     if (STA(pipdevout) == 2 && (!STA(isfopen) || STA(pipdevin) != 2)) {
       /* close only if not open for input too */
       csound->rtclose_callback(csound);
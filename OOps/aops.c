@@ -22,6 +22,7 @@
 
 #include "csoundCore.h" /*                                      AOPS.C  */
 #include "aops.h"
+#include "aops_kernels.h"
 #include <math.h>
 #include <time.h>
 
@@ -275,24 +276,23 @@ int32_t modkk(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define KA(OPNAME,OP)                                  \
+#define KA(OPNAME,OP,K)                                \
   int32_t OPNAME(CSOUND *csound, AOP *p) {             \
-    uint32_t n, nsmps = CS_KSMPS;                      \
+    uint32_t nsmps = CS_KSMPS;                         \
     IGN(csound);                                       \
     if (LIKELY(nsmps!=1)) {                            \
-      MYFLT   *r, a, *b;                               \
+      MYFLT   *r;                                      \
       uint32_t offset = p->h.insdshead->ksmps_offset;  \
       uint32_t early  = p->h.insdshead->ksmps_no_end;  \
       r = p->r;                                        \
-      a = *p->a;                                       \
-      b = p->b;                                        \
       if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
       if (UNLIKELY(early)) {                           \
         nsmps -= early;                                \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
       }                                                \
-      for (n=offset; n<nsmps; n++)                     \
-        r[n] = a OP b[n];                              \
+      if (LIKELY(offset < nsmps))                      \
+        csound_aop_kernels->sv[K](&r[offset], *p->a,   \
+                                  &p->b[offset], nsmps-offset); \
       return OK;                                       \
     }                                                  \
     else {                                             \
@@ -302,10 +302,10 @@ int32_t modkk(CSOUND *csound, AOP *p)
   }
 
 
-KA(addka,+)
-KA(subka,-)
-KA(mulka,*)
-KA(divka,/)
+KA(addka,+,AOPK_ADD)
+KA(subka,-,AOPK_SUB)
+KA(mulka,*,AOPK_MUL)
+KA(divka,/,AOPK_DIV)
 
 int32_t modka(CSOUND *csound, AOP *p)
 {
@@ -328,25 +328,24 @@ int32_t modka(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define AK(OPNAME,OP)                           \
+#define AK(OPNAME,OP,K)                         \
   int32_t OPNAME(CSOUND *csound, AOP *p) {      \
-    uint32_t n, nsmps = CS_KSMPS;               \
+    uint32_t nsmps = CS_KSMPS;                  \
     IGN(csound);                                \
     if (LIKELY(nsmps != 1)) {                   \
-      MYFLT   *r, *a, b;                        \
+      MYFLT   *r;                               \
       uint32_t offset = p->h.insdshead->ksmps_offset;  \
       uint32_t early  = p->h.insdshead->ksmps_no_end;  \
       r = p->r;                                 \
-      a = p->a;                                 \
-      b = *p->b;                                \
       if (UNLIKELY(offset))                     \
         memset(r, '\0', offset*sizeof(MYFLT));  \
       if (UNLIKELY(early)) {                    \
         nsmps -= early;                         \
         memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
       }                                         \
-      for (n=offset; n<nsmps; n++)              \
-        r[n] = a[n] OP b;                       \
+      if (LIKELY(offset < nsmps))               \
+        csound_aop_kernels->vs[K](&r[offset], &p->a[offset], \
+                                  *p->b, nsmps-offset); \
       return OK;                                \
     }                                           \
     else {                                      \
@@ -355,20 +354,18 @@ int32_t modka(CSOUND *csound, AOP *p)
     }                                           \
 }
 
-AK(addak,+)
-AK(subak,-)
-AK(mulak,*)
+AK(addak,+,AOPK_ADD)
+AK(subak,-,AOPK_SUB)
+AK(mulak,*,AOPK_MUL)
 //AK(divak,/)
 int32_t divak(CSOUND *csound, AOP *p) {
-    uint32_t n, nsmps = CS_KSMPS;
+    uint32_t nsmps = CS_KSMPS;
     MYFLT b = *p->b;
     if (LIKELY(nsmps != 1)) {
-      MYFLT   *r, *a;
+      MYFLT   *r;
       uint32_t offset = p->h.insdshead->ksmps_offset;
       uint32_t early  = p->h.insdshead->ksmps_no_end;
       r = p->r;
-      a = p->a;
-      b = *p->b;
       if (UNLIKELY(b==FL(0.0)))
         csound->Warning(csound, Str("Division by zero"));
       if (UNLIKELY(offset))
@@ -377,8 +374,9 @@ int32_t divak(CSOUND *csound, AOP *p) {
         nsmps -= early;
         memset(&r[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        r[n] = a[n] / b;
+      if (LIKELY(offset < nsmps))
+        csound_aop_kernels->vs[AOPK_DIV](&r[offset], &p->a[offset],
+                                         b, nsmps-offset);
       return OK;
     }
     else {
@@ -411,24 +409,23 @@ int32_t modak(CSOUND *csound, AOP *p)
     return OK;
 }
 
-#define AA(OPNAME,OP)                           \
+#define AA(OPNAME,OP,K)                         \
   int32_t OPNAME(CSOUND *csound, AOP *p) {      \
-  MYFLT   *r, *a, *b;                           \
+  MYFLT   *r;                                   \
   IGN(csound);                                  \
-  uint32_t n, nsmps = CS_KSMPS;                 \
+  uint32_t nsmps = CS_KSMPS;                    \
   if (LIKELY(nsmps!=1)) {                       \
     uint32_t offset = p->h.insdshead->ksmps_offset;  \
     uint32_t early  = p->h.insdshead->ksmps_no_end;  \
     r = p->r;                                   \
-    a = p->a;                                   \
-    b = p->b;                                   \
     if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
     if (UNLIKELY(early)) {                      \
       nsmps -= early;                           \
       memset(&r[nsmps], '\0', early*sizeof(MYFLT)); \
     }                                           \
-    for (n=offset; n<nsmps; n++)                \
-      r[n] = a[n] OP b[n];                      \
+    if (LIKELY(offset < nsmps))                 \
+      csound_aop_kernels->vv[K](&r[offset], &p->a[offset], \
+                                &p->b[offset], nsmps-offset); \
     return OK;                                  \
   }                                             \
     else {                                      \
@@ -437,52 +434,10 @@ int32_t modak(CSOUND *csound, AOP *p)
     }                                           \
   }
 
-/* VL
-   experimental code using SSE for operations
-   needs memory alignment - 16 bytes
-*/
-#ifdef USE_SSE
-#include "emmintrin.h"
-#define AA_VEC(OPNAME,OP)                   \
-int32_t OPNAME(CSOUND *csound, AOP *p){     \
-  MYFLT   *r, *a, *b;                       \
-  __m128d va, vb;                           \
-  uint32_t n, nsmps = CS_KSMPS, end;        \
-  if (LIKELY(nsmps!=1)) {                   \
-  uint32_t offset = p->h.insdshead->ksmps_offset; \
-  uint32_t early  = p->h.insdshead->ksmps_no_end; \
-  r = p->r; a = p->a; b = p->b;             \
-  if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT)); \
-  if (UNLIKELY(early)) {                    \
-      nsmps -= early;                       \
-      memset(&r[nsmps], '\0', early*sizeof(MYFLT));  \
-  } \
-  end = nsmps; \
-  for (n=offset; n<end; n+=2) { \
-   va = _mm_loadu_pd(&a[n]); \
-   vb = _mm_loadu_pd(&b[n]); \
-   va = OP(va,vb);\
-   _mm_storeu_pd(&r[n],va); \
-  }     \
-  return OK; \
-  } \
-   else { \
-     *p->r = *p->a + *p->b;\
-      return OK; \
-   }             \
-} \
-
-AA_VEC(addaa,_mm_add_pd)
-AA_VEC(subaa,_mm_sub_pd)
-AA_VEC(mulaa,_mm_mul_pd)
-AA_VEC(divaa,_mm_div_pd)
-
-#else
-AA(addaa,+)
-AA(subaa,-)
-AA(mulaa,*)
-AA(divaa,/)
-#endif
+AA(addaa,+,AOPK_ADD)
+AA(subaa,-,AOPK_SUB)
+AA(mulaa,*,AOPK_MUL)
+AA(divaa,/,AOPK_DIV)
 
 int32_t modaa(CSOUND *csound, AOP *p)
 {
@@ -505,6 +460,100 @@ int32_t modaa(CSOUND *csound, AOP *p)
     return OK;
 }
 
+/* Fused a-rate arithmetic.  Every step is the same IEEE operation the
+   separate ##add/##sub/##mul/##div opcodes would do, so the result is
+   identical; intermediate values live in per-step registers of
+   FUSED_CHUNK samples instead of a-rate variables, and each step is a
+   plain loop the compiler can vectorise. */
+
+enum { FUSED_REG, FUSED_SIG, FUSED_K };
+
+int32_t fusedset(CSOUND *csound, FUSED *p)
+{
+    const char *s = p->prog->data;
+    char    kind[FUSED_ARGS];
+    uint8_t idx[FUSED_ARGS];
+    int32_t nargs = p->INOCOUNT - 1, sp = 0, n = 0;
+
+    for ( ; *s != '\0'; s++) {
+      if (*s >= 'a' && *s < 'a' + nargs && sp < FUSED_ARGS) {
+        int32_t i = *s - 'a';
+        kind[sp] = IS_ASIG_ARG(p->args[i]) ? FUSED_SIG : FUSED_K;
+        idx[sp++] = (uint8_t) i;
+      }
+      else if (strchr("+-*/", *s) != NULL && sp >= 2 && n < FUSED_ARGS) {
+        FUSEDOP *c = &p->code[n];
+        c->op = *s;
+        sp--;
+        c->y = kind[sp]; c->yi = idx[sp];
+        sp--;
+        c->x = kind[sp]; c->xi = idx[sp];
+        if (UNLIKELY(c->x == FUSED_K && c->y == FUSED_K)) break;
+        kind[sp] = FUSED_REG;
+        idx[sp++] = (uint8_t) n++;
+      }
+      else break;
+    }
+    if (UNLIKELY(*s != '\0' || sp != 1 || n == 0))
+      return csound->InitError(csound, Str("malformed fused expression %s"),
+                               p->prog->data);
+    p->ncode = n;
+    return OK;
+}
+
+#define FUSED_LOOPS(X, Y)                                       \
+    switch (c->op) {                                            \
+    case '+': for (i = 0; i < m; i++) d[i] = X + Y; break;      \
+    case '-': for (i = 0; i < m; i++) d[i] = X - Y; break;      \
+    case '*': for (i = 0; i < m; i++) d[i] = X * Y; break;      \
+    default:  for (i = 0; i < m; i++) d[i] = X / Y; break;      \
+    }
+
+int32_t fused(CSOUND *csound, FUSED *p)
+{
+    MYFLT   reg[FUSED_ARGS][FUSED_CHUNK];
+    MYFLT   *r = p->r;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t n, m, i, nsmps = CS_KSMPS;
+    int32_t j, last = p->ncode - 1;
+
+    for (j = 0; j <= last; j++)           /* as divak warns */
+      if (UNLIKELY(p->code[j].op == '/' && p->code[j].y == FUSED_K &&
+                   *p->args[p->code[j].yi] == FL(0.0)))
+        csound->Warning(csound, Str("Division by zero"));
+    if (UNLIKELY(nsmps == 1))             /* single ops ignore the offsets */
+      offset = early = 0;
+    if (UNLIKELY(offset)) memset(r, '\0', offset*sizeof(MYFLT));
+    if (UNLIKELY(early)) {
+      nsmps -= early;
+      memset(&r[nsmps], '\0', early*sizeof(MYFLT));
+    }
+    for (n = offset; n < nsmps; n += m) {
+      m = nsmps - n < FUSED_CHUNK ? nsmps - n : FUSED_CHUNK;
+      for (j = 0; j <= last; j++) {
+        FUSEDOP *c = &p->code[j];
+        MYFLT   *d = (j == last ? r + n : reg[j]), *x, *y;
+        if (c->x == FUSED_K) {
+          MYFLT a = *p->args[c->xi];
+          y = (c->y == FUSED_REG ? reg[c->yi] : p->args[c->yi] + n);
+          FUSED_LOOPS(a, y[i])
+        }
+        else if (c->y == FUSED_K) {
+          MYFLT b = *p->args[c->yi];
+          x = (c->x == FUSED_REG ? reg[c->xi] : p->args[c->xi] + n);
+          FUSED_LOOPS(x[i], b)
+        }
+        else {
+          x = (c->x == FUSED_REG ? reg[c->xi] : p->args[c->xi] + n);
+          y = (c->y == FUSED_REG ? reg[c->yi] : p->args[c->yi] + n);
+          FUSED_LOOPS(x[i], y[i])
+        }
+      }
+    }
+    return OK;
+}
+
 int32_t divzkk(CSOUND *csound, DIVZ *p)
 {
     IGN(csound);
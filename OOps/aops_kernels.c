@@ -0,0 +1,217 @@
+/*
+    aops_kernels.c:
+
+    This file is part of Csound.
+
+    The Csound Library is free software; you can redistribute it
+    and/or modify it under the terms of the GNU Lesser General Public
+    License as published by the Free Software Foundation; either
+    version 2.1 of the License, or (at your option) any later version.
+
+    Csound is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU Lesser General Public License for more details.
+
+    You should have received a copy of the GNU Lesser General Public
+    License along with Csound; if not, write to the Free Software
+    Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+    02110-1301 USA
+*/
+
+/* Vector inner loops for the a-rate + - * / opcodes, the matching
+   audio-array operations and the peak meter of the sound output.  The
+   SSE2 and AVX2 versions are compiled with per-function target
+   attributes so the library itself can still be built for a baseline
+   CPU; which one is used is decided once at start up from the CPU's
+   feature bits.  NEON is part of every aarch64 CPU so
+   it needs no test.  32-bit ARM NEON is left out: it flushes denormals
+   and has no divide, so it would not give the same results as C. */
+
+#include "aops_kernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  define AOPK_X86
+#  include <immintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#  define AOPK_NEON
+#  include <arm_neon.h>
+#endif
+
+/* One set of kernels for one operator.  W is the vector width in
+   samples; the remaining n % W samples are done one at a time.  Only
+   unaligned loads and stores are used, since a-rate variables and array
+   members carry no alignment guarantee and an offset start shifts them
+   anyway. */
+#define VEC_OPS(ISA, ATTR, W, V, LD, ST, SET1, VOP, OP, NAME)           \
+  static ATTR void ISA##_vv_##NAME(MYFLT *r, const MYFLT *a,            \
+                                   const MYFLT *b, uint32_t n)          \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    for (; i + W <= n; i += W)                                          \
+      ST(&r[i], VOP(LD(&a[i]), LD(&b[i])));                             \
+    for (; i < n; i++)                                                  \
+      r[i] = a[i] OP b[i];                                              \
+  }                                                                     \
+  static ATTR void ISA##_vs_##NAME(MYFLT *r, const MYFLT *a,            \
+                                   MYFLT b, uint32_t n)                 \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    V vb = SET1(b);                                                     \
+    for (; i + W <= n; i += W)                                          \
+      ST(&r[i], VOP(LD(&a[i]), vb));                                    \
+    for (; i < n; i++)                                                  \
+      r[i] = a[i] OP b;                                                 \
+  }                                                                     \
+  static ATTR void ISA##_sv_##NAME(MYFLT *r, MYFLT a,                   \
+                                   const MYFLT *b, uint32_t n)          \
+  {                                                                     \
+    uint32_t i = 0;                                                     \
+    V va = SET1(a);                                                     \
+    for (; i + W <= n; i += W)                                          \
+      ST(&r[i], VOP(va, LD(&b[i])));                                    \
+    for (; i < n; i++)                                                  \
+      r[i] = a OP b[i];                                                 \
+  }
+
+/* The output peak meter, one column of W lanes at a time down all the
+   rows, so the running maxima and counts stay in registers.  MAX(a, m)
+   must give m when a is NaN and GT1(a, l, one) is one where a > l. */
+#define VEC_PEAK(ISA, ATTR, W, V, LD, ST, SET1, ADD, ABS, MAX, GT1)    \
+  static ATTR void ISA##_peak(MYFLT *amax, MYFLT *over, const MYFLT *x, \
+                              uint32_t n, uint32_t lanes, MYFLT lim)    \
+  {                                                                     \
+    uint32_t i, j;                                                      \
+    V vlim = SET1(lim), one = SET1((MYFLT) 1);                            \
+    for (j = 0; j < lanes; j += W) {                                    \
+      V m = LD(&amax[j]), c = LD(&over[j]);                             \
+      for (i = j; i < n; i += lanes) {                                  \
+        V a = ABS(LD(&x[i]));                                           \
+        m = MAX(a, m);                                                  \
+        c = ADD(c, GT1(a, vlim, one));                                  \
+      }                                                                 \
+      ST(&amax[j], m);                                                  \
+      ST(&over[j], c);                                                  \
+    }                                                                   \
+  }
+
+#define VEC_SET(ISA, ATTR, W, V, LD, ST, SET1, ADD, SUB, MUL, DIV,      \
+                ABS, MAX, GT1)                                          \
+  VEC_OPS(ISA, ATTR, W, V, LD, ST, SET1, ADD, +, add)                   \
+  VEC_OPS(ISA, ATTR, W, V, LD, ST, SET1, SUB, -, sub)                   \
+  VEC_OPS(ISA, ATTR, W, V, LD, ST, SET1, MUL, *, mul)                   \
+  VEC_OPS(ISA, ATTR, W, V, LD, ST, SET1, DIV, /, div)                   \
+  VEC_PEAK(ISA, ATTR, W, V, LD, ST, SET1, ADD, ABS, MAX, GT1)           \
+  static const AOP_KERNELS ISA##_kernels = {                            \
+    #ISA,                                                               \
+    { ISA##_vv_add, ISA##_vv_sub, ISA##_vv_mul, ISA##_vv_div },         \
+    { ISA##_vs_add, ISA##_vs_sub, ISA##_vs_mul, ISA##_vs_div },         \
+    { ISA##_sv_add, ISA##_sv_sub, ISA##_sv_mul, ISA##_sv_div },         \
+    ISA##_peak                                                          \
+  };
+
+/* plain C: what the opcodes always did, left to the compiler */
+#define PLAIN_LD(p)       (*(p))
+#define PLAIN_ST(p, x)    (*(p) = (x))
+#define PLAIN_SET1(x)     (x)
+#define PLAIN_ADD(x, y)   ((x) + (y))
+#define PLAIN_SUB(x, y)   ((x) - (y))
+#define PLAIN_MUL(x, y)   ((x) * (y))
+#define PLAIN_DIV(x, y)   ((x) / (y))
+#define PLAIN_ABS(x)      ((x) < 0 ? -(x) : (x))
+#define PLAIN_MAX(a, m)   ((a) > (m) ? (a) : (m))
+#define PLAIN_GT1(a, l, one) ((a) > (l) ? (one) : (MYFLT) 0)
+VEC_SET(plain, , 1, MYFLT, PLAIN_LD, PLAIN_ST, PLAIN_SET1,
+        PLAIN_ADD, PLAIN_SUB, PLAIN_MUL, PLAIN_DIV,
+        PLAIN_ABS, PLAIN_MAX, PLAIN_GT1)
+
+#ifdef AOPK_X86
+#  define SSE2_ATTR __attribute__((target("sse2")))
+#  define AVX2_ATTR __attribute__((target("avx2")))
+/* maxpd/maxps return the second operand when either is NaN */
+#  ifdef USE_DOUBLE
+static SSE2_ATTR inline __m128d sse2_abs(__m128d x)
+{ return _mm_andnot_pd(_mm_set1_pd(-0.0), x); }
+static SSE2_ATTR inline __m128d sse2_gt1(__m128d a, __m128d l, __m128d one)
+{ return _mm_and_pd(_mm_cmpgt_pd(a, l), one); }
+static AVX2_ATTR inline __m256d avx2_abs(__m256d x)
+{ return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x); }
+static AVX2_ATTR inline __m256d avx2_gt1(__m256d a, __m256d l, __m256d one)
+{ return _mm256_and_pd(_mm256_cmp_pd(a, l, _CMP_GT_OQ), one); }
+VEC_SET(sse2, SSE2_ATTR, 2, __m128d, _mm_loadu_pd, _mm_storeu_pd,
+        _mm_set1_pd, _mm_add_pd, _mm_sub_pd, _mm_mul_pd, _mm_div_pd,
+        sse2_abs, _mm_max_pd, sse2_gt1)
+VEC_SET(avx2, AVX2_ATTR, 4, __m256d, _mm256_loadu_pd, _mm256_storeu_pd,
+        _mm256_set1_pd, _mm256_add_pd, _mm256_sub_pd, _mm256_mul_pd,
+        _mm256_div_pd, avx2_abs, _mm256_max_pd, avx2_gt1)
+#  else
+static SSE2_ATTR inline __m128 sse2_abs(__m128 x)
+{ return _mm_andnot_ps(_mm_set1_ps(-0.0f), x); }
+static SSE2_ATTR inline __m128 sse2_gt1(__m128 a, __m128 l, __m128 one)
+{ return _mm_and_ps(_mm_cmpgt_ps(a, l), one); }
+static AVX2_ATTR inline __m256 avx2_abs(__m256 x)
+{ return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), x); }
+static AVX2_ATTR inline __m256 avx2_gt1(__m256 a, __m256 l, __m256 one)
+{ return _mm256_and_ps(_mm256_cmp_ps(a, l, _CMP_GT_OQ), one); }
+VEC_SET(sse2, SSE2_ATTR, 4, __m128, _mm_loadu_ps, _mm_storeu_ps,
+        _mm_set1_ps, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_div_ps,
+        sse2_abs, _mm_max_ps, sse2_gt1)
+VEC_SET(avx2, AVX2_ATTR, 8, __m256, _mm256_loadu_ps, _mm256_storeu_ps,
+        _mm256_set1_ps, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps,
+        _mm256_div_ps, avx2_abs, _mm256_max_ps, avx2_gt1)
+#  endif
+#endif
+
+#ifdef AOPK_NEON
+/* vmaxq propagates NaN, so the maximum is a compare and select */
+#  ifdef USE_DOUBLE
+static inline float64x2_t neon_max(float64x2_t a, float64x2_t m)
+{ return vbslq_f64(vcgtq_f64(a, m), a, m); }
+static inline float64x2_t neon_gt1(float64x2_t a, float64x2_t l,
+                                   float64x2_t one)
+{ return vreinterpretq_f64_u64(vandq_u64(vcgtq_f64(a, l),
+                                         vreinterpretq_u64_f64(one))); }
+VEC_SET(neon, , 2, float64x2_t, vld1q_f64, vst1q_f64, vdupq_n_f64,
+        vaddq_f64, vsubq_f64, vmulq_f64, vdivq_f64,
+        vabsq_f64, neon_max, neon_gt1)
+#  else
+static inline float32x4_t neon_max(float32x4_t a, float32x4_t m)
+{ return vbslq_f32(vcgtq_f32(a, m), a, m); }
+static inline float32x4_t neon_gt1(float32x4_t a, float32x4_t l,
+                                   float32x4_t one)
+{ return vreinterpretq_f32_u32(vandq_u32(vcgtq_f32(a, l),
+                                         vreinterpretq_u32_f32(one))); }
+VEC_SET(neon, , 4, float32x4_t, vld1q_f32, vst1q_f32, vdupq_n_f32,
+        vaddq_f32, vsubq_f32, vmulq_f32, vdivq_f32,
+        vabsq_f32, neon_max, neon_gt1)
+#  endif
+#endif
+
+const AOP_KERNELS *csound_aop_kernels = &plain_kernels;
+
+const AOP_KERNELS *csound_aops_kernel_set(int n)
+{
+    const AOP_KERNELS *sets[3];
+    int k = 0;
+
+    sets[k++] = &plain_kernels;
+#if defined(AOPK_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2")) {
+      sets[k++] = &sse2_kernels;
+      if (__builtin_cpu_supports("avx2"))
+        sets[k++] = &avx2_kernels;
+    }
+#elif defined(AOPK_NEON)
+    sets[k++] = &neon_kernels;
+#endif
+    return (n >= 0 && n < k) ? sets[n] : NULL;
+}
+
+void csound_aops_select_kernels(void)
+{
+    int n = 0;
+    while (csound_aops_kernel_set(n + 1) != NULL)
+      n++;
+    csound_aop_kernels = csound_aops_kernel_set(n);
+}
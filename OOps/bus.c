@@ -443,6 +443,20 @@ PUBLIC int32_t csoundGetChannelPtr(CSOUND *csound,
     return CSOUND_ERROR;
 }
 
+PUBLIC int32_t csoundGetChannelHandle(CSOUND *csound, CHANNEL_HANDLE **h,
+                                      const char *name, int32_t type)
+{
+    MYFLT     *p;
+    int32_t   err;
+
+    *h = (CHANNEL_HANDLE*) NULL;
+    /* creates the channel if needed, and checks its type */
+    if ((err = csoundGetChannelPtr(csound, &p, name, type)) != CSOUND_SUCCESS)
+      return err;
+    *h = (CHANNEL_HANDLE*) find_channel(csound, name);
+    return CSOUND_SUCCESS;
+}
+
 PUBLIC int32_t csoundGetChannelDatasize(CSOUND *csound, const char *name){
 
     CHNENTRY  *pp;
@@ -27,11 +27,308 @@
 #include <math.h>
 #include <inttypes.h>
 
-typedef struct DISKIN_INST_ {
-  CSOUND *csound;
-  DISKIN2 *diskin;
-  struct DISKIN_INST_ *nxt;
-} DISKIN_INST;
+/* Asynchronous diskin2 (realtime mode).  A pool of I/O threads shared
+   by all streams renders each stream a chunk at a time into a circular
+   buffer, which the opcode empties one k-cycle block at a time.  A free
+   thread always takes the stream closest to running dry, and a stream is
+   kept topped up to a read-ahead that grows with its playback speed, as
+   each chunk of a fast stream needs more of the file read. */
+
+#define DISKIN_MAX_AHEAD  4             /* chunks a stream buffer holds */
+
+typedef struct DISKIN_STREAM_ {
+  struct DISKIN_SERVICE_ *service;
+  void    *owner;                       /* DISKIN2 or DISKIN2_ARRAY */
+  int32_t (*render)(CSOUND *, void *);  /* one chunk into outbuf */
+  MYFLT   *outbuf;                      /* chunk frames, interleaved */
+  const int64_t *pos_frac_inc;          /* owner's playback speed */
+  const char *name;
+  void    *cb;                          /* I/O thread to opcode */
+  MYFLT   *blk;                         /* one k-cycle, interleaved */
+  int32_t nChannels;
+  int32_t chunk;                        /* frames per render */
+  volatile int32_t buffered;            /* frames in cb */
+  volatile int32_t busy;                /* an I/O thread is rendering it */
+  int32_t removed;                      /* out of the list, being freed */
+  void    *idle;                        /* notified when busy clears */
+  int32_t failed;
+  uint32_t underruns;                   /* k-cycles short of data */
+  uint32_t lost;                        /* frames played as silence */
+  struct DISKIN_STREAM_ *nxt;
+} DISKIN_STREAM;
+
+typedef struct DISKIN_SERVICE_ {
+  CSOUND  *csound;
+  void    *lock;                        /* guards the stream list */
+  void    *wakeup;
+  void    **threads;
+  int32_t nthreads;
+  volatile int32_t running;
+  DISKIN_STREAM *streams;
+} DISKIN_SERVICE;
+
+/* read-ahead in frames: one chunk more than the file frames read per
+   output frame, rounded up, in chunks */
+static int32_t diskin_stream_ahead(DISKIN_STREAM *st)
+{
+    int64_t inc = *st->pos_frac_inc;
+    int32_t n;
+    if (inc < 0) inc = -inc;
+    n = (int32_t) ((inc + POS_FRAC_MASK) >> POS_FRAC_SHIFT) + 1;
+    return (n < 2 ? 2 : n > DISKIN_MAX_AHEAD ? DISKIN_MAX_AHEAD : n)
+      * st->chunk;
+}
+
+/* claim the stream with the fewest frames buffered among those below
+   their read-ahead, or return NULL if none is */
+static DISKIN_STREAM *diskin_stream_next(CSOUND *csound, DISKIN_SERVICE *s)
+{
+    DISKIN_STREAM *st, *due = NULL;
+    int32_t least = 0, more = 0;
+
+    csound->LockMutex(s->lock);
+    for (st = s->streams; st != NULL; st = st->nxt) {
+      int32_t buffered;
+      if (ATOMIC_GET(st->busy) || st->failed)
+        continue;
+      buffered = ATOMIC_GET(st->buffered);
+      if (buffered >= diskin_stream_ahead(st) ||
+          buffered > (DISKIN_MAX_AHEAD - 1) * st->chunk)
+        continue;
+      if (due != NULL)
+        more = 1;
+      if (due == NULL || buffered < least) {
+        due = st;
+        least = buffered;
+      }
+    }
+    if (due != NULL)
+      ATOMIC_SET(due->busy, 1);
+    csound->UnlockMutex(s->lock);
+    if (more)                           /* work for another thread */
+      csound->NotifyThreadLock(s->wakeup);
+    return due;
+}
+
+static void diskin_stream_fill(CSOUND *csound, DISKIN_STREAM *st)
+{
+    if (UNLIKELY(st->render(csound, st->owner) != OK)) {
+      st->failed = 1;                   /* message already printed */
+      return;
+    }
+    /* there is room: streams are only taken with a chunk free */
+    csound->WriteCircularBuffer(csound, st->cb, st->outbuf,
+                                st->chunk * st->nChannels);
+    ATOMIC_ADD(st->buffered, st->chunk);
+}
+
+static uintptr_t diskin_io_thread(void *p)
+{
+    DISKIN_SERVICE *s = (DISKIN_SERVICE *) p;
+    CSOUND  *csound = s->csound;
+    int32_t wakeup = 1000*csound->ksmps/csound->esr;
+
+    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
+    while (ATOMIC_GET(s->running)) {
+      DISKIN_STREAM *st = diskin_stream_next(csound, s);
+      if (st == NULL) {
+        csound->WaitThreadLock(s->wakeup, (size_t) (wakeup > 0 ? wakeup : 1));
+        continue;
+      }
+      diskin_stream_fill(csound, st);
+      /* under the lock, so that a remover waiting for it cannot free the
+         stream before we are done with it */
+      csound->LockMutex(s->lock);
+      ATOMIC_SET(st->busy, 0);
+      if (st->removed)
+        csound->NotifyThreadLock(st->idle);
+      csound->UnlockMutex(s->lock);
+    }
+    return 0;
+}
+
+static int32_t diskin_service_stop(CSOUND *csound, void *p)
+{
+    DISKIN_SERVICE *s = (DISKIN_SERVICE *) p;
+    int32_t i;
+
+    ATOMIC_SET(s->running, 0);
+    csound->NotifyThreadLock(s->wakeup);
+    for (i = 0; i < s->nthreads; i++)   /* idle ones time out */
+      csound->JoinThread(s->threads[i]);
+    s->nthreads = 0;
+    csound->DestroyThreadLock(s->wakeup);
+    csound->DestroyMutex(s->lock);
+    csound->Free(csound, s->threads);
+    return OK;
+}
+
+/* the I/O thread pool, started on first use and stopped at reset */
+static DISKIN_SERVICE *diskin_service(CSOUND *csound)
+{
+    DISKIN_SERVICE *s;
+    int32_t i, n = csound->oparms->diskinThreads;
+
+    s = (DISKIN_SERVICE *) csound->QueryGlobalVariable(csound,
+                                                       "DISKIN_SERVICE");
+    if (s != NULL)
+      return s->nthreads ? s : NULL;
+    if (UNLIKELY(csound->CreateGlobalVariable(csound, "DISKIN_SERVICE",
+                                              sizeof(DISKIN_SERVICE)) != 0))
+      return NULL;
+    s = (DISKIN_SERVICE *) csound->QueryGlobalVariable(csound,
+                                                       "DISKIN_SERVICE");
+    if (n < 1) n = 1;
+    s->csound = csound;
+    s->lock = csound->Create_Mutex(0);
+    s->wakeup = csound->CreateThreadLock();
+    s->threads = (void **) csound->Calloc(csound, n * sizeof(void *));
+    s->running = 1;
+    for (i = 0; i < n; i++)
+      if ((s->threads[s->nthreads] =
+           csound->CreateThread(diskin_io_thread, s)) != NULL)
+        s->nthreads++;
+    if (UNLIKELY(s->nthreads == 0)) {
+      diskin_service_stop(csound, s);
+      return NULL;
+    }
+    csound->RegisterResetCallback(csound, s, diskin_service_stop);
+    return s;
+}
+
+/* set up asynchronous reading for an opcode that renders chunk frames
+   at a time into outbuf; NULL means read synchronously */
+static DISKIN_STREAM *diskin_stream_add(CSOUND *csound, void *owner,
+                                        int32_t (*render)(CSOUND *, void *),
+                                        MYFLT *outbuf, int32_t chunk,
+                                        int32_t nChannels,
+                                        const int64_t *pos_frac_inc,
+                                        const char *name)
+{
+#ifdef __EMSCRIPTEN__
+    return NULL;
+#else
+    DISKIN_SERVICE *s;
+    DISKIN_STREAM *st;
+
+    if ((s = diskin_service(csound)) == NULL)
+      return NULL;
+    st = (DISKIN_STREAM *) csound->Calloc(csound, sizeof(DISKIN_STREAM));
+    st->cb = csound->CreateCircularBuffer(csound, DISKIN_MAX_AHEAD * chunk
+                                          * nChannels + 1, sizeof(MYFLT));
+    if (UNLIKELY(st->cb == NULL)) {
+      csound->Free(csound, st);
+      return NULL;
+    }
+    st->blk = (MYFLT *) csound->Malloc(csound, csound->ksmps * nChannels
+                                       * sizeof(MYFLT));
+    st->idle = csound->CreateThreadLock();
+    csound->WaitThreadLock(st->idle, 0);        /* created notified */
+    st->service = s;
+    st->owner = owner;
+    st->render = render;
+    st->outbuf = outbuf;
+    st->pos_frac_inc = pos_frac_inc;
+    st->name = name;
+    st->nChannels = nChannels;
+    st->chunk = chunk;
+    /* the first chunk is read now, so the note does not start dry */
+    diskin_stream_fill(csound, st);
+    csound->LockMutex(s->lock);
+    st->nxt = s->streams;
+    s->streams = st;
+    csound->UnlockMutex(s->lock);
+    csound->NotifyThreadLock(s->wakeup);
+    return st;
+#endif
+}
+
+static void diskin_stream_remove(CSOUND *csound, DISKIN_STREAM *st)
+{
+    DISKIN_SERVICE *s = st->service;
+    DISKIN_STREAM **pp;
+    int32_t busy;
+
+    csound->LockMutex(s->lock);
+    for (pp = &s->streams; *pp != NULL; pp = &(*pp)->nxt)
+      if (*pp == st) {
+        *pp = st->nxt;
+        break;
+      }
+    st->removed = 1;
+    busy = ATOMIC_GET(st->busy);
+    csound->UnlockMutex(s->lock);
+    if (busy) {                 /* a thread is still rendering it */
+      csound->WaitThreadLockNoTimeout(st->idle);
+      csound->LockMutex(s->lock);       /* and has let go of it */
+      csound->UnlockMutex(s->lock);
+    }
+    if (UNLIKELY(st->underruns))
+      csound->Warning(csound, Str("diskin2: %s: %u buffer underruns, "
+                                  "%u frames of silence\n"),
+                      st->name, st->underruns, st->lost);
+    csound->DestroyThreadLock(st->idle);
+    csound->DestroyCircularBuffer(csound, st->cb);
+    csound->Free(csound, st->blk);
+    csound->Free(csound, st);
+}
+
+/* take the next n frames into st->blk, with silence for any that the
+   I/O threads have not delivered in time */
+static void diskin_stream_read(CSOUND *csound, DISKIN_STREAM *st, int32_t n)
+{
+    int32_t chans = st->nChannels, got;
+
+    got = csound->ReadCircularBuffer(csound, st->cb, st->blk, n * chans)
+      / chans;
+    if (got)
+      ATOMIC_SUB(st->buffered, got);
+    if (UNLIKELY(got < n)) {
+      memset(&st->blk[got * chans], 0, (n - got) * chans * sizeof(MYFLT));
+      st->underruns++;
+      st->lost += n - got;
+    }
+    if (ATOMIC_GET(st->buffered) < st->chunk)   /* about to run dry */
+      csound->NotifyThreadLock(st->service->wakeup);
+}
+
+/* path is name, or ends in it after a directory separator */
+static int32_t diskin_stream_named(const char *path, const char *name)
+{
+    const char *base;
+    if (path == NULL) return 0;
+    if (strcmp(path, name) == 0) return 1;
+    base = strrchr(path, DIRSEP);
+    return base != NULL && strcmp(base + 1, name) == 0;
+}
+
+PUBLIC int csoundGetDiskinUnderruns(CSOUND *csound, const char *name,
+                                    uint32_t *underruns, uint32_t *frames)
+{
+    DISKIN_SERVICE *s;
+    DISKIN_STREAM *st;
+    uint32_t u = 0, f = 0;
+    int n = 0;
+
+    s = (DISKIN_SERVICE *) csound->QueryGlobalVariable(csound,
+                                                       "DISKIN_SERVICE");
+    if (s != NULL && s->nthreads) {
+      csound->LockMutex(s->lock);
+      for (st = s->streams; st != NULL; st = st->nxt)
+        if (name == NULL || diskin_stream_named(st->name, name)) {
+          u += st->underruns;
+          f += st->lost;
+          n++;
+        }
+      csound->UnlockMutex(s->lock);
+    }
+    if (underruns != NULL) *underruns = u;
+    if (frames != NULL) *frames = f;
+    return n;
+}
+
+int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p);
+int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p);
 
 
 static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
@@ -67,12 +364,18 @@ static CS_NOINLINE void diskin2_read_buffer(CSOUND *csound,
       if (nsmps > 0L) {         /* if there is anything to read: */
         if (nsmps > (int32_t) p->bufSize)
           nsmps = (int32_t) p->bufSize;
-        nsmps *= (int32_t) p->nChannels;
-        sf_seek(p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
-        /* convert sample count to mono samples and read file */
-        i = (int32_t)sf_read_MYFLT(p->sf, p->buf, (sf_count_t) nsmps);
-        if (UNLIKELY(i < 0))  /* error ? */
-          i = 0;    /* clear entire buffer to zero */
+        if (p->sndmap != NULL)          /* convert from the mapping */
+          i = (int32_t) csoundSndMapRead((SNDMAP *) p->sndmap, p->buf,
+                                         p->bufStartPos, nsmps, 0, FL(1.0))
+            * (int32_t) p->nChannels;
+        else {
+          nsmps *= (int32_t) p->nChannels;
+          sf_seek(p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
+          /* convert sample count to mono samples and read file */
+          i = (int32_t)sf_read_MYFLT(p->sf, p->buf, (sf_count_t) nsmps);
+          if (UNLIKELY(i < 0))  /* error ? */
+            i = 0;    /* clear entire buffer to zero */
+        }
       }
     }
     /* fill rest of buffer with zero samples */
@@ -294,7 +597,7 @@ int32_t soundin(CSOUND *csound, DISKIN2 *p){
     return ret;
 }
 
-int32_t diskin2_async_deinit(CSOUND *csound, void *p);
+int32_t diskin2_deinit(CSOUND *csound, void *p);
 
 static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
 {
@@ -315,6 +618,14 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
       /* skip initialisation if requested */
       if (p->SkipInit != FL(0.0))
         return OK;
+      if (p->stream != NULL) {          /* stop reading it first */
+        diskin_stream_remove(csound, (DISKIN_STREAM *) p->stream);
+        p->stream = NULL;
+      }
+      if (p->sndmap != NULL) {
+        csoundSndMapClose(csound, (SNDMAP *) p->sndmap);
+        p->sndmap = NULL;
+      }
       fd_close(csound, &(p->fdch));
     }
     /* set default format parameters */
@@ -417,16 +728,17 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
 
     memset(p->buf, 0, n*sizeof(MYFLT));
 
-    // create circular buffer, on fail set mode to synchronous
-    if (csound->oparms->realtime==1 && p->fforceSync==0 &&
-        (p->cb = csound->CreateCircularBuffer(csound,
-                                              p->bufSize*p->nChannels*2,
-                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-#ifndef __EMSCRIPTEN__
-      int32_t *start;
-#endif
-      // allocate buffer
+    /* with --mmap-soundfiles, convert the samples straight from memory */
+    if (csound->oparms->sndMap)
+      p->sndmap = csoundSndMapOpen(csound, csound->GetFileName(fd),
+                                   &sfinfo, 0);
+    /* done initialisation: the I/O threads start reading as soon as
+       the stream is added */
+    p->initDone = 1;
+    // in realtime mode read on the shared I/O threads, if possible
+    p->async = 0;
+    if (csound->oparms->realtime==1 && p->fforceSync==0) {
+      // one chunk of output, at least a k-cycle
       p->aOut_bufsize =  ((unsigned int)p->bufSize) < CS_KSMPS ?
         ((MYFLT)CS_KSMPS) : ((MYFLT)p->bufSize);
       n = p->aOut_bufsize*sizeof(MYFLT)*p->nChannels;
@@ -434,44 +746,18 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
         csound->AuxAlloc(csound, (int32_t) n, &(p->auxData2));
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
-      top = (DISKIN_INST **)csound->QueryGlobalVariable(csound, "DISKIN_INST");
-#ifndef __EMSCRIPTEN__
-      if (top == NULL){
-        csound->CreateGlobalVariable(csound, "DISKIN_INST", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound, "DISKIN_INST");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound, "DISKIN_PTHREAD", sizeof(void**));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START", sizeof(int32_t));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt = (DISKIN_INST *) csound->Calloc(csound,
-                                                        sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin = p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if ( *(start = csound->QueryGlobalVariable(csound,
-                                                 "DISKIN_THREAD_START")) == 0) {
-        uintptr_t diskin_io_thread(void *p);
-        void **thread = csound->QueryGlobalVariable(csound, "DISKIN_PTHREAD");
-        *thread = csound->CreateThread(diskin_io_thread, *top);
-        *start = 1;
-      }
-#endif
-      csound->RegisterDeinitCallback(csound, p, diskin2_async_deinit);
-      p->async = 1;
-
+      p->stream =
+        diskin_stream_add(csound, p,
+                          (int32_t (*)(CSOUND *, void *)) diskin_file_read,
+                          p->aOut_buf, (int32_t) p->aOut_bufsize,
+                          p->nChannels, &p->pos_frac_inc,
+                          csound->GetFileName(fd));
+      if (p->stream != NULL)
+        p->async = 1;
+    }
+    if (p->stream != NULL || p->sndmap != NULL)
+      csound->RegisterDeinitCallback(csound, p, diskin2_deinit);
+    if (p->async) {
       /* print file information */
       if (UNLIKELY((csound->oparms_.msglevel & 7) == 7)) {
         csound->Message(csound, "%s '%s'\n"
@@ -501,43 +787,20 @@ static int32_t diskin2_init_(CSOUND *csound, DISKIN2 *p, int32_t stringname)
       }
     }
 
-    /* done initialisation */
-    p->initDone = 1;
     return OK;
 }
 
-int32_t diskin2_async_deinit(CSOUND *csound,  void *p){
+int32_t diskin2_deinit(CSOUND *csound,  void *p){
+    DISKIN2 *pp = (DISKIN2 *) p;
 
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST")) == NULL) return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
+    if (pp->stream != NULL) {   /* NULL if already stopped for a reinit */
+      diskin_stream_remove(csound, (DISKIN_STREAM *) pp->stream);
+      pp->stream = NULL;
     }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int32_t *start; void **pt;
-
-      start = (int32_t *) csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      *start = 0;
-      pt = csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      csound->JoinThread(*pt);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST");
+    if (pp->sndmap != NULL) {   /* after the I/O threads are done with it */
+      csoundSndMapClose(csound, (SNDMAP *) pp->sndmap);
+      pp->sndmap = NULL;
     }
-#endif
-    csound->Free(csound, current);
-    csound->DestroyCircularBuffer(csound, ((DISKIN2 *)p)->cb);
-
     return OK;
 }
 
@@ -918,16 +1181,6 @@ int32_t diskin_file_read(CSOUND *csound, DISKIN2 *p)
         diskin2_file_pos_inc(p, &ndx);
       }
     }
-    {
-      /* write to circular buffer */
-      int32_t lc, mc=0, nc=nsmps*p->nChannels;
-      int32_t *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc =  csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
-    }
     return OK;
  file_error:
     csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
@@ -939,10 +1192,9 @@ int32_t diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS;
-    MYFLT samp;
+    uint32_t nn, i, nsmps = CS_KSMPS;
     int32_t chn;
-    void *cb = p->cb;
+    DISKIN_STREAM *st = (DISKIN_STREAM *) p->stream;
     int32_t chans = p->nChannels;
 
     if (offset || early) {
@@ -957,39 +1209,18 @@ int32_t diskin2_perf_asynchronous(CSOUND *csound, DISKIN2 *p)
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
-      for (chn = 0; chn < chans; chn++) {
-        //int32_t i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        p->aOut[chn][nn] = csound->e0dbfs*samp;
-      }
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    /* one block per k-cycle, then split into the channels */
+    diskin_stream_read(csound, st, nsmps - offset);
+    for (chn = 0; chn < chans; chn++) {
+      MYFLT *aOut = p->aOut[chn];
+      for (nn = offset, i = chn; nn < nsmps; nn++, i += chans)
+        aOut[nn] = csound->e0dbfs*st->blk[i];
     }
     return OK;
 }
 
 
-uintptr_t diskin_io_thread(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int32_t wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int32_t *start =
-      current->csound->QueryGlobalVariable(current->csound,"DISKIN_THREAD_START");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read(current->csound, current->diskin);
-        current = current->nxt;
-      }
-    }
-    return 0;
-}
-
-
 int32_t diskin2_perf(CSOUND *csound, DISKIN2 *p) {
     if (!p->async) return diskin2_perf_synchronous(csound, p);
     else return diskin2_perf_asynchronous(csound, p);
@@ -1190,12 +1421,18 @@ static CS_NOINLINE void diskin2_read_buffer_array(CSOUND *csound,
       if (nsmps > 0L) {         /* if there is anything to read: */
         if (nsmps > (int32_t) p->bufSize)
           nsmps = (int32_t) p->bufSize;
-        nsmps *= (int32_t) p->nChannels;
-        sf_seek(p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
-        /* convert sample count to mono samples and read file */
-        i = (int32_t)sf_read_MYFLT(p->sf, p->buf, (sf_count_t) nsmps);
-        if (UNLIKELY(i < 0))  /* error ? */
-          i = 0;    /* clear entire buffer to zero */
+        if (p->sndmap != NULL)          /* convert from the mapping */
+          i = (int32_t) csoundSndMapRead((SNDMAP *) p->sndmap, p->buf,
+                                         p->bufStartPos, nsmps, 0, FL(1.0))
+            * (int32_t) p->nChannels;
+        else {
+          nsmps *= (int32_t) p->nChannels;
+          sf_seek(p->sf, (sf_count_t) p->bufStartPos, SEEK_SET);
+          /* convert sample count to mono samples and read file */
+          i = (int32_t)sf_read_MYFLT(p->sf, p->buf, (sf_count_t) nsmps);
+          if (UNLIKELY(i < 0))  /* error ? */
+            i = 0;    /* clear entire buffer to zero */
+        }
       }
     }
     /* fill rest of buffer with zero samples */
@@ -1308,40 +1545,17 @@ static inline void diskin2_get_sample_array(CSOUND *csound,
     }
 }
 
-int32_t diskin2_async_deinit_array(CSOUND *csound,  void *p){
-
-    DISKIN_INST **top, *current, *prv;
-
-    if ((top = (DISKIN_INST **)
-         csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY")) == NULL)
-      return NOTOK;
-    current = *top;
-    prv = NULL;
-    while(current->diskin != (DISKIN2 *)p) {
-      prv = current;
-      current = current->nxt;
-    }
-    if (prv == NULL) *top = current->nxt;
-    else prv->nxt = current->nxt;
-
-#ifndef __EMSCRIPTEN__
-    if (*top == NULL) {
-      int32_t *start; void **pt;
-      start = (int32_t *) csound->QueryGlobalVariable(csound,
-                                                  "DISKIN_THREAD_START_ARRAY");
-      *start = 0;
-      pt = csound->QueryGlobalVariable(csound,"DISKIN_PTHREAD_ARRAY");
-      //csound->Message(csound, "dealloc %p %d\n", start, *start);
-      csound->JoinThread(*pt);
-      csound->DestroyGlobalVariable(csound, "DISKIN_PTHREAD_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_THREAD_START_ARRAY");
-      csound->DestroyGlobalVariable(csound, "DISKIN_INST_ARRAY");
-    }
-#endif
-
-    csound->Free(csound, current);
-    csound->DestroyCircularBuffer(csound, ((DISKIN2_ARRAY *)p)->cb);
+int32_t diskin2_deinit_array(CSOUND *csound,  void *p){
+    DISKIN2_ARRAY *pp = (DISKIN2_ARRAY *) p;
 
+    if (pp->stream != NULL) {   /* NULL if already stopped for a reinit */
+      diskin_stream_remove(csound, (DISKIN_STREAM *) pp->stream);
+      pp->stream = NULL;
+    }
+    if (pp->sndmap != NULL) {   /* after the I/O threads are done with it */
+      csoundSndMapClose(csound, (SNDMAP *) pp->sndmap);
+      pp->sndmap = NULL;
+    }
     return OK;
 }
 
@@ -1520,41 +1734,12 @@ int32_t diskin_file_read_array(CSOUND *csound, DISKIN2_ARRAY *p)
         diskin2_file_pos_inc_array(p, &ndx);
       }
     }
-    {
-      /* write to circular buffer */
-      int32_t lc, mc=0, nc=nsmps*p->nChannels;
-      int32_t *start = csound->QueryGlobalVariable(csound,"DISKIN_THREAD_START");
-      do{
-        lc = csound->WriteCircularBuffer(csound, p->cb, &aOut[mc], nc);
-        nc -= lc;
-        mc += lc;
-      } while(nc && *start);
-    }
     return OK;
  file_error:
     csound->ErrorMsg(csound, Str("diskin2: file descriptor closed or invalid\n"));
     return NOTOK;
 }
 
-uintptr_t diskin_io_thread_array(void *p){
-    DISKIN_INST *current = (DISKIN_INST *) p;
-    int32_t wakeup = 1000*current->csound->ksmps/current->csound->esr;
-    int32_t *start =
-      current->csound->QueryGlobalVariable(current->csound,
-                                           "DISKIN_THREAD_START_ARRAY");
-    _MM_SET_DENORMALS_ZERO_MODE(_MM_DENORMALS_ZERO_ON);
-    while(*start){
-      current = (DISKIN_INST *) p;
-      csoundSleep(wakeup > 0 ? wakeup : 1);
-      while(current != NULL){
-        diskin_file_read_array(current->csound, (DISKIN2_ARRAY *)current->diskin);
-        current = current->nxt;
-      }
-    }
-    return 0;
-}
-
-
 static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
                                   int32_t stringname)
 {
@@ -1570,6 +1755,14 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
       /* skip initialisation if requested */
       if (p->SkipInit != FL(0.0))
         return OK;
+      if (p->stream != NULL) {          /* stop reading it first */
+        diskin_stream_remove(csound, (DISKIN_STREAM *) p->stream);
+        p->stream = NULL;
+      }
+      if (p->sndmap != NULL) {
+        csoundSndMapClose(csound, (SNDMAP *) p->sndmap);
+        p->sndmap = NULL;
+      }
       fd_close(csound, &(p->fdch));
     }
     // to handle raw files number of channels
@@ -1693,16 +1886,17 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
 
     memset(p->buf, 0, n*sizeof(MYFLT));
 
-    // create circular buffer, on fail set mode to synchronous
-    if (csound->oparms->realtime==1 && p->fforceSync==0 &&
-        (p->cb = csound->CreateCircularBuffer(csound,
-                                              p->bufSize*p->nChannels*2,
-                                              sizeof(MYFLT))) != NULL){
-      DISKIN_INST **top, *current;
-#ifndef __EMSCRIPTEN__
-      int32_t *start;
-#endif
-      // allocate buffer
+    /* with --mmap-soundfiles, convert the samples straight from memory */
+    if (csound->oparms->sndMap)
+      p->sndmap = csoundSndMapOpen(csound, csound->GetFileName(fd),
+                                   &sfinfo, 0);
+    /* done initialisation: the I/O threads start reading as soon as
+       the stream is added */
+    p->initDone = 1;
+    // in realtime mode read on the shared I/O threads, if possible
+    p->async = 0;
+    if (csound->oparms->realtime==1 && p->fforceSync==0) {
+      // one chunk of output, at least a k-cycle
       p->aOut_bufsize =
         ((unsigned int)p->bufSize) < CS_KSMPS ?
         ((MYFLT)CS_KSMPS) : ((MYFLT)p->bufSize);
@@ -1711,54 +1905,18 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
         csound->AuxAlloc(csound, (int32_t) n, &(p->auxData2));
       p->aOut_buf = (MYFLT *) (p->auxData2.auxp);
       memset(p->aOut_buf, 0, n);
-      top =
-        (DISKIN_INST **)csound->QueryGlobalVariable(csound, "DISKIN_INST_ARRAY");
-#ifndef __EMSCRIPTEN__
-      if (top == NULL){
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_INST_ARRAY", sizeof(DISKIN_INST *));
-        top = (DISKIN_INST **) csound->QueryGlobalVariable(csound,
-                                                           "DISKIN_INST_ARRAY");
-        *top = (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_PTHREAD_ARRAY", sizeof(void**));
-        csound->CreateGlobalVariable(csound,
-                                     "DISKIN_THREAD_START_ARRAY", sizeof(int32_t));
-        current = *top;
-      }
-      else
-#endif
-        {
-          current = *top;
-          while(current->nxt != NULL) { /* find next empty slot in chain */
-            current = current->nxt;
-          }
-          current->nxt =
-            (DISKIN_INST *) csound->Calloc(csound, sizeof(DISKIN_INST));
-          current = current->nxt;
-        }
-      current->csound = csound;
-      current->diskin =  (DISKIN2 *) p;
-      current->nxt = NULL;
-
-#ifndef __EMSCRIPTEN__
-      if (*(start =
-            csound->QueryGlobalVariable(csound,
-                                        "DISKIN_THREAD_START_ARRAY")) == 0) {
-        uintptr_t diskin_io_thread_array(void *p);
-        // TOFIX: this variable (thread) is not referenced
-        #if 0
-        void **thread = csound->QueryGlobalVariable(csound,
-                                                       "DISKIN_PTHREAD_ARRAY");
-        #endif
-        *start = 1;
-        csound->CreateThread(diskin_io_thread_array, *top);
-      }
-#endif
-      csound->RegisterDeinitCallback(csound, (DISKIN2 *) p,
-                                     diskin2_async_deinit_array);
-      p->async = 1;
-
+      p->stream =
+        diskin_stream_add(csound, p,
+                          (int32_t (*)(CSOUND *, void *)) diskin_file_read_array,
+                          p->aOut_buf, (int32_t) p->aOut_bufsize,
+                          p->nChannels, &p->pos_frac_inc,
+                          csound->GetFileName(fd));
+      if (p->stream != NULL)
+        p->async = 1;
+    }
+    if (p->stream != NULL || p->sndmap != NULL)
+      csound->RegisterDeinitCallback(csound, p, diskin2_deinit_array);
+    if (p->async) {
       /* print file information */
       if (UNLIKELY((csound->oparms_.msglevel & 7) == 7)) {
         csound->Message(csound, "%s '%s':\n"
@@ -1788,8 +1946,6 @@ static int32_t diskin2_init_array(CSOUND *csound, DISKIN2_ARRAY *p,
       }
     }
 
-    /* done initialisation */
-    p->initDone = 1;
     return OK;
 }
 
@@ -1987,10 +2143,9 @@ int32_t diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t nn, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
-    MYFLT samp;
+    uint32_t nn, i, nsmps = CS_KSMPS, ksmps = CS_KSMPS;
     int32_t chn;
-    void *cb = p->cb;
+    DISKIN_STREAM *st = (DISKIN_STREAM *) p->stream;
     int32_t chans = p->nChannels;
     MYFLT *aOut = (MYFLT *) p->aOut->data;
 
@@ -2006,17 +2161,11 @@ int32_t diskin2_perf_asynchronous_array(CSOUND *csound, DISKIN2_ARRAY *p)
       return csound->PerfError(csound, &(p->h),
                                Str("diskin2: not initialised"));
     }
-    for (nn = offset; nn < nsmps; nn++){
-
-      for (chn = 0; chn < chans; chn++) {
-        //int32_t i =0;
-        //do {
-        // i =
-        csound->ReadCircularBuffer(csound, cb, &samp, 1);
-        //} while(i==0);
-        aOut[chn*ksmps+nn] = csound->e0dbfs*samp;
-      }
-    }
+    if (UNLIKELY(offset >= nsmps)) return OK;
+    diskin_stream_read(csound, st, nsmps - offset);
+    for (chn = 0; chn < chans; chn++)
+      for (nn = offset, i = chn; nn < nsmps; nn++, i += chans)
+        aOut[chn*ksmps+nn] = csound->e0dbfs*st->blk[i];
     return OK;
 }
 
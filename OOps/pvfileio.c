@@ -321,16 +321,30 @@ int32_t init_pvsys(CSOUND *csound)
     return 1;
 }
 
+/* the file table is locked, as pvsfwrite closes its file on the
+   reclaimer thread (--reclaim-thread) */
+
 static inline PVOCFILE *pvsys_getFileHandle(CSOUND *csound, int fd)
 {
-    if (UNLIKELY(fd < 0 || fd >= csound->pvNumFiles))
-      return (PVOCFILE*) NULL;
-    return (PVFILETABLE[fd]);
+    PVOCFILE  *p = (PVOCFILE*) NULL;
+    csoundSpinLock(&csound->pvfiles_lock);
+    if (LIKELY(fd >= 0 && fd < csound->pvNumFiles))
+      p = PVFILETABLE[fd];
+    csoundSpinUnLock(&csound->pvfiles_lock);
+    return p;
+}
+
+static void pvsys_releaseFileHandle(CSOUND *csound, int fd)
+{
+    csoundSpinLock(&csound->pvfiles_lock);
+    PVFILETABLE[fd] = NULL;
+    csoundSpinUnLock(&csound->pvfiles_lock);
 }
 
 static int pvsys_createFileHandle(CSOUND *csound)
 {
     int32_t i;
+    csoundSpinLock(&csound->pvfiles_lock);
     for (i = 0; i < csound->pvNumFiles; i++) {
       if (PVFILETABLE[i] == NULL)
         break;
@@ -349,8 +363,10 @@ static int pvsys_createFileHandle(CSOUND *csound)
         tmp = (PVOCFILE**) csound->ReAlloc(csound, csound->pvFileTable,
                                            sizeof(PVOCFILE*) * csound->pvNumFiles);
       }
-      if (tmp == NULL)
+      if (tmp == NULL) {
+        csoundSpinUnLock(&csound->pvfiles_lock);
         return -1;
+      }
       csound->pvFileTable = (void*) tmp;
       for ( ; j < csound->pvNumFiles; j++)
         PVFILETABLE[j] = (PVOCFILE*) NULL;
@@ -358,8 +374,10 @@ static int pvsys_createFileHandle(CSOUND *csound)
     /* allocate new handle */
     PVFILETABLE[i] = (PVOCFILE*) csound->Malloc(csound, sizeof(PVOCFILE));
     if (PVFILETABLE[i] == NULL)
-      return -1;
-    memset(PVFILETABLE[i], 0, sizeof(PVOCFILE));
+      i = -1;
+    else
+      memset(PVFILETABLE[i], 0, sizeof(PVOCFILE));
+    csoundSpinUnLock(&csound->pvfiles_lock);
     return i;
 }
 
@@ -488,7 +506,7 @@ int32_t  pvoc_createfile(CSOUND *csound, const char *filename,
       if (p->customWindow)
         csound->Free(csound, p->customWindow);
       csound->Free(csound, p);
-      PVFILETABLE[fd] = NULL;
+      pvsys_releaseFileHandle(csound, fd);
       csound->pvErrorCode = -7;
       return -1;
     }
@@ -501,7 +519,7 @@ int32_t  pvoc_createfile(CSOUND *csound, const char *filename,
       if (p->customWindow)
         csound->Free(csound, p->customWindow);
       csound->Free(csound, p);
-      PVFILETABLE[fd] = NULL;
+      pvsys_releaseFileHandle(csound, fd);
       return -1;
     }
 
@@ -537,7 +555,7 @@ int32_t pvoc_openfile(CSOUND *csound,
     if (UNLIKELY(p->fd == NULL)) {
       csound->pvErrorCode = -9;
       csound->Free(csound, p);
-      PVFILETABLE[fd] = NULL;
+      pvsys_releaseFileHandle(csound, fd);
       return -1;
     }
     pname = (char*) csound->Malloc(csound, strlen(filename) + 1);
@@ -551,7 +569,7 @@ int32_t pvoc_openfile(CSOUND *csound,
       if (p->customWindow)
         csound->Free(csound, p->customWindow);
       csound->Free(csound, p);
-      PVFILETABLE[fd] = NULL;
+      pvsys_releaseFileHandle(csound, fd);
       return -1;
     }
     memcpy(data, &(wfpx.data), sizeof(PVOCDATA));
@@ -865,7 +883,7 @@ int32_t pvoc_closefile(CSOUND *csound, int32_t ofd)
     if (UNLIKELY(p->fd == NULL)) {
       csound->pvErrorCode = -37;
       csound->Free(csound, p);
-      PVFILETABLE[ofd] = NULL;
+      pvsys_releaseFileHandle(csound, ofd);
       return 0;
     }
     if (!p->readonly)
@@ -878,7 +896,7 @@ int32_t pvoc_closefile(CSOUND *csound, int32_t ofd)
     csound->Free(csound, p->name);
     csound->Free(csound, p->customWindow);
     csound->Free(csound, p);
-    PVFILETABLE[ofd] = NULL;
+    pvsys_releaseFileHandle(csound, ofd);
 
     return rc;
 }
@@ -236,6 +236,22 @@ int32_t klnseg(CSOUND *csound, LINSEG *p)
     return csound->InitError(csound, Str("linseg not initialised (krate)\n"));
 }
 
+/* klnseg for n instances at once (--multi-instance): notes inside a
+   segment just step, the others take the general path */
+int32_t klnseg_multi(CSOUND *csound, void **pp, int32_t n)
+{
+    while (n-- > 0) {
+      LINSEG *p = (LINSEG *) *pp++;
+      if (LIKELY(p->segsrem && p->curcnt > 10 && p->auxch.auxp != NULL)) {
+        *p->rslt = p->curval;
+        p->curcnt--;
+        p->curval += p->curinc;
+      }
+      else klnseg(csound, p);
+    }
+    return OK;
+}
+
 int32_t linseg(CSOUND *csound, LINSEG *p)
 {
     double val, ainc;
@@ -290,6 +306,43 @@ int32_t linseg(CSOUND *csound, LINSEG *p)
                              Str("linseg: not initialised (arate)\n"));
 }
 
+/* linseg for n instances at once (--multi-instance).  Notes with no
+   segment boundary in this period are stepped together, one sample of
+   every note at a time; the others take the general path. */
+int32_t linseg_multi(CSOUND *csound, void **pp, int32_t n)
+{
+    LINSEG   *lp[MULTI_LANES];
+    MYFLT    *rs[MULTI_LANES];
+    double   val[MULTI_LANES], ainc[MULTI_LANES];
+    uint32_t i, nsmps = csound->ksmps;
+    int32_t  j, m;
+
+    while (n > 0) {
+      for (m = 0; n > 0 && m < MULTI_LANES; n--) {
+        LINSEG *p = (LINSEG *) *pp++;
+        if (UNLIKELY(p->auxch.auxp == NULL || !p->segsrem ||
+                     p->curcnt <= (int32) nsmps || p->curainc == 0.0)) {
+          linseg(csound, p);
+          continue;
+        }
+        lp[m] = p;
+        rs[m] = p->rslt;
+        val[m] = p->curval;
+        ainc[m++] = p->curainc;
+      }
+      for (i = 0; i < nsmps; i++)
+        for (j = 0; j < m; j++) {
+          rs[j][i] = (MYFLT) val[j];
+          val[j] += ainc[j];
+        }
+      for (j = 0; j < m; j++) {
+        lp[j]->curval = val[j];
+        lp[j]->curcnt -= nsmps;
+      }
+    }
+    return OK;
+}
+
 /* **** ADSR is just a construction and use of linseg */
 
 #define MAXSEGDUR (INT_MAX/CS_ESR)
@@ -1420,6 +1420,52 @@ int32_t osckki(CSOUND *csound, OSC   *p)
                              Str("oscili: not initialised"));
 }
 
+/* osckki for n instances at once (--multi-instance): the phase state
+   of up to MULTI_LANES notes is held in arrays and the notes advance
+   together, one sample of every note at a time */
+int32_t osckki_multi(CSOUND *csound, void **pp, int32_t n)
+{
+    OSC      *op[MULTI_LANES];
+    MYFLT    *ar[MULTI_LANES], *ft[MULTI_LANES];
+    MYFLT    amp[MULTI_LANES], lodiv[MULTI_LANES];
+    int32_t  phs[MULTI_LANES], inc[MULTI_LANES];
+    int32_t  lobits[MULTI_LANES], lomask[MULTI_LANES];
+    uint32_t i, nsmps = csound->ksmps;
+    int32_t  j, m;
+
+    while (n > 0) {
+      for (m = 0; n > 0 && m < MULTI_LANES; n--) {
+        OSC  *p = (OSC *) *pp++;
+        FUNC *ftp = p->ftp;
+        if (UNLIKELY(ftp == NULL)) {
+          osckki(csound, p);                /* reports the error */
+          continue;
+        }
+        op[m] = p;
+        ar[m] = p->sr;
+        ft[m] = ftp->ftable;
+        amp[m] = *p->xamp;
+        lodiv[m] = ftp->lodiv;
+        lobits[m] = ftp->lobits;
+        lomask[m] = ftp->lomask;
+        phs[m] = p->lphs;
+        inc[m++] = MYFLT2LONG(*p->xcps * csound->sicvt);
+      }
+      for (i = 0; i < nsmps; i++)
+        for (j = 0; j < m; j++) {
+          int32_t x = phs[j];
+          MYFLT   fract = (MYFLT) (x & lomask[j]) * lodiv[j];
+          MYFLT   *ftab = ft[j] + (x >> lobits[j]);
+          MYFLT   v1 = ftab[0];
+          ar[j][i] = (v1 + (ftab[1] - v1) * fract) * amp[j];
+          phs[j] = (x + inc[j]) & PHMASK;
+        }
+      for (j = 0; j < m; j++)
+        op[j]->lphs = phs[j];
+    }
+    return OK;
+}
+
 int32_t osckai(CSOUND *csound, OSC   *p)
 {
     FUNC    *ftp;
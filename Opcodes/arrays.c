@@ -24,6 +24,7 @@
 #include "csoundCore.h"
 #include "interlocks.h"
 #include "aops.h"
+#include "aops_kernels.h"
 #include "find_opcode.h"
 
 extern MYFLT MOD(MYFLT a, MYFLT bb);
@@ -959,7 +960,7 @@ static int32_t tabaadd(CSOUND *csound, TABARITH *p)
     int32_t size    = ans->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS;
+    int32_t i, nsmps = CS_KSMPS;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -980,8 +981,9 @@ static int32_t tabaadd(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] + b[n];
+      if (LIKELY(offset < (uint32_t) nsmps))
+        csound_aop_kernels->vv[AOPK_ADD](&aa[offset], &a[offset], &b[offset],
+                                         nsmps-offset);
     }
     return OK;
 }
@@ -995,7 +997,7 @@ static int32_t tabasub(CSOUND *csound, TABARITH *p)
     int32_t size    = ans->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -1013,8 +1015,9 @@ static int32_t tabasub(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] - b[n];
+      if (LIKELY(offset < (uint32_t) nsmps))
+        csound_aop_kernels->vv[AOPK_SUB](&aa[offset], &a[offset], &b[offset],
+                                         nsmps-offset);
     }
     return OK;
 }
@@ -1028,7 +1031,7 @@ static int32_t tabamul(CSOUND *csound, TABARITH *p)
     int32_t size    = ans->sizes[0];
     uint32_t offset = p->h.insdshead->ksmps_offset;
     uint32_t early  = p->h.insdshead->ksmps_no_end;
-    int32_t i, n, nsmps = CS_KSMPS-early;
+    int32_t i, nsmps = CS_KSMPS-early;
     int32_t span = (ans->arrayMemberSize)/sizeof(MYFLT);
 
     if (UNLIKELY(ans->data == NULL || l->data==NULL || r->data==NULL))
@@ -1046,8 +1049,9 @@ static int32_t tabamul(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++)
-        aa[n] = a[n] * b[n];
+      if (LIKELY(offset < (uint32_t) nsmps))
+        csound_aop_kernels->vv[AOPK_MUL](&aa[offset], &a[offset], &b[offset],
+                                         nsmps-offset);
     }
     return OK;
 }
@@ -1079,13 +1083,14 @@ static int32_t tabadiv(CSOUND *csound, TABARITH *p)
       if (UNLIKELY(early)) {
         memset(&aa[nsmps], '\0', early*sizeof(MYFLT));
       }
-      for (n=offset; n<nsmps; n++) {
+      for (n=offset; n<nsmps; n++)
         if (UNLIKELY(b[n]==FL(0.0)))
           return csound->PerfError(csound, &(p->h),
                                   Str("division by zero in array-var "
                                       "at index %d/%d"), i,n);
-        aa[n] = a[n] / b[n];
-      }
+      if (LIKELY(offset < (uint32_t) nsmps))
+        csound_aop_kernels->vv[AOPK_DIV](&aa[offset], &a[offset], &b[offset],
+                                         nsmps-offset);
     }
     return OK;
 }
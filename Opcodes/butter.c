@@ -93,6 +93,19 @@ static int32_t hibut(CSOUND *csound, BFIL *p)       /*      Hipass filter
     return OK;
 }
 
+static void lobut_coefs(CSOUND *csound, BFIL *p)
+{
+    double     *a, c;
+    a = p->a;
+    p->lkf = *p->kfc;
+    c = 1.0 / tan((double)(csound->pidsr * p->lkf));
+    a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
+    a[2] = a[1] + a[1];
+    a[3] = a[1];
+    a[4] = 2.0 * ( 1.0 - c*c) * a[1];
+    a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
+}
+
 static int32_t lobut(CSOUND *csound, BFIL *p)       /*      Lopass filter       */
 {
     MYFLT       *out, *in;
@@ -114,22 +127,60 @@ static int32_t lobut(CSOUND *csound, BFIL *p)       /*      Lopass filter
       memset(&out[nsmps], '\0', early*sizeof(MYFLT));
     }
 
-    if (*p->kfc != p->lkf) {
-      double     *a, c;
-      a = p->a;
-      p->lkf = *p->kfc;
-      c = 1.0 / tan((double)(csound->pidsr * p->lkf));
-      a[1] = 1.0 / ( 1.0 + ROOT2 * c + c * c);
-      a[2] = a[1] + a[1];
-      a[3] = a[1];
-      a[4] = 2.0 * ( 1.0 - c*c) * a[1];
-      a[5] = ( 1.0 - ROOT2 * c + c * c) * a[1];
-    }
+    if (*p->kfc != p->lkf)
+      lobut_coefs(csound, p);
 
     butter_filter(nsmps, offset, in, out, p->a);
     return OK;
 }
 
+/* lobut for n instances at once (--multi-instance): the coefficients
+   and state of up to MULTI_LANES notes are held in arrays and the
+   notes are filtered together, one sample of every note at a time */
+static int32_t lobut_multi(CSOUND *csound, void **pp, int32_t n)
+{
+    BFIL     *bp[MULTI_LANES];
+    MYFLT    *in[MULTI_LANES], *out[MULTI_LANES];
+    double   a1[MULTI_LANES], a2[MULTI_LANES], a3[MULTI_LANES];
+    double   a4[MULTI_LANES], a5[MULTI_LANES];
+    double   a6[MULTI_LANES], a7[MULTI_LANES];
+    uint32_t nn, nsmps = csound->ksmps;
+    int32_t  j, m;
+
+    while (n > 0) {
+      for (m = 0; n > 0 && m < MULTI_LANES; n--) {
+        BFIL *p = (BFIL *) *pp++;
+        if (UNLIKELY(*p->kfc <= FL(0.0))) {
+          lobut(csound, p);
+          continue;
+        }
+        if (*p->kfc != p->lkf)
+          lobut_coefs(csound, p);
+        bp[m] = p;
+        in[m] = p->ain;
+        out[m] = p->sr;
+        a1[m] = p->a[1]; a2[m] = p->a[2]; a3[m] = p->a[3];
+        a4[m] = p->a[4]; a5[m] = p->a[5];
+        a6[m] = p->a[6]; a7[m++] = p->a[7];
+      }
+      for (nn = 0; nn < nsmps; nn++)
+        for (j = 0; j < m; j++) {
+          double t, y;
+          t = (double)in[j][nn] - a4[j] * a6[j] - a5[j] * a7[j];
+          t = csoundUndenormalizeDouble(t);
+          y = t * a1[j] + a2[j] * a6[j] + a3[j] * a7[j];
+          a7[j] = a6[j];
+          a6[j] = t;
+          out[j][nn] = (MYFLT)y;
+        }
+      for (j = 0; j < m; j++) {
+        bp[j]->a[6] = a6[j];
+        bp[j]->a[7] = a7[j];
+      }
+    }
+    return OK;
+}
+
 /* Filter loop */
 
 static void butter_filter(uint32_t n, uint32_t offset,
@@ -152,9 +203,11 @@ static void butter_filter(uint32_t n, uint32_t offset,
 
 static OENTRY localops[] = {
 { "butterhp.k", S(BFIL), 0, 3, "a",    "ako",  (SUBR)butset,   (SUBR)hibut  },
-{ "butterlp.k", S(BFIL), 0, 3, "a",    "ako",  (SUBR)butset,   (SUBR)lobut  },
+{ "butterlp.k", S(BFIL), 0, 3, "a",    "ako",  (SUBR)butset,   (SUBR)lobut,
+  NULL, NULL, (MSUBR)lobut_multi },
 { "buthp.k",    S(BFIL),  0, 3, "a",   "ako",  (SUBR)butset,   (SUBR)hibut  },
-{ "butlp.k",    S(BFIL),  0, 3, "a",   "ako",  (SUBR)butset,   (SUBR)lobut  },
+{ "butlp.k",    S(BFIL),  0, 3, "a",   "ako",  (SUBR)butset,   (SUBR)lobut,
+  NULL, NULL, (MSUBR)lobut_multi },
 };
 
 int32_t butter_init_(CSOUND *csound)
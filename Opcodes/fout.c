@@ -33,8 +33,9 @@
 #include <ctype.h>
 
 /* remove a file reference, optionally closing the file */
+/* call with file_lock held */
 
-static CS_NOINLINE int32_t fout_deinit_callback(CSOUND *csound, void *p_)
+static CS_NOINLINE int32_t fout_release_file(CSOUND *csound, void *p_)
 {
     FOUT_FILE         *p = (FOUT_FILE*) p_;
     struct fileinTag  *pp;
@@ -69,10 +70,21 @@ static CS_NOINLINE int32_t fout_deinit_callback(CSOUND *csound, void *p_)
     return OK;
 }
 
-static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp,
-                                          int32_t fileType, MYFLT *iFile,
-                                          int32_t isString,
-                                          void *fileParams, int32_t forceSync)
+static int32_t fout_deinit_callback(CSOUND *csound, void *p_)
+{
+    STDOPCOD_GLOBALS  *pp = (STDOPCOD_GLOBALS*) csound->stdOp_Env;
+    int32_t           retval;
+
+    csoundSpinLock(&pp->file_lock);
+    retval = fout_release_file(csound, p_);
+    csoundSpinUnLock(&pp->file_lock);
+    return retval;
+}
+
+static CS_NOINLINE int32_t fout_open_file_(CSOUND *csound, FOUT_FILE *p,
+                                           void *fp, int32_t fileType,
+                                           MYFLT *iFile, int32_t isString,
+                                           void *fileParams, int32_t forceSync)
 {
     STDOPCOD_GLOBALS  *pp = (STDOPCOD_GLOBALS*) csound->stdOp_Env;
     char              *name;
@@ -88,7 +100,7 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
     /* if the opcode already uses a file, remove old reference first */
     if (p != (FOUT_FILE*) NULL) {
       if (p->idx)
-        fout_deinit_callback(csound, (void*) p);
+        fout_release_file(csound, (void*) p);
       else
         need_deinit = 1;
     }
@@ -273,6 +285,36 @@ static CS_NOINLINE int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp
     return idx;
 }
 
+static int32_t fout_open_file(CSOUND *csound, FOUT_FILE *p, void *fp,
+                              int32_t fileType, MYFLT *iFile, int32_t isString,
+                              void *fileParams, int32_t forceSync)
+{
+    STDOPCOD_GLOBALS  *pp = (STDOPCOD_GLOBALS*) csound->stdOp_Env;
+    int32_t           idx;
+
+    csoundSpinLock(&pp->file_lock);
+    idx = fout_open_file_(csound, p, fp, fileType, iFile, isString,
+                          fileParams, forceSync);
+    csoundSpinUnLock(&pp->file_lock);
+    return idx;
+}
+
+/* write to a sound file that may be shared with other instances, whose
+   flush callbacks can run on the reclaimer thread */
+
+static void fout_write_file(CSOUND *csound, FOUT_FILE *f,
+                            MYFLT *buf, int32_t n)
+{
+    STDOPCOD_GLOBALS  *pp = (STDOPCOD_GLOBALS*) csound->stdOp_Env;
+
+    csoundSpinLock(&pp->file_lock);
+    if (f->async == 1)
+      csound->WriteAsync(csound, f->fd, buf, n);
+    else
+      sf_write_MYFLT(f->sf, buf, n);
+    csoundSpinUnLock(&pp->file_lock);
+}
+
 static int32_t outfile(CSOUND *csound, OUTFILE *p)
 {
     uint32_t offset = p->h.insdshead->ksmps_offset;
@@ -304,9 +346,7 @@ static int32_t outfile(CSOUND *csound, OUTFILE *p)
         //#else
         //sf_write_double(p->f.sf, buf, p->buf_pos);
         //#endif
-        if (p->f.async==1)
-          csound->WriteAsync(csound, p->f.fd, buf, p->buf_pos);
-        else sf_write_MYFLT(p->f.sf, buf, p->buf_pos);
+        fout_write_file(csound, &(p->f), buf, p->buf_pos);
         p->buf_pos = 0;
       }
 
@@ -346,10 +386,7 @@ static int32_t outfile_array(CSOUND *csound, OUTFILEA *p)
         //#else
         //sf_write_double(p->f.sf, buf, p->buf_pos);
         //#endif
-        if (p->f.async==1)
-          csound->WriteAsync(csound, p->f.fd, buf, p->buf_pos);
-        else
-          sf_write_MYFLT(p->f.sf, buf, p->buf_pos);
+        fout_write_file(csound, &(p->f), buf, p->buf_pos);
         p->buf_pos = 0;
        }
 
@@ -400,10 +437,7 @@ static int32_t fout_flush_callback(CSOUND *csound, void *p_)
       //#else
       //sf_write_double(p->f.sf, (double*) p->buf.auxp, p->buf_pos);
       //#endif
-      if (p->f.async == 1)
-        csound->WriteAsync(csound, p->f.fd, (MYFLT *) p->buf.auxp, p->buf_pos);
-      else
-        sf_write_MYFLT(p->f.sf, (MYFLT *) p->buf.auxp, p->buf_pos);
+      fout_write_file(csound, &(p->f), (MYFLT *) p->buf.auxp, p->buf_pos);
     }
     return OK;
 }
@@ -418,10 +452,7 @@ static int32_t fouta_flush_callback(CSOUND *csound, void *p_)
       //#else
       //sf_write_double(p->f.sf, (double*) p->buf.auxp, p->buf_pos);
       //#endif
-      if (p->f.async == 1)
-        csound->WriteAsync(csound, p->f.fd, (MYFLT *) p->buf.auxp, p->buf_pos);
-      else
-        sf_write_MYFLT(p->f.sf, (MYFLT *) p->buf.auxp, p->buf_pos);
+      fout_write_file(csound, &(p->f), (MYFLT *) p->buf.auxp, p->buf_pos);
     }
     return OK;
 }
@@ -551,9 +582,7 @@ static int32_t koutfile(CSOUND *csound, KOUTFILE *p)
         //#else
         //sf_write_double(p->f.sf, buf, p->buf_pos);
         //#endif
-      if (p->f.async==1)
-        csound->WriteAsync(csound, p->f.fd, buf, p->buf_pos);
-      else sf_write_MYFLT(p->f.sf, buf, p->buf_pos);
+      fout_write_file(csound, &(p->f), buf, p->buf_pos);
       p->buf_pos = 0;
     }
     return OK;
@@ -685,6 +714,7 @@ static int32_t ficlose_opcode_(CSOUND *csound, FICLOSE *p, int32_t istring)
         return OK;
       }
     }
+    csoundSpinLock(&pp->file_lock);
     if (pp->file_opened[idx].refCount) {
       if (UNLIKELY(!(pp->file_opened[idx].refCount & 0x80000000U))) {
         pp->file_opened[idx].refCount |= 0x80000000U;
@@ -700,8 +730,9 @@ static int32_t ficlose_opcode_(CSOUND *csound, FICLOSE *p, int32_t istring)
       memset(&tmp, 0, sizeof(FOUT_FILE));
       tmp.h.insdshead = p->h.insdshead;
       tmp.idx = idx + 1;
-      fout_deinit_callback(csound, (void*) &tmp);
+      fout_release_file(csound, (void*) &tmp);
     }
+    csoundSpinUnLock(&pp->file_lock);
 
     return OK;
 }
@@ -1566,31 +1597,31 @@ static int32_t fprintf_i_S(CSOUND *csound, FPRINTF *p)
 #define S(x)    sizeof(x)
 static OENTRY localops[] = {
 
-    {"fprints",    S(FPRINTF),      0, 1,  "",     "SSM",
+    {"fprints",    S(FPRINTF),      TD, 1,  "",     "SSM",
         (SUBR) fprintf_i_S, (SUBR) NULL,(SUBR) NULL, NULL, },
-    {"fprints.i",    S(FPRINTF),      0, 1,  "",     "iSM",
+    {"fprints.i",    S(FPRINTF),      TD, 1,  "",     "iSM",
         (SUBR) fprintf_i, (SUBR) NULL,(SUBR) NULL, NULL},
-    { "fprintks",   S(FPRINTF),    WR, 3,  "",     "SSM",
+    { "fprintks",   S(FPRINTF),    WR|TD, 3,  "",     "SSM",
         (SUBR) fprintf_set_S,     (SUBR) fprintf_k,   (SUBR) NULL, NULL,},
-    { "fprintks.i",   S(FPRINTF),    WR, 3,  "",     "iSM",
+    { "fprintks.i",   S(FPRINTF),    WR|TD, 3,  "",     "iSM",
         (SUBR) fprintf_set,     (SUBR) fprintf_k,   (SUBR) NULL, NULL},
      { "vincr",      S(INCR),       WI, 2,  "",     "aa",
         (SUBR) NULL,            (SUBR) incr, NULL         },
     { "clear",      S(CLEARS),      WI, 2,  "",     "y",
         (SUBR) NULL,            (SUBR) clear, NULL},
-    { "fout",       S(OUTFILE),     0, 3,  "",     "Siy",
+    { "fout",       S(OUTFILE),     TD, 3,  "",     "Siy",
         (SUBR) outfile_set_S,     (SUBR) outfile, NULL},
-    { "fout.A",     S(OUTFILEA),    0, 3,  "",     "Sia[]",
+    { "fout.A",     S(OUTFILEA),    TD, 3,  "",     "Sia[]",
         (SUBR) outfile_set_A,     (SUBR) outfile_array, NULL},
     /* { "fout.i",       S(OUTFILE),     0, 3,  "",     "iiy", */
     /*     (SUBR) outfile_set,     (SUBR) outfile, NULL}, */
-    { "foutk",      S(KOUTFILE),    0, 3,  "",     "Siz",
+    { "foutk",      S(KOUTFILE),    TD, 3,  "",     "Siz",
         (SUBR) koutfile_set_S,    (SUBR) koutfile,    (SUBR) NULL, NULL },
-    { "foutk.i",      S(KOUTFILE),    0, 3,  "",     "iiz",
+    { "foutk.i",      S(KOUTFILE),    TD, 3,  "",     "iiz",
         (SUBR) koutfile_set,    (SUBR) koutfile,    (SUBR) NULL, NULL },
-    { "fouti",      S(IOUTFILE),    0, 1,  "",     "iiim",
+    { "fouti",      S(IOUTFILE),    TD, 1,  "",     "iiim",
         (SUBR) ioutfile_set,    (SUBR) NULL,        (SUBR) NULL, NULL         },
-    { "foutir",     S(IOUTFILE_R),  0, 3,  "",     "iiim",
+    { "foutir",     S(IOUTFILE_R),  TD, 3,  "",     "iiim",
         (SUBR) ioutfile_set_r,  (SUBR) ioutfile_r,  (SUBR) NULL, NULL},
     { "fiopen",     S(FIOPEN),      0, 1,  "i",    "Si",
         (SUBR) fiopen_S,          (SUBR) NULL,        (SUBR) NULL, NULL},
@@ -1600,19 +1631,19 @@ static OENTRY localops[] = {
         (SUBR) ficlose_opcode_S,  (SUBR) NULL,        (SUBR) NULL, NULL},
     { "ficlose.S",  S(FICLOSE),     0, 1,  "",     "i",
         (SUBR) ficlose_opcode,  (SUBR) NULL,        (SUBR) NULL, NULL },
-    { "fin.a",      S(INFILE),     WI, 3,  "",      "Siiy",
+    { "fin.a",      S(INFILE),     WI|TD, 3,  "",      "Siiy",
         (SUBR) infile_set_S,    (SUBR) infile_act, NULL},
-    { "fin.A",      S(INFILEA),    WI, 3,  "",     "Siia[]",
+    { "fin.A",      S(INFILEA),    WI|TD, 3,  "",     "Siia[]",
         (SUBR) infile_set_A,    (SUBR) infile_arr, NULL},
-    { "fin.i",      S(INFILE),     WI, 3,  "",     "iiiy",
+    { "fin.i",      S(INFILE),     WI|TD, 3,  "",     "iiiy",
         (SUBR) infile_set,      (SUBR) infile_act, NULL},
-    { "fink",       S(KINFILE),    WI, 3,  "",     "Siiz",
+    { "fink",       S(KINFILE),    WI|TD, 3,  "",     "Siiz",
         (SUBR) kinfile_set_S,     (SUBR) kinfile,     (SUBR) NULL, NULL},
-    { "fink.i",       S(KINFILE),  WI, 3,  "",     "iiiz",
+    { "fink.i",       S(KINFILE),  WI|TD, 3,  "",     "iiiz",
         (SUBR) kinfile_set,     (SUBR) kinfile,     (SUBR) NULL, NULL},
-    { "fini",       S(I_INFILE),   WI, 1,  "",     "Siim",
+    { "fini",       S(I_INFILE),   WI|TD, 1,  "",     "Siim",
       (SUBR) i_infile_S,        (SUBR) NULL,        (SUBR) NULL, NULL },
-    { "fini.i",       S(I_INFILE), WI, 1,  "",     "iiim",
+    { "fini.i",       S(I_INFILE), WI|TD, 1,  "",     "iiim",
         (SUBR) i_infile,        (SUBR) NULL,        (SUBR) NULL, NULL}
 };
 
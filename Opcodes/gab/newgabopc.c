@@ -354,7 +354,7 @@ static int32_t dashow(CSOUND *csound, DSH *p)
 static OENTRY localops[] = {
   { "vtable1k",       S(MTABLE1),         TR, 3,  "",  "kz",
                   (SUBR)mtable1_set,      (SUBR)mtable1_k,        (SUBR) NULL },
-  { "trandom",        S(TRANGERAND),          0,    2,  "k", "kkk",
+  { "trandom",        S(TRANGERAND),          SQ,    2,  "k", "kkk",
                     NULL,                                   (SUBR)trRangeRand },
   { "lposcila", S(LPOSC),      TR, 3, "a", "akkkio",
                                            (SUBR)lposc_set, (SUBR)lposca},
@@ -2624,8 +2624,8 @@ OENTRY vectorial_localops[] = {
   { "vmirror", S(VLIMIT),  TB,   3, "",  "ikki",(SUBR)vlimit_set, (SUBR)vmirror },
   { "vlinseg", S(VSEG),   TB, 3, "",  "iim", (SUBR)vseg_set,   (SUBR)vlinseg },
   { "vexpseg", S(VSEG),   TB, 3, "",  "iim", (SUBR)vseg_set, (SUBR)vexpseg },
-  { "vrandh", S(VRANDH),  TB, 3, "",  "ikkiovoo",(SUBR)vrandh_set, (SUBR)vrandh},
-  { "vrandi", S(VRANDI),  TB, 3, "",  "ikkiovoo",(SUBR)vrandi_set, (SUBR)vrandi },
+  { "vrandh", S(VRANDH),  TB|SQ, 3, "",  "ikkiovoo",(SUBR)vrandh_set, (SUBR)vrandh},
+  { "vrandi", S(VRANDI),  TB|SQ, 3, "",  "ikkiovoo",(SUBR)vrandi_set, (SUBR)vrandi },
   { "vport",  S(VPORT),   TB, 3, "",  "ikio",(SUBR)vport_set,  (SUBR)vport   },
   { "vecdelay", S(VECDEL), TB, 3, "",  "iiiiio",(SUBR)vecdly_set, (SUBR)vecdly },
   { "vdelayk", S(KDEL),    0, 3, "k", "kkioo",(SUBR)kdel_set,  (SUBR)kdelay },
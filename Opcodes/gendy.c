@@ -27,6 +27,7 @@
 */
 
 #include "csoundCore.h"
+#include "interlocks.h"
 
 typedef struct {
         OPDS    h;
@@ -534,17 +535,17 @@ static OENTRY gendy_localops[] = {
   { "gendy",    0xffff                                   },
   { "gendyx",   0xffff                                   },
   { "gendyc",   0xffff                                   },
-  { "gendy.k",  sizeof(GENDY),  0,3, "k", "kkkkkkkkkoO",
+  { "gendy.k",  sizeof(GENDY),  SQ,3, "k", "kkkkkkkkkoO",
     (SUBR)gendyset,  (SUBR)kgendy,  (SUBR)NULL           },
-  { "gendy.a",  sizeof(GENDY),  0,3, "a", "kkkkkkkkkoO",
+  { "gendy.a",  sizeof(GENDY),  SQ,3, "a", "kkkkkkkkkoO",
     (SUBR)gendyset,    (SUBR)agendy         },
-  { "gendyx.k", sizeof(GENDYX), 0,3, "k", "kkkkkkkkkkkoO",
+  { "gendyx.k", sizeof(GENDYX), SQ,3, "k", "kkkkkkkkkkkoO",
     (SUBR)gendyxset, (SUBR)kgendyx, (SUBR)NULL           },
-  { "gendyx.a", sizeof(GENDYX), 0,3, "a", "kkkkkkkkkkkoO",
+  { "gendyx.a", sizeof(GENDYX), SQ,3, "a", "kkkkkkkkkkkoO",
     (SUBR)gendyxset,    (SUBR)agendyx        },
-  { "gendyc.k", sizeof(GENDYC), 0,3, "k", "kkkkkkkkkoO",
+  { "gendyc.k", sizeof(GENDYC), SQ,3, "k", "kkkkkkkkkoO",
     (SUBR)gendycset, (SUBR)kgendyc, (SUBR)NULL           },
-  { "gendyc.a", sizeof(GENDYC), 0,3, "a", "kkkkkkkkkoO",
+  { "gendyc.a", sizeof(GENDYC), SQ,3, "a", "kkkkkkkkkoO",
     (SUBR)gendycset,    (SUBR)agendyc        }
 };
 
@@ -71,22 +71,13 @@ static int32_t moogladder_init(CSOUND *csound, moogladder *p)
     return OK;
 }
 
-static int32_t moogladder_process(CSOUND *csound, moogladder *p)
-{
-    MYFLT   *out = p->out;
-    MYFLT   *in = p->in;
-    MYFLT   freq = *p->freq;
-    MYFLT   res = *p->res;
-    double  res4;
-    double  *delay = p->delay;
-    double  *tanhstg = p->tanhstg;
-    double  stg[4], input;
-    double  acr, tune;
 #define THERMAL (0.000025) /* (1.0 / 40000.0) transistor thermal voltage  */
-    int32_t     j;
-    uint32_t offset = p->h.insdshead->ksmps_offset;
-    uint32_t early  = p->h.insdshead->ksmps_no_end;
-    uint32_t i, nsmps = CS_KSMPS;
+
+/* coefficients for k-rate freq and res; returns the feedback gain */
+static double moogladder_tune(CSOUND *csound, moogladder *p,
+                              MYFLT freq, MYFLT res, double *tune)
+{
+    double  acr;
 
     if (res < 0) res = 0;
 
@@ -101,17 +92,36 @@ static int32_t moogladder_process(CSOUND *csound, moogladder *p)
       /* frequency & amplitude correction  */
       fcr = 1.8730*fc3 + 0.4955*fc2 - 0.6490*fc + 0.9988;
       acr = -3.9364*fc2 + 1.8409*fc + 0.9968;
-      tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
+      *tune = (1.0 - exp(-(TWOPI*f*fcr))) / THERMAL;   /* filter tuning  */
       p->oldres = res;
       p->oldacr = acr;
-      p->oldtune = tune;
+      p->oldtune = *tune;
     }
     else {
       res = p->oldres;
       acr = p->oldacr;
-      tune = p->oldtune;
+      *tune = p->oldtune;
     }
-    res4 = 4.0*(double)res*acr;
+    return 4.0*(double)res*acr;
+}
+
+static int32_t moogladder_process(CSOUND *csound, moogladder *p)
+{
+    MYFLT   *out = p->out;
+    MYFLT   *in = p->in;
+    MYFLT   freq = *p->freq;
+    MYFLT   res = *p->res;
+    double  res4;
+    double  *delay = p->delay;
+    double  *tanhstg = p->tanhstg;
+    double  stg[4], input;
+    double  tune;
+    int32_t     j;
+    uint32_t offset = p->h.insdshead->ksmps_offset;
+    uint32_t early  = p->h.insdshead->ksmps_no_end;
+    uint32_t i, nsmps = CS_KSMPS;
+
+    res4 = moogladder_tune(csound, p, freq, res, &tune);
 
     if (UNLIKELY(offset)) memset(out, '\0', offset*sizeof(MYFLT));
     if (UNLIKELY(early)) {
@@ -153,6 +163,63 @@ static int32_t moogladder_process(CSOUND *csound, moogladder *p)
     return OK;
 }
 
+/* moogladder for n instances at once (--multi-instance): the ladder
+   state of up to MULTI_LANES notes is held in arrays and the notes are
+   filtered together, one sample of every note at a time */
+static int32_t moogladder_process_multi(CSOUND *csound, void **pp, int32_t n)
+{
+    moogladder *mp[MULTI_LANES];
+    MYFLT   *in[MULTI_LANES], *out[MULTI_LANES];
+    double  res4[MULTI_LANES], tune[MULTI_LANES];
+    double  delay[6][MULTI_LANES], tanhstg[3][MULTI_LANES];
+    uint32_t i, nsmps = csound->ksmps;
+    int32_t  j, k, m;
+
+    while (n > 0) {
+      for (m = 0; n > 0 && m < MULTI_LANES; n--) {
+        moogladder *p = (moogladder *) *pp++;
+        mp[m] = p;
+        in[m] = p->in;
+        out[m] = p->out;
+        res4[m] = moogladder_tune(csound, p, *p->freq, *p->res, &tune[m]);
+        for (k = 0; k < 6; k++) delay[k][m] = p->delay[k];
+        for (k = 0; k < 3; k++) tanhstg[k][m] = p->tanhstg[k];
+        m++;
+      }
+      for (i = 0; i < nsmps; i++)
+        for (j = 0; j < m; j++) {
+          double  stg0, stg1, stg2, stg3, input;
+          int32_t o;
+          /* oversampling  */
+          for (o = 0; o < 2; o++) {
+            input = in[j][i] - res4[j]*delay[5][j];
+            delay[0][j] = stg0 =
+              delay[0][j] + tune[j]*(tanh(input*THERMAL) - tanhstg[0][j]);
+            input = stg0;
+            stg1 = delay[1][j] +
+              tune[j]*((tanhstg[0][j] = tanh(input*THERMAL)) - tanhstg[1][j]);
+            input = delay[1][j] = stg1;
+            stg2 = delay[2][j] +
+              tune[j]*((tanhstg[1][j] = tanh(input*THERMAL)) - tanhstg[2][j]);
+            input = delay[2][j] = stg2;
+            stg3 = delay[3][j] +
+              tune[j]*((tanhstg[2][j] = tanh(input*THERMAL)) -
+                       tanh(delay[3][j]*THERMAL));
+            delay[3][j] = stg3;
+            /* 1/2-sample delay for phase compensation  */
+            delay[5][j] = (stg3 + delay[4][j])*0.5;
+            delay[4][j] = stg3;
+          }
+          out[j][i] = (MYFLT) delay[5][j];
+        }
+      for (j = 0; j < m; j++) {
+        for (k = 0; k < 6; k++) mp[j]->delay[k] = delay[k][j];
+        for (k = 0; k < 3; k++) mp[j]->tanhstg[k] = tanhstg[k][j];
+      }
+    }
+    return OK;
+}
+
 static int32_t moogladder_process_aa(CSOUND *csound, moogladder *p)
 {
     MYFLT   *out = p->out;
@@ -2267,7 +2334,8 @@ static OENTRY localops[] =
    {"mvclpf4", sizeof(mvclpf24), 0, 3, "aaaa", "aaap",
    (SUBR) mvclpf24_init, (SUBR) mvclpf24_perf4_aa},
    {"moogladder.kk", sizeof(moogladder), 0, 3, "a", "akkp",
-   (SUBR) moogladder_init, (SUBR) moogladder_process },
+   (SUBR) moogladder_init, (SUBR) moogladder_process, NULL, NULL,
+   (MSUBR) moogladder_process_multi },
    {"moogladder.aa", sizeof(moogladder), 0, 3, "a", "aaap",
    (SUBR) moogladder_init, (SUBR) moogladder_process_aa },
    {"moogladder.ak", sizeof(moogladder), 0, 3, "a", "aakp",
@@ -2594,11 +2594,11 @@ static const OENTRY localops[] =
             (SUBR) grain3set, (SUBR) grain3                },
     { "rnd31",      0xFFFF,  0,            0,      NULL,   NULL,
             (SUBR) NULL, (SUBR) NULL, (SUBR) NULL                       },
-    { "rnd31.i",    sizeof(RND31),  0,     1,      "i",    "iio",
+    { "rnd31.i",    sizeof(RND31),  SQ,     1,      "i",    "iio",
             (SUBR) rnd31i, (SUBR) NULL, (SUBR) NULL                     },
-    { "rnd31.k",    sizeof(RND31),  0,     3,      "k",    "kko",
+    { "rnd31.k",    sizeof(RND31),  SQ,     3,      "k",    "kko",
             (SUBR) rnd31set, (SUBR) rnd31k, (SUBR) NULL                 },
-   { "rnd31.a",    sizeof(RND31),  0,     3,      "a",    "kko",
+   { "rnd31.a",    sizeof(RND31),  SQ,     3,      "a",    "kko",
             (SUBR) rnd31set, (SUBR) rnd31a                 },
     { "oscilikt",   0xFFFE,   TR                                       },
    { "oscilikt.a", sizeof(OSCKT),   0,   3,      "a",    "kkkoo",
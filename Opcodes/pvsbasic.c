@@ -2604,9 +2604,9 @@ int32_t  tab2pvssplit(CSOUND *csound, TAB2PVSSPLIT_T *p)
 
 
 static OENTRY localops[] = {
-  {"pvsfwrite", sizeof(PVSFWRITE),0, 3, "", "fS", (SUBR) pvsfwriteset_S,
+  {"pvsfwrite", sizeof(PVSFWRITE),TD, 3, "", "fS", (SUBR) pvsfwriteset_S,
    (SUBR) pvsfwrite},
-  {"pvsfwrite.i", sizeof(PVSFWRITE),0, 3, "", "fi", (SUBR) pvsfwriteset,
+  {"pvsfwrite.i", sizeof(PVSFWRITE),TD, 3, "", "fi", (SUBR) pvsfwriteset,
    (SUBR) pvsfwrite},
   {"pvsfilter", sizeof(PVSFILTER),0, 3, "f", "ffxp", (SUBR) pvsfilterset,
    (SUBR) pvsfilter},
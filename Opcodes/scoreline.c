@@ -23,6 +23,7 @@
 
 //#include "csdl.h"
 #include "csoundCore.h"
+#include "interlocks.h"
 //extern void csoundInputMessageInternal(CSOUND *, const char *);
 
 typedef struct _inmess {
@@ -62,8 +63,8 @@ rewindscore(CSOUND *csound, SCOREPOS *p){
 
 
 static OENTRY scoreline_localops[] = {
-  {"scoreline_i", sizeof(INMESS), 0, 1, "", "S", (SUBR)messi, NULL, NULL},
-  {"scoreline", sizeof(INMESS), 0, 2, "", "Sk", NULL, (SUBR)messk, NULL},
+  {"scoreline_i", sizeof(INMESS), SQ, 1, "", "S", (SUBR)messi, NULL, NULL},
+  {"scoreline", sizeof(INMESS), SQ, 2, "", "Sk", NULL, (SUBR)messk, NULL},
   {"setscorepos", sizeof(SCOREPOS), 0, 1, "", "i", (SUBR)setscorepos, NULL, NULL},
   {"rewindscore", sizeof(SCOREPOS), 0, 1, "", "", (SUBR)rewindscore, NULL, NULL}
 };
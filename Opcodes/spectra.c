@@ -1261,8 +1261,8 @@ static OENTRY spectra_localops[] = {
                                     (SUBR)impulse_set, (SUBR)impulse },
 { "lpf18", S(LPF18), 0, 3,  "a", "axxxo",  (SUBR)lpf18set, (SUBR)lpf18db },
 { "waveset", S(BARRI), 0, 3,  "a", "ako",  (SUBR)wavesetset, (SUBR)waveset},
-{ "pinkish", S(PINKISH), 0, 3, "a", "xoooo", (SUBR)pinkset, (SUBR)pinkish },
-{ "noise",  S(VARI), 0, 3,  "a", "xk",   (SUBR)varicolset, (SUBR)varicol },
+{ "pinkish", S(PINKISH), SQ, 3, "a", "xoooo", (SUBR)pinkset, (SUBR)pinkish },
+{ "noise",  S(VARI), SQ, 3,  "a", "xk",   (SUBR)varicolset, (SUBR)varicol },
 { "transeg", S(TRANSEG),0, 3,  "k", "iiim",
                                            (SUBR)trnset,(SUBR)ktrnseg, NULL},
 { "transeg.a", S(TRANSEG),0, 3,  "a", "iiim",
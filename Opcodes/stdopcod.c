@@ -46,6 +46,7 @@ int32_t stdopc_ModuleInit(CSOUND *csound)
     /* fout.c */
     p->file_opened = (struct fileinTag*) NULL;
     p->file_num = -1;
+    csoundSpinLockInit(&p->file_lock);
     /*p->buf = (MYFLT*) NULL;*/
     /* ugnorman.c */
     p->atsbufreadaddr = NULL;
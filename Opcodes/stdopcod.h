@@ -52,6 +52,8 @@ typedef struct STDOPCOD_GLOBALS_ {
     int32_t         file_max;
     int32_t         file_num;
     int32        fout_kreset;
+    spin_lock_t  file_lock;     /* file_opened, also released by the
+                                   reclaimer thread (--reclaim-thread) */
    /* MYFLT       *buf;
       int32_t         buf_size; */ /* VL - now using per instance buffer */
     /* oscbnk.c */
@@ -35,6 +35,7 @@
 */
 
 #include "csoundCore.h"
+#include "interlocks.h"
 
 typedef struct {
         OPDS    h;
@@ -384,19 +385,19 @@ static int32_t gausstrig_process_arate(CSOUND* csound, GAUSSTRIG *p)
 }
 
 static OENTRY scnoise_localops[] = {
-  { "dust.k",      sizeof(DUST), 0,3, "k", "kk",
+  { "dust.k",      sizeof(DUST), SQ,3, "k", "kk",
     (SUBR)dust_init, (SUBR)dust_process_krate, NULL },
-  { "dust.k",     sizeof(DUST), 0,3, "k", "kk",
+  { "dust.k",     sizeof(DUST), SQ,3, "k", "kk",
     (SUBR)dust_init, (SUBR)dust_process_krate, NULL },
-  { "dust.a",      sizeof(DUST), 0,3, "a", "kk",
+  { "dust.a",      sizeof(DUST), SQ,3, "a", "kk",
     (SUBR)dust_init, (SUBR)dust_process_arate },
-  { "dust2.k",     sizeof(DUST), 0,3, "k", "kk",
+  { "dust2.k",     sizeof(DUST), SQ,3, "k", "kk",
     (SUBR)dust_init, (SUBR)dust2_process_krate, NULL },
-  { "dust2.a",     sizeof(DUST), 0,3, "a", "kk",
+  { "dust2.a",     sizeof(DUST), SQ,3, "a", "kk",
     (SUBR)dust_init, (SUBR)dust2_process_arate },
-  { "gausstrig.k", sizeof(GAUSSTRIG), 0,3, "k", "kkkoo",
+  { "gausstrig.k", sizeof(GAUSSTRIG), SQ,3, "k", "kkkoo",
     (SUBR)gausstrig_initk, (SUBR)gausstrig_process_krate, NULL },
-  { "gausstrig.a", sizeof(GAUSSTRIG), 0,3, "a", "kkkoo",
+  { "gausstrig.a", sizeof(GAUSSTRIG), SQ,3, "a", "kkkoo",
     (SUBR)gausstrig_init, (SUBR)gausstrig_process_arate }
 };
 
@@ -2065,11 +2065,11 @@ static OENTRY localops[] = {
 { "vibrato",  S(VIBRATO), TR, 3, "k", "kkkkkkkkio",
                                         (SUBR)vibrato_set, (SUBR)vibrato, NULL   },
 { "vibr",     S(VIBRATO), TR, 3, "k", "kki",  (SUBR)vibr_set, (SUBR)vibr, NULL   },
-{ "jitter2",  S(JITTER2), 0,3, "k", "kkkkkkko", (SUBR)jitter2_set, (SUBR)jitter2 },
-{ "jitter",   S(JITTER),  0,3, "k", "kkk",  (SUBR)jitter_set, (SUBR)jitter, NULL },
-{ "jspline",  S(JITTERS), 0,3, "k", "xkk",
+{ "jitter2",  S(JITTER2), SQ,3, "k", "kkkkkkko", (SUBR)jitter2_set, (SUBR)jitter2 },
+{ "jitter",   S(JITTER),  SQ,3, "k", "kkk",  (SUBR)jitter_set, (SUBR)jitter, NULL },
+{ "jspline",  S(JITTERS), SQ,3, "k", "xkk",
                                 (SUBR)jitters_set, (SUBR)jitters, NULL },
-{ "jspline.a",  S(JITTERS), 0,3, "a", "xkk",
+{ "jspline.a",  S(JITTERS), SQ,3, "a", "xkk",
     (SUBR)jitters_set, (SUBR)jittersa },
 { "loopseg",  S(LOOPSEG), 0,3, "k", "kkiz", (SUBR)loopseg_set, (SUBR)loopseg, NULL},
 { "loopxseg", S(LOOPSEG), 0,3, "k", "kkiz", (SUBR)loopseg_set,(SUBR)loopxseg, NULL},
@@ -2077,34 +2077,34 @@ static OENTRY localops[] = {
 { "lpshold",  S(LOOPSEG), 0,3, "k", "kkiz",(SUBR)loopseg_set, (SUBR)lpshold, NULL },
 { "loopsegp", S(LOOPSEGP), 0,3,"k", "kz",  (SUBR)loopsegp_set,(SUBR)loopsegp, NULL},
 { "lpsholdp", S(LOOPSEGP), 0,3,"k", "kz",  (SUBR)loopsegp_set,(SUBR)lpsholdp, NULL},
-{ "cuserrnd.i", S(CURAND),0,1,"i",  "iii",  (SUBR)iContinuousUserRand, NULL, NULL },
-{ "cuserrnd.k", S(CURAND),0,2,"k",  "kkk",
+{ "cuserrnd.i", S(CURAND),SQ,1,"i",  "iii",  (SUBR)iContinuousUserRand, NULL, NULL },
+{ "cuserrnd.k", S(CURAND),SQ,2,"k",  "kkk",
                             (SUBR)Cuserrnd_set, (SUBR)kContinuousUserRand, NULL },
-{ "cuserrnd.a",S(CURAND),0,2, "a", "kkk",
+{ "cuserrnd.a",S(CURAND),SQ,2, "a", "kkk",
                             (SUBR)Cuserrnd_set, (SUBR)aContinuousUserRand },
-{ "random.i", S(RANGERAND), 0,1, "i", "ii",    (SUBR)ikRangeRand, NULL, NULL      },
-{ "random.k", S(RANGERAND), 0,2, "k", "kk",    NULL, (SUBR)ikRangeRand, NULL      },
-{ "random.a", S(RANGERAND), 0,2, "a", "kk",    NULL,  (SUBR)aRangeRand      },
-{ "rspline",  S(RANDOM3), 0,3, "k", "xxkk",
+{ "random.i", S(RANGERAND), SQ,1, "i", "ii",    (SUBR)ikRangeRand, NULL, NULL      },
+{ "random.k", S(RANGERAND), SQ,2, "k", "kk",    NULL, (SUBR)ikRangeRand, NULL      },
+{ "random.a", S(RANGERAND), SQ,2, "a", "kk",    NULL,  (SUBR)aRangeRand      },
+{ "rspline",  S(RANDOM3), SQ,3, "k", "xxkk",
                                (SUBR)random3_set, (SUBR)random3, NULL },
-{ "rspline.a",  S(RANDOM3), 0,3, "a", "xxkk",
+{ "rspline.a",  S(RANDOM3), SQ,3, "a", "xxkk",
                                (SUBR)random3_set, (SUBR)random3a },
-{ "randomi",  S(RANDOMI), 0,3, "a", "kkxoo",
+{ "randomi",  S(RANDOMI), SQ,3, "a", "kkxoo",
                                (SUBR)randomi_set, (SUBR)randomi },
-{ "randomi.k",  S(RANDOMI), 0,3, "k", "kkkoo",
+{ "randomi.k",  S(RANDOMI), SQ,3, "k", "kkkoo",
                                (SUBR)randomi_set, (SUBR)krandomi,NULL },
-{ "randomh",  S(RANDOMH), 0,3, "a", "kkxoo",
+{ "randomh",  S(RANDOMH), SQ,3, "a", "kkxoo",
                                  (SUBR)randomh_set,(SUBR)randomh },
-{ "randomh.k",  S(RANDOMH), 0,3, "k", "kkkoo",
+{ "randomh.k",  S(RANDOMH), SQ,3, "k", "kkkoo",
                                  (SUBR)randomh_set,(SUBR)krandomh,NULL},
-{ "urd.i",  S(DURAND),  0,1, "i", "i", (SUBR)iDiscreteUserRand, NULL, NULL    },
-{ "urd.k",  S(DURAND),  0,2, "k", "k", (SUBR)Cuserrnd_set,(SUBR)kDiscreteUserRand },
-{ "urd.a",  S(DURAND),  0,2, "a", "k",
+{ "urd.i",  S(DURAND),  SQ,1, "i", "i", (SUBR)iDiscreteUserRand, NULL, NULL    },
+{ "urd.k",  S(DURAND),  SQ,2, "k", "k", (SUBR)Cuserrnd_set,(SUBR)kDiscreteUserRand },
+{ "urd.a",  S(DURAND),  SQ,2, "a", "k",
                               (SUBR)Cuserrnd_set, (SUBR)aDiscreteUserRand },
-{ "duserrnd.i", S(DURAND),0,1, "i", "i",  (SUBR)iDiscreteUserRand, NULL, NULL },
-{ "duserrnd.k", S(DURAND),0,2, "k", "k",
+{ "duserrnd.i", S(DURAND),SQ,1, "i", "i",  (SUBR)iDiscreteUserRand, NULL, NULL },
+{ "duserrnd.k", S(DURAND),SQ,2, "k", "k",
                                 (SUBR)Cuserrnd_set,(SUBR)kDiscreteUserRand,NULL },
-{ "duserrnd.a", S(DURAND),0,2, "a", "k",
+{ "duserrnd.a", S(DURAND),SQ,2, "a", "k",
                                 (SUBR)Cuserrnd_set,(SUBR)aDiscreteUserRand },
 //{ "poscil", 0xfffe, TR                                                          },
 { "poscil.a", S(POSC), TR,3, "a", "kkjo", (SUBR)posc_set,(SUBR)posckk },
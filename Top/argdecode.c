@@ -289,6 +289,39 @@ static const char *longUsageList[] = {
   Str_noop("--no-default-paths      turn off relative paths from CSD/ORC/SCO"),
   Str_noop("--sample-accurate       use sample-accurate timing of score events"),
   Str_noop("--realtime              realtime priority mode"),
+  Str_noop("--work-stealing         use per-thread task queues with -j N"),
+  Str_noop("--dag-incremental       update the -j N task graph per note "
+                                   "instead of rebuilding it"),
+  Str_noop("--park-spin=N           idle -j N threads sleep after N polls "
+                                   "(0: never sleep)"),
+  Str_noop("--dag-cost-model        time instruments and run costly -j N "
+                                   "tasks first"),
+  Str_noop("--task-batch=N          batch cheap instances of an instrument"),
+  Str_noop("                          into -j N tasks of N mean instance costs"),
+  Str_noop("--instance-slab=N       allocate instrument instances N at a time"),
+  Str_noop("--mem-arenas            keep a separate allocation list per thread"),
+  Str_noop("--instance-layout       allocate instances from per-instrument slabs"),
+  Str_noop("                          and run them in memory order"),
+  Str_noop("--multi-instance        run instances of an instrument in lockstep,"),
+  Str_noop("                          one call per opcode for all of them"),
+  Str_noop("--expression-opt        optimise compiled expressions (default):"),
+  Str_noop("                          strength reduction, shared subexpressions,"),
+  Str_noop("                          init-pass hoisting and fused a-rate arithmetic"),
+  Str_noop("--no-expression-opt     compile expressions as written"),
+  Str_noop("--reclaim-thread        run deinit routines of ended notes on a"),
+  Str_noop("                          background thread"),
+  Str_noop("--reclaim-budget=N      with --reclaim-thread, free at most N ended"),
+  Str_noop("                          notes per k-cycle (0: no limit)"),
+  Str_noop("--diskin-threads=N      read asynchronous diskin2 streams (realtime"),
+  Str_noop("                          mode) on N shared I/O threads"),
+  Str_noop("--mmap-soundfiles       map uncompressed soundfiles of GEN01,"),
+  Str_noop("                          diskin2 and sndload into memory"),
+  Str_noop("--mmap-soundfiles=defer as above, with tables paged in when first"),
+  Str_noop("                          played instead of at load"),
+  Str_noop("--write-buffers=N       write the output soundfile on a background"),
+  Str_noop("                          thread, up to N buffers behind"),
+  Str_noop("--render-section=N      perform only section N of the score; the f"),
+  Str_noop("                          and q statements before it still run"),
   Str_noop("--nchnls=N              override number of audio channels"),
   Str_noop("--nchnls_i=N            override number of input audio channels"),
   Str_noop("--0dbfs=N               override 0dbfs (max positive signal amplitude)"),
@@ -878,15 +911,12 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       return 1;
     }
     /* IV - Jan 27 2005: --expression-opt */
-    /* NOTE these do nothing */
     else if (!(strcmp (s, "expression-opt"))) {
-      //O->expr_opt = 1;
-      csound->Warning(csound, Str("option expresson-opt has no affect\n"));
+      O->exprOpt = 1;
       return 1;
     }
     else if (!(strcmp (s, "no-expression-opt"))) {
-      //O->expr_opt = 0;
-      csound->Warning(csound, Str("option no-expresson-opt has no affect\n"));
+      O->exprOpt = 0;
       return 1;
     }
     else if (!(strncmp (s, "env:", 4))) {
@@ -1023,6 +1053,77 @@ static int decode_long(CSOUND *csound, char *s, int argc, char **argv)
       O->numThreads = atoi(s);
       return 1;
     }
+    else if (!(strncmp (s, "task-batch=", 11))) {
+      s += 11;
+      O->taskBatch = atoi(s);
+      return 1;
+    }
+    else if (!(strcmp (s, "work-stealing"))) {
+      O->workStealing = 1;
+      return 1;
+    }
+    else if (!(strcmp (s, "dag-incremental"))) {
+      O->dagIncremental = 1;
+      return 1;
+    }
+    else if (!(strncmp (s, "park-spin=", 10))) {
+      s += 10;
+      O->parkSpin = atoi(s);
+      return 1;
+    }
+    else if (!(strcmp (s, "dag-cost-model"))) {
+      O->dagCostModel = 1;
+      return 1;
+    }
+    else if (!(strncmp (s, "instance-slab=", 14))) {
+      s += 14;
+      O->instanceSlab = atoi(s);
+      return 1;
+    }
+    else if (!(strcmp (s, "mem-arenas"))) {
+      O->memArenas = 1;
+      return 1;
+    }
+    else if (!(strcmp (s, "instance-layout"))) {
+      O->instanceLayout = 1;
+      return 1;
+    }
+    else if (!(strcmp (s, "multi-instance"))) {
+      O->multiInstance = 1;
+      return 1;
+    }
+    else if (!(strcmp (s, "reclaim-thread"))) {
+      O->reclaimThread = 1;
+      return 1;
+    }
+    else if (!(strncmp (s, "reclaim-budget=", 15))) {
+      s += 15;
+      O->reclaimBudget = atoi(s);
+      return 1;
+    }
+    else if (!(strncmp (s, "diskin-threads=", 15))) {
+      s += 15;
+      O->diskinThreads = atoi(s);
+      return 1;
+    }
+    else if (!(strcmp (s, "mmap-soundfiles"))) {
+      O->sndMap = 1;                    /* map soundfiles, page in now */
+      return 1;
+    }
+    else if (!(strcmp (s, "mmap-soundfiles=defer"))) {
+      O->sndMap = 2;                    /* page in on first use */
+      return 1;
+    }
+    else if (!(strncmp (s, "write-buffers=", 14))) {
+      s += 14;
+      O->writeBuffers = atoi(s);
+      return 1;
+    }
+    else if (!(strncmp (s, "render-section=", 15))) {
+      s += 15;
+      O->renderSection = atoi(s);
+      return 1;
+    }
     else if (!(strcmp (s, "syntax-check-only"))) {
       O->syntaxCheckOnly = 1;
       return 1;
@@ -49,6 +49,9 @@
 # include <winsock2.h>
 # include <windows.h>
 #endif
+#if defined(_MSC_VER)
+# include <intrin.h>    /* __rdtsc */
+#endif
 #include <math.h>
 #include "oload.h"
 #include "fgens.h"
@@ -57,8 +60,10 @@
 #include "fftlib.h"
 #include "cs_par_base.h"
 #include "cs_par_orc_semantics.h"
+#include "interlocks.h"
 //#include "cs_par_dispatch.h"
 #include "find_opcode.h"
+#include "aops_kernels.h"
 
 #if defined(linux)||defined(__HAIKU__)|| defined(__EMSCRIPTEN__)||defined(__CYGWIN__)
 #define PTHREAD_SPINLOCK_INITIALIZER 0
@@ -667,7 +672,7 @@ static const CSOUND cenviron_ = {
     NULL,
     NULL,
     NULL,
-    NULL,
+    0, 0,
     NULL,
     NULL,
     0,
@@ -704,6 +709,10 @@ static const CSOUND cenviron_ = {
     FL(0.0),
     NULL,
     NULL,
+    -1,
+    NULL,
+    NULL,
+    0,
     {NULL, FL(0.0)},
    {NULL, FL(0.0)},
    {NULL, FL(0.0)},
@@ -815,6 +824,8 @@ static const CSOUND cenviron_ = {
       1U,           /*  nframes             */
       NULL, NULL,   /*  pin, pout           */
       0,            /*dither                */
+      NULL, 0,      /*  peakacc, peaklanes  */
+      NULL          /*  writer              */
     },
     0,              /*  warped              */
     0,              /*  sstrlen             */
@@ -909,7 +920,23 @@ static const CSOUND cenviron_ = {
       0.4,          /*    vbr quality  */
       0,            /*    ksmps_override */
       0,             /*    fft_lib */
-      0
+      0,            /*    echo */
+      0,            /*    workStealing */
+      0,            /*    dagIncremental */
+      0,            /*    parkSpin */
+      0,            /*    dagCostModel */
+      0,            /*    instanceSlab */
+      0,            /*    memArenas */
+      0,            /*    instanceLayout */
+      0,            /*    multiInstance */
+      1,            /*    exprOpt */
+      0,            /*    reclaimThread */
+      8,            /*    reclaimBudget */
+      2,            /*    diskinThreads */
+      0,            /*    sndMap */
+      0,            /*    writeBuffers */
+      0,            /*    renderSection */
+      0             /*    taskBatch */
     },
 
     {0, 0, {0}}, /* REMOT_BUF */
@@ -965,10 +992,9 @@ static const CSOUND cenviron_ = {
     0,              /* unusedint */
     1,              /* inZero */
     NULL,           /* msg_queue */
-    0,              /* msg_queue_wget */
     0,              /* msg_queue_wput */
     0,              /* msg_queue_rstart */
-    0,              /* msg_queue_items */
+    0,              /* msg_queue_full */
     127,            /* aftouch */
     NULL,           /* directory for corfiles */
     NULL,           /* alloc_queue */
@@ -980,7 +1006,46 @@ static const CSOUND cenviron_ = {
     NULL,           /* message_string */
     0,              /* message_string_queue_items */
     0,              /* message_string_queue_wp */
-    NULL            /* message_string_queue */
+    NULL,           /* message_string_queue */
+    NULL,           /* dag_deques */
+    0,              /* dag_num_deques */
+    0,              /* dag_tasks_unstarted */
+    0,              /* dag_num_live */
+    0,              /* dag_epoch */
+    NULL,           /* dag_conflicts */
+    0,              /* dag_conflicts_size */
+    0,              /* dag_conflicts_count */
+    0,              /* dag_conflicts_stale */
+    NULL,           /* dag_park_lock */
+    NULL,           /* dag_park_cond */
+    0,              /* dag_parked */
+    NULL,           /* dag_task_order */
+    0,              /* dag_num_order */
+    NULL,           /* dag_task_cost */
+    NULL,           /* dag_thread_start */
+    NULL,           /* alloc_queue_wakeup */
+    0,              /* alloc_queue_sleeping */
+    NULL,           /* alloc_latency */
+    0.0,            /* alloc_latency_max */
+    NULL,           /* mem_arenas */
+    0,              /* mem_arena_epoch */
+    0, 0,           /* mem_lock_count, mem_lock_contended */
+    NULL,           /* offheap */
+    0, 0,           /* offheap_size, offheap_max */
+    0,              /* offseq */
+    NULL, NULL,     /* reclaim_queue, reclaim_done */
+    0, 0,           /* reclaim_queue_items, reclaim_done_items */
+    0, 0,           /* reclaim_queue_wp, reclaim_done_rp */
+    0,              /* reclaim_pending */
+    SPINLOCK_INIT,  /* reclaim_spinlock */
+    NULL,           /* reclaim_thread */
+    NULL,           /* reclaim_wakeup */
+    0,              /* reclaim_sleeping */
+    0,              /* reclaim_loop */
+    NULL,           /* sndmaps */
+    SPINLOCK_INIT,  /* sndmaps_lock */
+    SPINLOCK_INIT,  /* open_files_lock */
+    SPINLOCK_INIT   /* pvfiles_lock */
     /*, NULL */           /* self-reference */
 };
 
@@ -1280,6 +1345,7 @@ PUBLIC int csoundInitialize(int flags)
     if (!(flags & CSOUNDINIT_NO_ATEXIT))
       atexit(destroy_all_instances);
 #endif
+    csound_aops_select_kernels();
     csoundLock();
     init_done = 1;
     csoundUnLock();
@@ -1484,10 +1550,80 @@ inline void advanceINSDSPointer(INSDS ***start, int num)
 }
 
 int dag_get_task(CSOUND *csound, int index, int numThreads, int next_task);
-int dag_end_task(CSOUND *csound, int task);
+int dag_end_task(CSOUND *csound, int task, int index);
+int dag_park_task(CSOUND *csound, int index, int numThreads);
 void dag_build(CSOUND *csound, INSDS *chain);
 void dag_reinit(CSOUND *csound);
 
+static inline int_least64_t get_real_time(void);
+
+/* Cheap timestamp for the -j cost model; only differences matter */
+static inline int_least64_t dag_clock(void)
+{
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+    return (int_least64_t) __builtin_ia32_rdtsc();
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+    return (int_least64_t) __rdtsc();
+#else
+    return get_real_time();
+#endif
+}
+
+/* Running average of the cost of one k-period of an instrument */
+static inline void dag_cost_update(INSTRTXT *tp, int_least64_t ticks)
+{
+    int32 c = tp->kcost;
+    if (ticks > 0x3fffffff) ticks = 0x3fffffff;
+    tp->kcost = c + (((int32) ticks - c) >> 3);
+}
+
+/* Run the pre-resolved perf chain of ip (see instance()).  Returns NULL
+   when it ran to the end, otherwise the opcode at which it stopped,
+   because of an error or because pds was moved (a turnoff); the rest
+   of the chain is then followed from there by nxtp. */
+static inline OPDS *perf_table_run(CSOUND *csound, INSDS *ip, int *error)
+{
+    OPCALL *c;
+    for (c = ip->perf; c->op != NULL; c++) {
+      ip->pds = c->op;
+      if (UNLIKELY((*error = (*c->op->opadr)(csound, c->op)) != 0 ||
+                   ip->pds != c->op))
+        return ip->pds;
+    }
+    return NULL;
+}
+
+/* one k-cycle of an instance with a local ksmps (setksmps): the perf
+   chain runs once per sub-block of the schedule */
+static void local_ksmps_perf(CSOUND *csound, INSDS *ip, int *error)
+{
+    LKSMPS_SCHED s;
+    int lksmps = ip->ksmps, incr = csound->nchnls*lksmps, b;
+
+    local_ksmps_schedule(&s, csound->ksmps, lksmps,
+                         ip->ksmps_offset, ip->ksmps_no_end);
+    local_ksmps_spout(csound, &s);
+    ip->spin = csound->spin + s.first*incr;
+    ip->spout = csound->spraw + s.first*incr;
+    ip->kcounter = csound->kcounter*csound->ksmps/lksmps + s.first;
+    for (b = 0; b < s.count && *error == 0 && ip->actflg; b++) {
+      OPDS *opstart = (OPDS*) ip;
+      ip->ksmps_offset = (b == 0 ? s.offset : 0);
+      ip->ksmps_no_end = (b == s.count - 1 ? s.early : 0);
+      if (ip->perf != NULL)
+        opstart = perf_table_run(csound, ip, error);
+      while (*error == 0 && opstart != NULL &&
+             (opstart = opstart->nxtp) != NULL && ip->actflg) {
+        opstart->insdshead->pds = opstart;
+        *error = (*opstart->opadr)(csound, opstart); /* run each opcode */
+        opstart = opstart->insdshead->pds;
+      }
+      ip->kcounter++;
+      ip->spin += incr;
+      ip->spout += incr;
+    }
+}
+
 inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 {
     INSDS *insds = NULL;
@@ -1499,81 +1635,63 @@ inline static int nodePerf(CSOUND *csound, int index, int numThreads)
 #define INVALID (-1)
 #define WAIT    (-2)
     int next_task = INVALID;
+    int cost_model = csound->oparms->dagCostModel;
+    int_least64_t t0 = 0;
     IGN(index);
 
     while (1) {
       int done;
       which_task = dag_get_task(csound, index, numThreads, next_task);
       //printf("******** Select task %d\n", which_task);
-      if (which_task==WAIT) continue;
+      if (which_task==WAIT) {
+        if (csound->dag_park_cond == NULL) continue;
+        which_task = dag_park_task(csound, index, numThreads);
+      }
       if (which_task==INVALID) return played_count;
          /* VL: the validity of icurTime needs to be checked */
         time_end = (csound->ksmps+csound->icurTime)/csound->esr;
         insds = task_map[which_task];
-        if (insds->offtim > 0 && time_end > insds->offtim){
-            /* this is the last cycle of performance */
-            insds->ksmps_no_end = insds->no_end;
-          }
+        do {                  /* each instance batched into the task */
+          if (insds->offtim > 0 && time_end > insds->offtim){
+              /* this is the last cycle of performance */
+              insds->ksmps_no_end = insds->no_end;
+            }
 #if defined(MSVC)
-        done = InterlockedExchangeAdd(&insds->init_done, 0);
+          done = InterlockedExchangeAdd(&insds->init_done, 0);
 #elif defined(HAVE_ATOMIC_BUILTIN)
-        done = __atomic_load_n((int *) &insds->init_done, __ATOMIC_SEQ_CST);
+          done = __atomic_load_n((int *) &insds->init_done, __ATOMIC_SEQ_CST);
 #else
-        done = insds->init_done;
+          done = insds->init_done;
 #endif
-        if (done) {
-          opstart = (OPDS*)task_map[which_task];
-          if (insds->ksmps == csound->ksmps) {
-            insds->spin = csound->spin;
-            insds->spout = csound->spraw;
-            insds->kcounter =  csound->kcounter;
-            while ((opstart = opstart->nxtp) != NULL) {
-              /* In case of jumping need this repeat of opstart */
-              opstart->insdshead->pds = opstart;
-              (*opstart->opadr)(csound, opstart); /* run each opcode */
-              opstart = opstart->insdshead->pds;
-            }
-          } else {
-            int i, n = csound->nspout, start = 0;
-            int lksmps = insds->ksmps;
-            int incr = csound->nchnls*lksmps;
-            int offset =  insds->ksmps_offset;
-            int early = insds->ksmps_no_end;
-            OPDS  *opstart;
-            insds->spin = csound->spin;
-            insds->spout = csound->spraw;
-            insds->kcounter =  csound->kcounter*csound->ksmps;
-
-            /* we have to deal with sample-accurate code
-               whole CS_KSMPS blocks are offset here, the
-               remainder is left to each opcode to deal with.
-            */
-            while (offset >= lksmps) {
-              offset -= lksmps;
-              start += csound->nchnls;
-            }
-            insds->ksmps_offset = offset;
-            if (UNLIKELY(early)) {
-              n -= (early*csound->nchnls);
-              insds->ksmps_no_end = early % lksmps;
-            }
-
-            for (i=start; i < n; i+=incr, insds->spin+=incr, insds->spout+=incr) {
-              opstart = (OPDS*) insds;
-              while ((opstart = opstart->nxtp) != NULL) {
+          if (done) {
+            if (cost_model) t0 = dag_clock();
+            opstart = (OPDS*)insds;
+            if (insds->ksmps == csound->ksmps) {
+              insds->spin = csound->spin;
+              insds->spout = csound->spraw;
+              insds->kcounter =  csound->kcounter;
+              if (insds->perf != NULL) {
+                int error;            /* ignored here, as below */
+                opstart = perf_table_run(csound, insds, &error);
+              }
+              while (opstart != NULL && (opstart = opstart->nxtp) != NULL) {
+                /* In case of jumping need this repeat of opstart */
                 opstart->insdshead->pds = opstart;
                 (*opstart->opadr)(csound, opstart); /* run each opcode */
                 opstart = opstart->insdshead->pds;
               }
-              insds->kcounter++;
+            } else {
+              int error = 0;          /* ignored here, as above */
+              local_ksmps_perf(csound, insds, &error);
             }
+            insds->ksmps_offset = 0; /* reset sample-accuracy offset */
+            insds->ksmps_no_end = 0;  /* reset end of loop samples */
+            played_count++;
+            if (cost_model) dag_cost_update(insds->instr, dag_clock() - t0);
           }
-          insds->ksmps_offset = 0; /* reset sample-accuracy offset */
-          insds->ksmps_no_end = 0;  /* reset end of loop samples */
-          played_count++;
-        }
+        } while ((insds = insds->dag_next) != NULL);
         //printf("******** finished task %d\n", which_task);
-        next_task = dag_end_task(csound, which_task);
+        next_task = dag_end_task(csound, which_task, index);
     }
     return played_count;
 }
@@ -1636,6 +1754,7 @@ unsigned long kperfThread(void * cs)
       if (csound->multiThreadedComplete == 1) {
         /*csound_global_mutex_unlock();*/
         free(threadId);
+        mem_arena_exit(csound);
         return 0UL;
       }
       /*csound_global_mutex_unlock();*/
@@ -1646,6 +1765,178 @@ unsigned long kperfThread(void * cs)
     }
 }
 
+/* --multi-instance: consecutive instances of one instrument run in
+   lockstep, opcode by opcode, so that an opcode with a multi-instance
+   entry (OENTRY.mopadr) processes all of them in one call */
+#define MULTI_RUN (64)
+
+static int arg_uses(ARG *arg, void *var)
+{
+    for ( ; arg != NULL; arg = arg->next)
+      if (arg->type == ARG_GLOBAL && arg->argPtr == var) return 1;
+    return 0;
+}
+
+/* does any global in arg (written by opcode a) appear in another opcode? */
+static int global_shared(INSTRTXT *tp, OPTXT *a, ARG *arg)
+{
+    OPTXT *b;
+    for ( ; arg != NULL; arg = arg->next) {
+      if (arg->type != ARG_GLOBAL) continue;
+      for (b = tp->nxtop; b != NULL; b = b->nxtop)
+        if (b != a && (arg_uses(b->t.outArgs, arg->argPtr) ||
+                       arg_uses(b->t.inArgs, arg->argPtr)))
+          return 1;
+    }
+    return 0;
+}
+
+/* Lockstep reorders opcodes of different instances, so it is only
+   allowed when the instances cannot see each other within a k-cycle:
+   no global variable or zak, table or channel state written by one
+   opcode and used by another, at most one opcode touching spout (the
+   order of the sums), no printing, stack or user-defined opcodes, and
+   nothing flagged SQ: shared random sequences and scheduled events
+   would see the calls in a different order. */
+static int instr_multi_ok(INSTRTXT *tp)
+{
+    static const int cls[3][2] = { { ZR, ZW }, { TR, TW }, { _CR, _CW } };
+    int used[3] = { 0, 0, 0 }, written[3] = { 0, 0, 0 }, spout = 0;
+    OPTXT *a;
+    int i;
+
+    for (a = tp->nxtop; a != NULL; a = a->nxtop) {
+      OENTRY *ep = a->t.oentry;
+      if (ep == NULL) continue;
+      if (ep->useropinfo != NULL || (ep->flags & (SK | WR | SQ | _QQ)))
+        return -1;
+      for (i = 0; i < 3; i++) {
+        if (ep->flags & (cls[i][0] | cls[i][1])) used[i]++;
+        if (ep->flags & cls[i][1]) written[i]++;
+      }
+      if (ep->flags & IB) spout++;
+      if (global_shared(tp, a, a->t.outArgs) ||
+          ((ep->flags & WI) && global_shared(tp, a, a->t.inArgs)))
+        return -1;
+    }
+    for (i = 0; i < 3; i++)
+      if (written[i] && used[i] > 1) return -1;
+    return spout > 1 ? -1 : 1;
+}
+
+/* does any global in arg appear? */
+static int arg_global(ARG *arg)
+{
+    for ( ; arg != NULL; arg = arg->next)
+      if (arg->type == ARG_GLOBAL) return 1;
+    return 0;
+}
+
+/* Does an instrument or user-defined opcode write state that outlives
+   its notes: a global variable, zak, a table or a channel (the classes
+   of instr_multi_ok), or a shared random sequence?  Code outside the
+   instruments is run again by every instance, so it is not counted. */
+PUBLIC int csoundOrchestraSharesState(CSOUND *csound)
+{
+    INSTRTXT *tp;
+    OPTXT *a;
+
+    for (tp = csound->engineState.instxtanchor.nxtinstxt; tp != NULL;
+         tp = tp->nxtinstxt) {
+      if (tp == csound->instr0) continue;
+      for (a = tp->nxtop; a != NULL; a = a->nxtop) {
+        OENTRY *ep = a->t.oentry;
+        if (ep == NULL) continue;
+        if ((ep->flags & (ZW | TW | _CW | SQ)) || arg_global(a->t.outArgs) ||
+            ((ep->flags & WI) && arg_global(a->t.inArgs)))
+          return 1;
+      }
+    }
+    return 0;
+}
+
+/* Consecutive instances after ip that can join it in lockstep: same
+   instrument, initialised, full-size k-period with no sample-accurate
+   offsets.  *nxt is left at the first instance not taken. */
+static int multi_collect(CSOUND *csound, INSDS *ip, INSDS **run,
+                         INSDS **nxt, double time_end)
+{
+    int n = 0;
+    do {
+      if (UNLIKELY(csound->oparms->sampleAccurate &&
+                   ip->offtim > 0 && time_end > ip->offtim))
+        ip->ksmps_no_end = ip->no_end;
+      if (ATOMIC_GET(ip->init_done) != 1 ||
+          ip->ksmps != csound->ksmps ||
+          ip->ksmps_offset != 0 || ip->ksmps_no_end != 0)
+        break;
+      run[n++] = ip;
+    } while (n < MULTI_RUN && (ip = ip->nxtact) != NULL &&
+             ip->insno == run[0]->insno);
+    *nxt = n ? run[n-1]->nxtact : ip;
+    return n;
+}
+
+/* Perform one k-period of n instances, opcode position by opcode
+   position.  Instances that branch elsewhere simply wait until the
+   first live instance reaches their position; at each position the
+   instances run in chain order, as they would one after another. */
+static void multi_perf(CSOUND *csound, INSDS **run, int n)
+{
+    OPDS  *cur[MULTI_RUN], *grp[MULTI_RUN];
+    int   lane[MULTI_RUN];
+    int   v, w, m, k;
+
+    for (v = 0; v < n; v++) {
+      run[v]->spin = csound->spin;
+      run[v]->spout = csound->spraw;
+      run[v]->kcounter = csound->kcounter;
+      cur[v] = run[v]->nxtp;
+    }
+    v = 0;
+    while (1) {
+      OPTXT  *pos;
+      OENTRY *ep;
+      int    batch;
+      while (v < n && (cur[v] == NULL || !run[v]->actflg)) v++;
+      if (v == n) break;
+      pos = cur[v]->optext;
+      ep = pos->t.oentry;
+      batch = (ep->mopadr != NULL);
+      for (m = 0, w = v; w < n; w++) {
+        if (cur[w] == NULL) continue;
+        if (!run[w]->actflg) { cur[w] = NULL; continue; }
+        if (cur[w]->optext != pos) continue;
+        if (cur[w]->opadr != ep->kopadr) batch = 0;
+        lane[m] = w;
+        grp[m++] = cur[w];
+      }
+      if (batch && m > 1) {
+        int error;
+        for (k = 0; k < m; k++) grp[k]->insdshead->pds = grp[k];
+        error = (*ep->mopadr)(csound, (void **) grp, m);
+        for (k = 0; k < m; k++) {
+          w = lane[k];
+          cur[w] = error ? NULL : grp[k]->insdshead->pds->nxtp;
+        }
+      }
+      else {
+        for (k = 0; k < m; k++) {
+          OPDS *opstart = grp[k];
+          w = lane[k];
+          if (UNLIKELY(!run[w]->actflg)) {  /* turned off by an earlier one */
+            cur[w] = NULL;
+            continue;
+          }
+          opstart->insdshead->pds = opstart;
+          if ((*opstart->opadr)(csound, opstart) != 0)
+            cur[w] = NULL;
+          else cur[w] = opstart->insdshead->pds->nxtp;
+        }
+      }
+    }
+}
+
 int kperf_nodebug(CSOUND *csound)
 {
     INSDS *ip;
@@ -1701,9 +1992,23 @@ int kperf_nodebug(CSOUND *csound)
       else {
         int done;
         double time_end = (csound->ksmps+csound->icurTime)/csound->esr;
+        int multi = csound->oparms->multiInstance;
 
         while (ip != NULL) {                /* for each instr active:  */
           INSDS *nxt = ip->nxtact;
+          if (multi && nxt != NULL && nxt->insno == ip->insno) {
+            INSTRTXT *tp = ip->instr;
+            if (UNLIKELY(tp->multi == 0)) tp->multi = instr_multi_ok(tp);
+            if (tp->multi > 0) {
+              INSDS *run[MULTI_RUN], *rnxt;
+              int n = multi_collect(csound, ip, run, &rnxt, time_end);
+              if (n > 1) {
+                multi_perf(csound, run, n);
+                ip = rnxt;
+                continue;
+              }
+            }
+          }
           if (UNLIKELY(csound->oparms->sampleAccurate &&
                        ip->offtim > 0                 &&
                        time_end > ip->offtim)) {
@@ -1721,50 +2026,17 @@ int kperf_nodebug(CSOUND *csound)
             ip->spout = csound->spraw;
             ip->kcounter =  csound->kcounter;
             if (ip->ksmps == csound->ksmps) {
-              while (error == 0 &&
+              if (ip->perf != NULL)
+                opstart = perf_table_run(csound, ip, &error);
+              while (error == 0 && opstart != NULL &&
                      (opstart = opstart->nxtp) != NULL &&
                      ip->actflg) {
                 opstart->insdshead->pds = opstart;
                 error = (*opstart->opadr)(csound, opstart); /* run each opcode */
                 opstart = opstart->insdshead->pds;
               }
-            } else {
-                int error = 0;
-                int i, n = csound->nspout, start = 0;
-                int lksmps = ip->ksmps;
-                int incr = csound->nchnls*lksmps;
-                int offset =  ip->ksmps_offset;
-                int early = ip->ksmps_no_end;
-                OPDS  *opstart;
-                ip->spin = csound->spin;
-                ip->spout = csound->spraw;
-                ip->kcounter =  csound->kcounter*csound->ksmps/lksmps;
-
-                /* we have to deal with sample-accurate code
-                   whole CS_KSMPS blocks are offset here, the
-                   remainder is left to each opcode to deal with.
-                */
-                while (offset >= lksmps) {
-                  offset -= lksmps;
-                  start += csound->nchnls;
-                }
-                ip->ksmps_offset = offset;
-                if (UNLIKELY(early)) {
-                  n -= (early*csound->nchnls);
-                  ip->ksmps_no_end = early % lksmps;
-                }
-
-                for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
-                  opstart = (OPDS*) ip;
-                  while (error ==  0 && (opstart = opstart->nxtp) != NULL
-                         && ip->actflg) {
-                    opstart->insdshead->pds = opstart;
-                    error = (*opstart->opadr)(csound, opstart); /* run each opcode */
-                    opstart = opstart->insdshead->pds;
-                  }
-                  ip->kcounter++;
-                }
-            }
+            } else
+              local_ksmps_perf(csound, ip, &error);
           }
           /*else csound->Message(csound, "time %f\n",
                                  csound->kcounter/csound->ekr);*/
@@ -2009,33 +2281,23 @@ int kperf_debug(CSOUND *csound)
             if (ip->ksmps == csound->ksmps) {
                 opcode_perf_debug(csound, data, ip);
             } else { /* when instrument has local ksmps */
-              int i, n = csound->nspout, start = 0;
+              LKSMPS_SCHED sched;
               int lksmps = ip->ksmps;
-              int incr = csound->nchnls*lksmps;
-              int offset =  ip->ksmps_offset;
-              int early = ip->ksmps_no_end;
-              ip->spin = csound->spin;
-              ip->spout = csound->spraw;
-              ip->kcounter =  csound->kcounter*csound->ksmps/lksmps;
-
-              /* we have to deal with sample-accurate code
-                   whole CS_KSMPS blocks are offset here, the
-                   remainder is left to each opcode to deal with.
-                */
-              while (offset >= lksmps) {
-                offset -= lksmps;
-                start += csound->nchnls;
-              }
-              ip->ksmps_offset = offset;
-              if (UNLIKELY(early)) {
-                n -= (early*csound->nchnls);
-                ip->ksmps_no_end = early % lksmps;
+              int incr = csound->nchnls*lksmps, b;
+              local_ksmps_schedule(&sched, csound->ksmps, lksmps,
+                                   ip->ksmps_offset, ip->ksmps_no_end);
+              local_ksmps_spout(csound, &sched);
+              ip->spin = csound->spin + sched.first*incr;
+              ip->spout = csound->spraw + sched.first*incr;
+              ip->kcounter =
+                csound->kcounter*csound->ksmps/lksmps + sched.first;
+              for (b = 0; b < sched.count;
+                   b++, ip->spin+=incr, ip->spout+=incr) {
+                ip->ksmps_offset = (b == 0 ? sched.offset : 0);
+                ip->ksmps_no_end = (b == sched.count-1 ? sched.early : 0);
+                opcode_perf_debug(csound, data, ip);
+                ip->kcounter++;
               }
-
-              for (i=start; i < n; i+=incr, ip->spin+=incr, ip->spout+=incr) {
-                  opcode_perf_debug(csound, data, ip);
-                  ip->kcounter++;
-                }
             }
           }
           ip->ksmps_offset = 0; /* reset sample-accuracy offset */
@@ -2350,6 +2612,11 @@ PUBLIC MYFLT csoundGetSpoutSample(CSOUND *csound, int frame, int channel)
     return csound->spout[index];
 }
 
+PUBLIC void csoundWriteSpout(CSOUND *csound)
+{
+    csound->spoutran(csound);
+}
+
 PUBLIC const char *csoundGetOutputName(CSOUND *csound)
 {
     return (const char*) csound->oparms_.outfilename;
@@ -3127,6 +3394,8 @@ PUBLIC int csoundAppendOpcode(CSOUND *csound,
     tmpEntry.iopadr     = iopadr;
     tmpEntry.kopadr     = kopadr;
     tmpEntry.aopadr     = aopadr;
+    tmpEntry.useropinfo = NULL;
+    tmpEntry.mopadr     = NULL;
     err = opcode_list_new_oentry(csound, &tmpEntry);
     if (UNLIKELY(err))
       csoundErrorMsg(csound, Str("Failed to allocate new opcode entry."));
@@ -3208,6 +3477,22 @@ static void reset(CSOUND *csound)
     uintptr_t end, start;
     int n = 0;
 
+    /* the -j threads wait for the next k-cycle unless csoundPerform()
+       ran to the end of the score: release and join them before their
+       state goes */
+    if (csound->multiThreadedThreadInfo != NULL) {
+      THREADINFO *t;
+      if (csound->multiThreadedComplete != 1) {
+        csound->multiThreadedComplete = 1;
+        csound->WaitBarrier(csound->barrier1);
+      }
+      for (t = csound->multiThreadedThreadInfo; t != NULL; t = t->next)
+        csound->JoinThread(t->threadId);
+      csound->multiThreadedThreadInfo = NULL;
+      csound->DestroyBarrier(csound->barrier1);
+      csound->DestroyBarrier(csound->barrier2);
+    }
+
     csoundCleanup(csound);
 
     /* call registered reset callbacks */
@@ -3241,6 +3526,12 @@ static void reset(CSOUND *csound)
     /* delete temporary files created by this Csound instance */
     remove_tmpfiles(csound);
     rlsmemfiles(csound);
+    rlssndmaps(csound);
+    /* the -j park lock is not in Csound's memory pool */
+    if (csound->dag_park_cond != NULL) {
+      csoundDestroyCondVar(csound->dag_park_cond);
+      csoundDestroyMutex(csound->dag_park_lock);
+    }
 
      while (csound->filedir[n])        /* Clear source directory */
        csound->Free(csound,csound->filedir[n++]);
@@ -3276,6 +3567,9 @@ static void reset(CSOUND *csound)
     csound->spinlock = saved_env->spinlock;
     csound->spoutlock = saved_env->spoutlock;
     csound->spinlock1= saved_env->spinlock1;
+    csound->open_files_lock = saved_env->open_files_lock;
+    csound->pvfiles_lock = saved_env->pvfiles_lock;
+    csound->sndmaps_lock = saved_env->sndmaps_lock;
 #endif
     csound->enableHostImplementedMIDIIO = saved_env->enableHostImplementedMIDIIO;
     memcpy(&(csound->exitjmp), &(saved_env->exitjmp), sizeof(jmp_buf));
@@ -3357,6 +3651,9 @@ PUBLIC void csoundReset(CSOUND *csound)
       csoundSpinLockInit(&csound->spinlock);
       csoundSpinLockInit(&csound->memlock);
       csoundSpinLockInit(&csound->spinlock1);
+      csoundSpinLockInit(&csound->open_files_lock);
+      csoundSpinLockInit(&csound->pvfiles_lock);
+      csoundSpinLockInit(&csound->sndmaps_lock);
       if (UNLIKELY(O->odebug))
         csound->Message(csound,"init spinlocks\n");
     }
@@ -3940,6 +4237,7 @@ typedef struct opcodeDeinit_s {
   void    *p;
   int     (*func)(CSOUND *, void *);
   void    *nxt;
+  int     threadsafe;   /* registered by an opcode flagged TD */
 } opcodeDeinit_t;
 
 /**
@@ -3958,11 +4256,17 @@ int csoundRegisterDeinitCallback(CSOUND *csound, void *p,
     INSDS           *ip = ((OPDS*) p)->insdshead;
     opcodeDeinit_t  *dp = (opcodeDeinit_t*) malloc(sizeof(opcodeDeinit_t));
 
-    (void) csound;
+    OPDS            *ids = csound->ids;
+
     if (UNLIKELY(dp == NULL))
       return CSOUND_MEMORY;
     dp->p = p;
     dp->func = func;
+    /* p need not be an OPDS (fout registers its file references), so
+       the flag is taken from the opcode being initialised */
+    dp->threadsafe = (ids != NULL && ids->optext != NULL &&
+                      ids->optext->t.oentry != NULL &&
+                      (ids->optext->t.oentry->flags & TD) != 0);
     dp->nxt = ip->nxtd;
     ip->nxtd = dp;
     return CSOUND_SUCCESS;
@@ -4007,6 +4311,20 @@ int csoundDeinitialiseOpcodes(CSOUND *csound, INSDS *ip)
     return err;
 }
 
+/* May the deinit callbacks of ip run on another thread?  Only if every
+   one was registered by an opcode flagged TD. */
+int csoundDeinitThreadSafe(CSOUND *csound, INSDS *ip)
+{
+    opcodeDeinit_t  *dp;
+
+    (void) csound;
+    for (dp = (opcodeDeinit_t*) ip->nxtd; dp != NULL;
+         dp = (opcodeDeinit_t*) dp->nxt)
+      if (!dp->threadsafe)
+        return 0;
+    return 1;
+}
+
 /**
  * Returns the name of the opcode of which the data structure
  * is pointed to by 'p'.
@@ -470,6 +470,10 @@ PUBLIC int csoundStart(CSOUND *csound) // DEBUG
 
       csp_barrier_alloc(csound, &(csound->barrier1), O->numThreads);
       csp_barrier_alloc(csound, &(csound->barrier2), O->numThreads);
+      if (O->parkSpin > 0) {
+        csound->dag_park_lock = csoundCreateMutex(0);
+        csound->dag_park_cond = csoundCreateCondVar();
+      }
 
       csound->multiThreadedComplete = 0;
 
@@ -556,6 +556,14 @@ PUBLIC void csoundCondSignal(void* condVar) {
         pthread_cond_signal(condVar);
 }
 
+PUBLIC void csoundDestroyCondVar(void* condVar)
+{
+  if (condVar != NULL) {
+    pthread_cond_destroy((pthread_cond_t*) condVar);
+    free(condVar);
+  }
+}
+
 /* ------------------------------------------------------------------------ */
 
 #elif defined(WIN32)
@@ -781,6 +789,12 @@ PUBLIC void csoundCondSignal(void* condVar) {
     WakeConditionVariable(cv);
 }
 
+PUBLIC void csoundDestroyCondVar(void* condVar)
+{
+    /* Windows condition variables need no cleanup */
+    free(condVar);
+}
+
 // REMOVE FOLLOWING BARRIER DEFINITION WINDOWS SUPPORT LIMITED to WIN 8.1+
 typedef struct barrier {
     CRITICAL_SECTION* mut;
@@ -960,6 +974,10 @@ PUBLIC void csoundCondSignal(void* condVar) {
  // notImplementedWarning_("csoundCreateCondSignal");
 }
 
+PUBLIC void csoundDestroyCondVar(void* condVar) {
+ // notImplementedWarning_("csoundDestroyCondVar");
+}
+
 PUBLIC long csoundRunCommand(const char * const *argv, int noWait) {
   //notImplementedWarning_("csoundRunCommand");
     return 0;
@@ -21,6 +21,7 @@
 
 #include "csoundCore.h"
 #include "csound_orc.h"
+#include "bus.h"
 #include <stdlib.h>
 
 #ifdef USE_DOUBLE
@@ -53,74 +54,103 @@ void set_channel_data_ptr(CSOUND *csound, const char *name,
 enum {INPUT_MESSAGE=1, READ_SCORE, SCORE_EVENT, SCORE_EVENT_ABS,
       TABLE_COPY_OUT, TABLE_COPY_IN, TABLE_SET, MERGE_STATE, KILL_INSTANCE};
 
-/* MAX QUEUE SIZE */
+/* MAX QUEUE SIZE (a power of two) */
 #define API_MAX_QUEUE 1024
 /* ARG LIST ALIGNMENT */
 #define ARG_ALIGN 8
-
-/* Message queue structure */
+/* ARGS STORED IN THE SLOT ITSELF */
+#define API_MSG_ARGS 256
+
+/* Message queue structure.
+   This is a bounded multi-producer queue of preallocated slots
+   (after D. Vyukov): a producer claims slot number pos by advancing
+   msg_queue_wput when the slot's seq is pos, fills it and publishes it
+   by setting seq to pos+1; the reader hands it back by setting seq to
+   pos+API_MAX_QUEUE.  Arguments are copied into the slot, so nothing
+   is allocated on the way in or out.  Arguments longer than
+   API_MSG_ARGS are refused by the non-blocking calls; the blocking
+   ones put them in a buffer kept by the slot, grown by the producer.
+*/
 typedef struct _message_queue {
-  int64_t message;  /* message id */
-  char *args;   /* args, arg pointers */
-  int64_t rtn;  /* return value */
+  volatile long seq;       /* sequence number of the slot */
+  int32_t message;         /* message id */
+  int32_t heapsiz;         /* size of heap buffer */
+  char *heap;              /* buffer for long args */
+  char *args;              /* args, either in buf or heap */
+  int64_t rtn;             /* return value */
+  int64_t buf[API_MSG_ARGS/sizeof(int64_t)];  /* inline args */
 } message_queue_t;
 
-
-/* atomicGetAndIncrementWithModulus */
-static long atomicGet_Incr_Mod(volatile long* val, long mod) {
-  volatile long oldVal, newVal;
-  do {
-    oldVal = *val;
-    newVal = (oldVal + 1) % mod;
-  } while (ATOMIC_CMP_XCH(val, newVal, oldVal));
-  return oldVal;
-}
-
 /* called by csoundCreate() at the start
    and also by csoundStart() to cover de-allocation
    by reset
 */
 void allocate_message_queue(CSOUND *csound) {
   if (csound->msg_queue == NULL) {
-    int i;
-    csound->msg_queue = (message_queue_t **)
-      csound->Calloc(csound, sizeof(message_queue_t*)*API_MAX_QUEUE);
-    for (i = 0; i < API_MAX_QUEUE; i++) {
-      csound->msg_queue[i] =
-        (message_queue_t*)
-        csound->Calloc(csound, sizeof(message_queue_t));
-    }
+    long i;
+    csound->msg_queue = (message_queue_t *)
+      csound->Calloc(csound, sizeof(message_queue_t)*API_MAX_QUEUE);
+    for (i = 0; i < API_MAX_QUEUE; i++)
+      csound->msg_queue[i].seq = i;
+    csound->msg_queue_wput = 0;
+    csound->msg_queue_rstart = 0;
   }
 }
 
+/* Claim a slot and copy args, followed by data, into it.
+   If the queue is full this spins when block is set, otherwise
+   it counts the refusal and returns NULL, as it does for args
+   that would not fit in the slot. */
+static message_queue_t *message_put(CSOUND *csound, int32_t message,
+                                    const char *args, int argsiz,
+                                    const void *data, int datasiz,
+                                    int block) {
+  message_queue_t *msg;
+  long pos, diff;
+  if (csound->msg_queue == NULL) return NULL;
+  if (!block && argsiz + datasiz > API_MSG_ARGS) {
+    ATOMIC_INCR(csound->msg_queue_full);
+    return NULL;
+  }
+  pos = ATOMIC_GET(csound->msg_queue_wput);
+  while (1) {
+    msg = &csound->msg_queue[pos & (API_MAX_QUEUE-1)];
+    diff = (long) ((unsigned long) ATOMIC_GET(msg->seq) - (unsigned long) pos);
+    if (diff == 0) {
+      long next = pos + 1;
+      if (!ATOMIC_CMP_XCH(&csound->msg_queue_wput, next, pos)) break;
+    }
+    else if (diff < 0) {        /* full: the reader is a lap behind */
+      if (!block) {
+        ATOMIC_INCR(csound->msg_queue_full);
+        return NULL;
+      }
+    }
+    pos = ATOMIC_GET(csound->msg_queue_wput);
+  }
+  msg->message = message;
+  if (argsiz + datasiz <= API_MSG_ARGS)
+    msg->args = (char *) msg->buf;
+  else {
+    /* the reader never frees, so long args are only paid for here */
+    if (msg->heapsiz < argsiz + datasiz) {
+      msg->heap = csound->ReAlloc(csound, msg->heap, argsiz + datasiz);
+      msg->heapsiz = argsiz + datasiz;
+    }
+    msg->args = msg->heap;
+  }
+  memcpy(msg->args, args, argsiz);
+  if (datasiz) memcpy(msg->args + argsiz, data, datasiz);
+  ATOMIC_SET(msg->seq, pos + 1);
+  return msg;
+}
 
 /* enqueue should be called by the relevant API function */
 void *message_enqueue(CSOUND *csound, int32_t message, char *args,
                       int argsiz) {
-  if(csound->msg_queue != NULL) {
-    int64_t *rtn;
-    volatile long items;
-
-    /* block if queue is full */
-    do {
-      items = ATOMIC_GET(csound->msg_queue_items);
-    } while(items >= API_MAX_QUEUE);
-
-    message_queue_t* msg =
-      csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wget,
-                                           API_MAX_QUEUE)];
-    msg->message = message;
-    if(msg->args != NULL)
-      csound->Free(csound, msg->args);
-    msg->args = (char *)csound->Calloc(csound, argsiz);
-    memcpy(msg->args, args, argsiz);
-    rtn = &msg->rtn;
-    csound->msg_queue[atomicGet_Incr_Mod(&csound->msg_queue_wput,
-                                         API_MAX_QUEUE)] = msg;
-    ATOMIC_INCR(csound->msg_queue_items);
-    return (void *) rtn;
-  }
-  else return NULL;
+  message_queue_t *msg = message_put(csound, message, args, argsiz,
+                                     NULL, 0, 1);
+  return msg != NULL ? (void *) &msg->rtn : NULL;
 }
 
 /* dequeue should be called by kperf_*()
@@ -129,11 +159,11 @@ void *message_enqueue(CSOUND *csound, int32_t message, char *args,
 void message_dequeue(CSOUND *csound) {
   if(csound->msg_queue != NULL) {
     long rp = csound->msg_queue_rstart;
-    long items = csound->msg_queue_items;
-    long rend = rp + items;
+    long rend = rp + API_MAX_QUEUE;
 
-    while(rp < rend) {
-      message_queue_t* msg = csound->msg_queue[rp % API_MAX_QUEUE];
+    while(rp != rend) {
+      message_queue_t* msg = &csound->msg_queue[rp & (API_MAX_QUEUE-1)];
+      if (ATOMIC_GET(msg->seq) != rp + 1) break;   /* not yet published */
       switch(msg->message) {
       case INPUT_MESSAGE:
         {
@@ -151,33 +181,30 @@ void message_dequeue(CSOUND *csound) {
       case SCORE_EVENT:
         {
           char type;
-          const MYFLT *pfields;
           long numFields;
           type = msg->args[0];
-          memcpy(&pfields, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          memcpy(&numFields, msg->args + ARG_ALIGN*2,
+          memcpy(&numFields, msg->args + ARG_ALIGN,
                  sizeof(long));
 
-          csoundScoreEventInternal(csound, type, pfields, numFields);
+          csoundScoreEventInternal(csound, type,
+                                   (MYFLT *) (msg->args + ARG_ALIGN*2),
+                                   numFields);
         }
         break;
       case SCORE_EVENT_ABS:
         {
           char type;
-          const MYFLT *pfields;
           long numFields;
           double ofs;
           type = msg->args[0];
-          memcpy(&pfields, msg->args + ARG_ALIGN,
-                 sizeof(MYFLT *));
-          memcpy(&numFields, msg->args + ARG_ALIGN*2,
+          memcpy(&numFields, msg->args + ARG_ALIGN,
                  sizeof(long));
-          memcpy(&ofs, msg->args + ARG_ALIGN*3,
+          memcpy(&ofs, msg->args + ARG_ALIGN*2,
                  sizeof(double));
 
-          csoundScoreEventAbsoluteInternal(csound, type, pfields, numFields,
-                                             ofs);
+          csoundScoreEventAbsoluteInternal(csound, type,
+                                           (MYFLT *) (msg->args + ARG_ALIGN*3),
+                                           numFields, ofs);
         }
         break;
       case TABLE_COPY_OUT:
@@ -244,10 +271,10 @@ void message_dequeue(CSOUND *csound) {
         break;
       }
       msg->message = 0;
+      ATOMIC_SET(msg->seq, rp + API_MAX_QUEUE);   /* hand back the slot */
       rp += 1;
     }
-    ATOMIC_SUB(csound->msg_queue_items, items);
-    csound->msg_queue_rstart = rp % API_MAX_QUEUE;
+    csound->msg_queue_rstart = rp;
   }
 }
 
@@ -279,43 +306,45 @@ static inline void csoundTableCopyIn_enqueue(CSOUND *csound, int table,
   message_enqueue(csound,TABLE_COPY_IN, args, argsize);
 }
 
-static inline void csoundTableSet_enqueue(CSOUND *csound, int table, int index,
-                                          MYFLT value)
+static inline int csoundTableSet_enqueue(CSOUND *csound, int table, int index,
+                                         MYFLT value, int block)
 {
   const int argsize = ARG_ALIGN*3;
   char args[ARG_ALIGN*3];
   memcpy(args, &table, sizeof(int));
   memcpy(args+ARG_ALIGN, &index, sizeof(int));
   memcpy(args+2*ARG_ALIGN, &value, sizeof(MYFLT));
-  message_enqueue(csound,TABLE_SET, args, argsize);
+  return message_put(csound, TABLE_SET, args, argsize, NULL, 0, block)
+    != NULL ? CSOUND_SUCCESS : CSOUND_ERROR;
 }
 
-
-static inline int64_t *csoundScoreEvent_enqueue(CSOUND *csound, char type,
-                                                const MYFLT *pfields,
-                                                long numFields)
+/* the pfields are copied after the other args */
+static inline int csoundScoreEvent_enqueue(CSOUND *csound, char type,
+                                           const MYFLT *pfields,
+                                           long numFields, int block)
 {
-  const int argsize = ARG_ALIGN*3;
-  char args[ARG_ALIGN*3];
+  const int argsize = ARG_ALIGN*2;
+  char args[ARG_ALIGN*2];
   args[0] = type;
-  memcpy(args+ARG_ALIGN, &pfields, sizeof(MYFLT *));
-  memcpy(args+2*ARG_ALIGN, &numFields, sizeof(long));
-  return message_enqueue(csound,SCORE_EVENT, args, argsize);
+  memcpy(args+ARG_ALIGN, &numFields, sizeof(long));
+  return message_put(csound, SCORE_EVENT, args, argsize,
+                     pfields, numFields*sizeof(MYFLT), block)
+    != NULL ? CSOUND_SUCCESS : CSOUND_ERROR;
 }
 
 
-static inline int64_t *csoundScoreEventAbsolute_enqueue(CSOUND *csound, char type,
-                                                        const MYFLT *pfields,
-                                                        long numFields,
-                                                        double time_ofs)
+static inline void csoundScoreEventAbsolute_enqueue(CSOUND *csound, char type,
+                                                    const MYFLT *pfields,
+                                                    long numFields,
+                                                    double time_ofs)
 {
-  const int argsize = ARG_ALIGN*4;
-  char args[ARG_ALIGN*4];
+  const int argsize = ARG_ALIGN*3;
+  char args[ARG_ALIGN*3];
   args[0] = type;
-  memcpy(args+ARG_ALIGN, &pfields, sizeof(MYFLT *));
-  memcpy(args+2*ARG_ALIGN, &numFields, sizeof(long));
-  memcpy(args+3*ARG_ALIGN, &time_ofs, sizeof(double));
-  return message_enqueue(csound,SCORE_EVENT_ABS, args, argsize);
+  memcpy(args+ARG_ALIGN, &numFields, sizeof(long));
+  memcpy(args+2*ARG_ALIGN, &time_ofs, sizeof(double));
+  message_put(csound, SCORE_EVENT_ABS, args, argsize,
+              pfields, numFields*sizeof(MYFLT), 1);
 }
 
 /* this is to be called from
@@ -462,13 +491,29 @@ void csoundTableCopyInAsync(CSOUND *csound, int table, MYFLT *ptable){
 
 void csoundTableSetAsync(CSOUND *csound, int table, int index, MYFLT value)
 {
-  csoundTableSet_enqueue(csound, table, index, value);
+  csoundTableSet_enqueue(csound, table, index, value, 1);
+}
+
+int csoundTryTableSetAsync(CSOUND *csound, int table, int index, MYFLT value)
+{
+  return csoundTableSet_enqueue(csound, table, index, value, 0);
 }
 
 void csoundScoreEventAsync(CSOUND *csound, char type,
                            const MYFLT *pfields, long numFields)
 {
-  csoundScoreEvent_enqueue(csound, type, pfields, numFields);
+  csoundScoreEvent_enqueue(csound, type, pfields, numFields, 1);
+}
+
+int csoundTryScoreEventAsync(CSOUND *csound, char type,
+                             const MYFLT *pfields, long numFields)
+{
+  return csoundScoreEvent_enqueue(csound, type, pfields, numFields, 0);
+}
+
+long csoundGetAsyncQueueFull(CSOUND *csound)
+{
+  return ATOMIC_GET(csound->msg_queue_full);
 }
 
 void csoundScoreEventAbsoluteAsync(CSOUND *csound, char type,
@@ -557,6 +602,77 @@ void csoundSetControlChannel(CSOUND *csound, const char *name, MYFLT val){
 #endif
 }
 
+/* control channel access through a handle from csoundGetChannelHandle() */
+
+static inline MYFLT channel_load(CHNENTRY *pp)
+{
+  union {
+    MYFLT d;
+    MYFLT_INT_TYPE i;
+  } x;
+#if defined(MSVC)
+  x.i = InterlockedExchangeAdd64((MYFLT_INT_TYPE *) pp->data, 0);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+  x.i = __atomic_load_n((MYFLT_INT_TYPE *) pp->data, __ATOMIC_SEQ_CST);
+#else
+  csoundSpinLock(&pp->lock);
+  x.d = *pp->data;
+  csoundSpinUnLock(&pp->lock);
+#endif
+  return x.d;
+}
+
+static inline void channel_store(CHNENTRY *pp, MYFLT val)
+{
+  union {
+    MYFLT d;
+    MYFLT_INT_TYPE i;
+  } x;
+  x.d = val;
+#if defined(MSVC)
+  InterlockedExchange64((MYFLT_INT_TYPE *) pp->data, x.i);
+#elif defined(HAVE_ATOMIC_BUILTIN)
+  __atomic_store_n((MYFLT_INT_TYPE *) pp->data, x.i, __ATOMIC_SEQ_CST);
+#else
+  csoundSpinLock(&pp->lock);
+  *pp->data = x.d;
+  csoundSpinUnLock(&pp->lock);
+#endif
+}
+
+MYFLT csoundGetControlChannelByHandle(CSOUND *csound, CHANNEL_HANDLE *h)
+{
+  IGN(csound);
+  return h != NULL ? channel_load((CHNENTRY*) h) : FL(0.0);
+}
+
+void csoundSetControlChannelByHandle(CSOUND *csound, CHANNEL_HANDLE *h,
+                                     MYFLT val)
+{
+  IGN(csound);
+  if (h != NULL)
+    channel_store((CHNENTRY*) h, val);
+}
+
+void csoundGetControlChannels(CSOUND *csound, CHANNEL_HANDLE **h,
+                              MYFLT *vals, int n)
+{
+  int i;
+  IGN(csound);
+  for (i = 0; i < n; i++)
+    vals[i] = h[i] != NULL ? channel_load((CHNENTRY*) h[i]) : FL(0.0);
+}
+
+void csoundSetControlChannels(CSOUND *csound, CHANNEL_HANDLE **h,
+                              const MYFLT *vals, int n)
+{
+  int i;
+  IGN(csound);
+  for (i = 0; i < n; i++)
+    if (h[i] != NULL)
+      channel_store((CHNENTRY*) h[i], vals[i]);
+}
+
 void csoundGetAudioChannel(CSOUND *csound, const char *name, MYFLT *samples)
 {
 
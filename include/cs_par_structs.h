@@ -67,4 +67,18 @@ typedef struct _watchList {
                      sizeof(struct _watchList *))) / sizeof(uint8_t)];
 } watchList;
 
+/* Sparse dependencies of a task slot: the tasks it waits for (pred) and
+   the tasks waiting for it (succ).  order is the position of the slot in
+   the active chain, which fixes the direction of every edge.  ninst
+   counts the instances batched into the task. */
+typedef struct _taskDeps {
+  int     npred, maxpred;
+  taskID  *pred;
+  int     nsucc, maxsucc;
+  taskID  *succ;
+  int     order;
+  int     stamp;
+  int     ninst;
+} taskDeps;
+
 #endif
@@ -467,6 +467,7 @@ extern "C" {
   typedef struct CSOUND_  CSOUND;
   typedef struct windat_  WINDAT;
   typedef struct xyindat_ XYINDAT;
+  typedef struct channelEntry_s CHANNEL_HANDLE;
 
 
   /**
@@ -1149,6 +1150,19 @@ extern "C" {
                                                      int, int, int));
 #endif
 
+  /**
+   * Reports buffer underruns of the asynchronous diskin2 streams
+   * (realtime mode) playing the sound file name, or of all of them if
+   * name is NULL.  The name may be the full path or its last component.
+   * Sets *underruns to the k-cycles that ran short of data and *frames to
+   * the frames played as silence instead, summed over the matching
+   * streams; either pointer may be NULL.  Returns the number of matching
+   * streams.  Only streams still playing are counted: diskin2 prints the
+   * totals of a stream in a warning when it ends.
+   */
+  PUBLIC int csoundGetDiskinUnderruns(CSOUND *csound, const char *name,
+                                      uint32_t *underruns, uint32_t *frames);
+
   /** @}*/
   /** @defgroup RTAUDIOIO Realtime Audio I/O
    *
@@ -1244,6 +1258,14 @@ extern "C" {
    */
   PUBLIC MYFLT csoundGetSpoutSample(CSOUND *csound, int frame, int channel);
 
+  /**
+   * Sends the contents of spout to the audio output, as the end of each
+   * k-cycle does, for a host that fills spout itself (for example with
+   * audio rendered by other instances).  Meant for use after
+   * csoundPerformKsmps() has reported the end of the score.
+   */
+  PUBLIC void csoundWriteSpout(CSOUND *csound);
+
   /**
    * Return pointer to user data pointer for real time audio input.
    */
@@ -1465,6 +1487,21 @@ extern "C" {
    */
   PUBLIC double csoundGetScoreTime(CSOUND *);
 
+  /**
+   * Returns the number of the score section being performed, counting
+   * from 1.  With --render-section=N, a value below N at the end of the
+   * performance means that the score has no section N.
+   */
+  PUBLIC int csoundGetScoreSection(CSOUND *);
+
+  /**
+   * Returns non-zero if an instrument of the compiled orchestra writes
+   * state that outlives its notes: global variables, zak, tables,
+   * channels or a shared random sequence.  The score sections of such an
+   * orchestra cannot be rendered independently of one another.
+   */
+  PUBLIC int csoundOrchestraSharesState(CSOUND *);
+
   /**
    * Sets whether Csound score events are performed or not, independently
    * of real-time MIDI events (see csoundSetScorePending()).
@@ -1750,6 +1787,41 @@ extern "C" {
   PUBLIC void csoundSetControlChannel(CSOUND *csound,
                                       const char *name, MYFLT val);
 
+  /**
+   * Looks up the channel called 'name', creating it if needed, exactly
+   * as csoundGetChannelPtr() does, and stores an opaque handle to it in
+   * *h. The handle can then be passed to the functions below without
+   * the cost of a name lookup. It stays valid until csoundReset() or
+   * csoundDestroy(). Returns CSOUND_SUCCESS, or the same error codes as
+   * csoundGetChannelPtr(), in which case *h is set to NULL.
+   */
+  PUBLIC int csoundGetChannelHandle(CSOUND *, CHANNEL_HANDLE **h,
+                                    const char *name, int type);
+
+  /**
+   * retrieves the value of the control channel behind handle h
+   */
+  PUBLIC MYFLT csoundGetControlChannelByHandle(CSOUND *csound,
+                                               CHANNEL_HANDLE *h);
+
+  /**
+   * sets the value of the control channel behind handle h
+   */
+  PUBLIC void csoundSetControlChannelByHandle(CSOUND *csound,
+                                              CHANNEL_HANDLE *h, MYFLT val);
+
+  /**
+   * reads the n control channels in h[] into vals[]
+   */
+  PUBLIC void csoundGetControlChannels(CSOUND *csound, CHANNEL_HANDLE **h,
+                                       MYFLT *vals, int n);
+
+  /**
+   * sets the n control channels in h[] to the values in vals[]
+   */
+  PUBLIC void csoundSetControlChannels(CSOUND *csound, CHANNEL_HANDLE **h,
+                                       const MYFLT *vals, int n);
+
   /**
    * copies the audio channel identified by *name into array
    * *samples which should contain enough memory for ksmps MYFLTs
@@ -1833,6 +1905,23 @@ extern "C" {
   PUBLIC void csoundScoreEventAsync(CSOUND *,
                               char type, const MYFLT *pFields, long numFields);
 
+  /**
+   *  Like csoundScoreEventAsync(), but never waits or allocates memory:
+   *  returns CSOUND_ERROR without queueing the event if the asynchronous
+   *  message queue is full, or if the event has more pfields than fit in
+   *  a queue slot (30 when MYFLT is double, 60 when it is float),
+   *  CSOUND_SUCCESS otherwise.  The pfields are copied.
+   */
+  PUBLIC int csoundTryScoreEventAsync(CSOUND *,
+                              char type, const MYFLT *pFields, long numFields);
+
+  /**
+   *  Returns the number of asynchronous messages refused so far by the
+   *  csoundTry...Async() functions because the queue was full or the
+   *  message was too long.
+   */
+  PUBLIC long csoundGetAsyncQueueFull(CSOUND *);
+
   /**
    * Like csoundScoreEvent(), this function inserts a score event, but
    * at absolute time with respect to the start of performance, or from an
@@ -1966,6 +2055,18 @@ extern "C" {
    */
   PUBLIC void csoundTableSet(CSOUND *, int table, int index, MYFLT value);
 
+  /**
+   * Asynchronous version of csoundTableSet()
+   */
+  PUBLIC void csoundTableSetAsync(CSOUND *, int table, int index, MYFLT value);
+
+  /**
+   * Like csoundTableSetAsync(), but returns CSOUND_ERROR without queueing
+   * the change if the asynchronous message queue is full.
+   */
+  PUBLIC int csoundTryTableSetAsync(CSOUND *, int table, int index,
+                                    MYFLT value);
+
 
   /**
    * Copy the contents of a function table into a supplied array *dest
@@ -2244,6 +2345,9 @@ extern "C" {
   /** Signals a conditional variable */
   PUBLIC void csoundCondSignal(void* condVar);
 
+  /** Destroys a conditional variable made by csoundCreateCondVar() */
+  PUBLIC void csoundDestroyCondVar(void* condVar);
+
   /**
    * Waits for at least the specified number of milliseconds,
    * yielding the CPU to other threads.
@@ -773,6 +773,18 @@ public:
   {
    return csoundGetControlChannel(csound,name, err);
   }
+  virtual int GetChannelHandle(CHANNEL_HANDLE **h, const char *name, int type)
+  {
+    return csoundGetChannelHandle(csound, h, name, type);
+  }
+  virtual MYFLT GetControlChannel(CHANNEL_HANDLE *h)
+  {
+    return csoundGetControlChannelByHandle(csound, h);
+  }
+  virtual void SetControlChannel(CHANNEL_HANDLE *h, MYFLT value)
+  {
+    csoundSetControlChannelByHandle(csound, h, value);
+  }
   virtual void GetStringChannel(const char *name, char *string)
   {
     csoundGetStringChannel(csound,name,string);
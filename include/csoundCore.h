@@ -262,6 +262,22 @@ typedef struct CORFIL {
     int     ksmps_override;
     int     fft_lib;
     int     echo;
+    int     workStealing;   /* per-thread ready queues for the -j dispatcher */
+    int     dagIncremental; /* patch rather than rebuild the task graph */
+    int     parkSpin;       /* polls before an idle -j thread sleeps; 0 never */
+    int     dagCostModel;   /* order -j tasks by measured instrument cost */
+    int     instanceSlab;   /* instances per slab chunk; 0 plain Calloc */
+    int     memArenas;      /* per-thread allocation lists for Malloc/Free */
+    int     instanceLayout; /* slab instances, active chain in address order */
+    int     multiInstance;  /* run instances of an instrument in lockstep */
+    int     exprOpt;        /* per-instrument expression optimisation */
+    int     reclaimThread;  /* run deinit callbacks on a background thread */
+    int     reclaimBudget;  /* reclaimed instances finished per k-cycle */
+    int     diskinThreads;  /* I/O threads for asynchronous diskin2 */
+    int     sndMap;         /* map soundfiles: 1 paged in at load, 2 on use */
+    int     writeBuffers;   /* output buffers queued for the writer thread */
+    int     renderSection;  /* perform only this score section; 0 all */
+    int     taskBatch;      /* size of a -j task in mean instance costs */
   } OPARMS;
 
   typedef struct arglst {
@@ -291,6 +307,8 @@ typedef struct CORFIL {
         int     (*kopadr)(CSOUND *, void *p);
         int     (*aopadr)(CSOUND *, void *p);
         void    *useropinfo;    /* user opcode parameters */
+        /* optional: performs kopadr for n instances at once */
+        int     (*mopadr)(CSOUND *, void **p, int n);
     } OENTRY;
 
   /**
@@ -312,6 +330,17 @@ typedef struct CORFIL {
   } TEXT;
 
 
+  /**
+   * Chunks of equal sized instance blocks of one instrument
+   */
+  typedef struct insds_slab {
+    size_t  blksiz;                 /* bytes per instance */
+    int     nper;                   /* instances per chunk */
+    char    *next, *end;            /* unused part of the newest chunk */
+    void    *free;                  /* released blocks */
+    void    *chunks;                /* all chunks, linked by first word */
+  } INSDS_SLAB;
+
   /**
    * This struct is filled out by otran() at orch parse time.
    * It is used as a template for instrument events.
@@ -345,6 +374,11 @@ typedef struct CORFIL {
     int     instcnt;                /* Count number of instances ever */
     int     isNew;                  /* is this a new definition */
     int     nocheckpcnt;            /* Control checks on pcnt */
+    int32   kcost;                  /* Running cost of a k-period (-j N) */
+    INSDS_SLAB *slab;               /* instance memory, if --instance-slab */
+    int     multi;                  /* lockstep allowed: 1 yes, -1 no, 0 unknown */
+    int     perfops;                /* dispatch table size (with terminator),
+                                       -1 none (perf-time jumps), 0 unknown */
   } INSTRTXT;
 
   typedef struct namedInstr {
@@ -500,6 +534,15 @@ typedef struct CORFIL {
    * This struct holds the info for a concrete instrument event
    * instance in performance.
    */
+  /**
+   * One entry of the pre-resolved perf chain of an instance, ending
+   * with a NULL op.  The routine is read from op->opadr at each call,
+   * as opcodes may replace it at init or perf time.
+   */
+  typedef struct opcall {
+    struct opds *op;
+  } OPCALL;
+
   typedef struct insds {
     /* Chain of init-time opcodes */
     struct opds * nxti;
@@ -513,8 +556,10 @@ typedef struct CORFIL {
     struct insds * nxtact;
     /* Previous in list of active instruments */
     struct insds * prvact;
-    /* Next instrument to terminate */
-    struct insds * nxtoff;
+    /* Position in the turnoff heap plus one, 0 if not scheduled */
+    int      offidx;
+    /* Order of scheduling among equal turnoff times */
+    uint32   offseq;
     /* Chain of files used by opcodes in this instr */
     FDCH    *fdchp;
     /* Extra memory used by opcodes in this instr */
@@ -572,6 +617,10 @@ typedef struct CORFIL {
     MYFLT    retval;
     MYFLT   *lclbas;  /* base for variable memory pool */
     char    *strarg;       /* string argument */
+    int      dag_task;     /* slot in the parallel task graph, -1 if none */
+    struct insds *dag_next;  /* next instance batched into the same task */
+    struct opcall *perf;   /* pre-resolved perf chain, or NULL */
+    volatile int reclaiming; /* deinit queued for the reclaimer thread */
     /* Copy of required p-field values for quick access */
     CS_VAR_MEM  p0;
     CS_VAR_MEM  p1;
@@ -590,6 +639,10 @@ typedef struct CORFIL {
 #define CS_SPIN      (p->h.insdshead->spin)
 #define CS_SPOUT     (p->h.insdshead->spout)
   typedef int (*SUBR)(CSOUND *, void *);
+  typedef int (*MSUBR)(CSOUND *, void **, int);
+
+  /* voices processed together by a multi-instance (OENTRY.mopadr) kernel */
+#define MULTI_LANES (8)
 
   /**
    * This struct holds the info for one opcode in a concrete
@@ -748,8 +801,8 @@ typedef struct CORFIL {
     double          baseFreq;
     /** amplitude scale factor        */
     double          scaleFac;
-    /** interleaved sample data       */
-    float           data[1];
+    /** interleaved sample data, with one zero sample after the end */
+    float           *data;
   } SNDMEMFILE;
 
   typedef struct pvx_memfile_ {
@@ -825,9 +878,22 @@ typedef struct CORFIL {
   typedef struct eventnode {
     struct eventnode  *nxt;
     uint32     start_kcnt;
+    uint32     seq;             /* insertion order among equal start_kcnt */
     EVTBLK            evt;
   } EVTNODE;
 
+  /* pending realtime events: a wheel of per-k-cycle FIFOs covering
+     the next EVTQ_SLOTS k-cycles, and a heap for everything else */
+#define EVTQ_SLOTS 1024
+  typedef struct {
+    EVTNODE   *head[EVTQ_SLOTS], *tail[EVTQ_SLOTS];
+    uint32    base;             /* first k-cycle the wheel covers */
+    int       count;            /* events on the wheel */
+    EVTNODE   **heap;           /* late and far-future events */
+    int       heapsize, heapmax;
+    uint32    seq;
+  } EVTQUEUE;
+
   typedef struct {
     OPDS    h;
     MYFLT   *ktempo, *istartempo;
@@ -975,8 +1041,13 @@ typedef struct _alloc_data_ {
   MEVENT mep;
   INSDS *ip;
   OPDS *ids;
+  double stamp;         /* enqueue time, for latency statistics */
 } ALLOC_DATA;
 
+#define MAX_RECLAIM_QUEUE 1024   /* instances in the reclaimer's care */
+
+#define ALLOC_LATENCY_BINS 80  /* quarter octaves of microseconds */
+
 #define MAX_MESSAGE_STR 1024
 typedef struct _message_queue_t_ {
     int attr;
@@ -1531,7 +1602,7 @@ typedef struct _message_queue_t_ {
     int32         rngcnt[MAXCHNLS];
     int16         rngflg, multichan;
     void          *evtFuncChain;
-    EVTNODE       *OrcTrigEvts;             /* List of events to be started */
+    EVTQUEUE      *OrcTrigEvts;             /* Queue of events to be started */
     EVTNODE       *freeEvtNodes;
     int           csoundIsScorePending_;
     int64_t       advanceCnt;
@@ -1654,6 +1725,9 @@ typedef struct _message_queue_t_ {
       uint32        nframes               /* = 1UL */;
       FILE          *pin, *pout;
       int           dither;
+      MYFLT         *peakacc;             /* spoutsf peak meter lanes     */
+      uint32        peaklanes;
+      void          *writer;              /* --write-buffers thread       */
     } libsndStatics;
 
     int           warped;               /* rdscor.c */
@@ -1750,7 +1824,7 @@ typedef struct _message_queue_t_ {
     volatile stateWithPadding    *dag_task_status;
     watchList     * volatile *dag_task_watch;
     watchList     *dag_wlmm;
-    char          **dag_task_dep;
+    taskDeps      *dag_task_dep;
     int           dag_task_max_size;
     uint32_t      tempStatus;    /* keeps track of which files are temps */
     int           orcLineOffset; /* 1 less than 1st orch line in the CSD */
@@ -1781,11 +1855,10 @@ typedef struct _message_queue_t_ {
     CS_HASH_TABLE* symbtab;
     int           unused_int1;
     int           inZero;       /* flag compilation of instr0 */
-    struct _message_queue **msg_queue;
-    volatile long msg_queue_wget; /* Writer - Get index */
-    volatile long msg_queue_wput; /* Writer - Put Index */
-    volatile long msg_queue_rstart; /* Reader - start index */
-    volatile long msg_queue_items;
+    struct _message_queue *msg_queue;
+    volatile long msg_queue_wput; /* Writers - next slot to claim */
+    volatile long msg_queue_rstart; /* Reader - next slot to read */
+    volatile long msg_queue_full; /* Enqueues refused as the queue was full */
     int      aftouch;
     void     *directory;
     ALLOC_DATA *alloc_queue;
@@ -1800,6 +1873,56 @@ typedef struct _message_queue_t_ {
     volatile unsigned long message_string_queue_items;
     unsigned long message_string_queue_wp;
     message_string_queue_t *message_string_queue;
+    /* work-stealing dispatcher (cs_new_dispatch.c) */
+    struct dag_deque_t *dag_deques;
+    int           dag_num_deques;
+    volatile int  dag_tasks_unstarted;
+    /* incremental task graph */
+    int           dag_num_live;
+    int           dag_epoch;
+    struct dag_conflict_t *dag_conflicts;
+    int           dag_conflicts_size;
+    int           dag_conflicts_count;
+    volatile int  dag_conflicts_stale;
+    /* parking of idle performance threads */
+    void          *dag_park_lock;
+    void          *dag_park_cond;
+    volatile int  dag_parked;
+    /* cost ordering of the task graph */
+    taskID        *dag_task_order;
+    int           dag_num_order;
+    int32         *dag_task_cost;
+    int           *dag_thread_start;
+    /* realtime event queue wakeup and latency histogram */
+    void          *alloc_queue_wakeup;
+    volatile int  alloc_queue_sleeping;
+    uint32_t      *alloc_latency;
+    double        alloc_latency_max;
+    /* per-thread allocation arenas and memlock contention counters */
+    void          *mem_arenas;
+    int           mem_arena_epoch;
+    uint64_t      mem_lock_count, mem_lock_contended;
+    /* turnoff heap ordered by offtim; frstoff caches its top */
+    INSDS         **offheap;
+    int           offheap_size, offheap_max;
+    uint32        offseq;
+    /* deferred deinitialisation: instances go to the reclaimer thread
+       on reclaim_queue and come back on reclaim_done */
+    INSDS         **reclaim_queue, **reclaim_done;
+    volatile unsigned long reclaim_queue_items, reclaim_done_items;
+    unsigned long reclaim_queue_wp, reclaim_done_rp;
+    volatile int  reclaim_pending;  /* queued and not yet collected */
+    spin_lock_t   reclaim_spinlock;
+    void          *reclaim_thread;
+    void          *reclaim_wakeup;
+    volatile int  reclaim_sleeping;
+    volatile int  reclaim_loop;
+    /* memory-mapped soundfiles, unmapped at reset */
+    struct SNDMAP_ *sndmaps;
+    spin_lock_t   sndmaps_lock;
+    /* the open_files chain and the pvoc file table, which the reclaimer
+       thread closes files in too */
+    spin_lock_t   open_files_lock, pvfiles_lock;
     /*struct CSOUND_ **self;*/
     /**@}*/
 #endif  /* __BUILDING_LIBCSOUND */
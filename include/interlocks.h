@@ -50,6 +50,14 @@
 #define IW (0x0400)
 #define IB (0x0600)
 
+//Draws from a shared random sequence or schedules events, so the
+//order of its calls across instances matters
+#define SQ (0x1000)
+
+//Deinit callback may run on another thread (--reclaim-thread): it only
+//touches the opcode's own state and the locked file lists
+#define TD (0x2000)
+
 //Deprecated
 #define _QQ (0x8000)
 
@@ -524,8 +524,9 @@ char *strNcpy(char *dst, const char *src, size_t siz);
 #define ATOMIC_CMP_XCH(val, newVal, oldVal) \
   !(__atomic_compare_exchange(val, (long *) &oldVal, &newVal, 0,        \
                               __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
-#else /* FIXME: no atomics, what to do? */
-#define ATOMIC_CMP_XCH(val, newVal, oldVal) (*val = newVal) != oldVal
+#else /* no atomics: not atomic, but at least a compare and exchange */
+#define ATOMIC_CMP_XCH(val, newVal, oldVal) \
+  (*(val) == (oldVal) ? (*(val) = (newVal), 0) : 1)
 #endif
 
 #if defined(WIN32)
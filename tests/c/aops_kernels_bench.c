@@ -0,0 +1,135 @@
+/*
+ * File:   aops_kernels_bench.c
+ *
+ * Throughput of the a-rate arithmetic kernels behind addaa, mulak, divka
+ * and the audio-array operators, for every kernel set this CPU can run
+ * and ksmps 16, 64 and 256, and of the output peak meter for 2, 6 and 64
+ * channels.  Each set is first checked against plain C, with random
+ * sample-accurate offsets and early ends, for bit-identical results.
+ * Not a test; run it by hand:
+ *
+ *   benchAopsKernels [million samples per case]
+ */
+
+#include "aops_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAXK 256
+
+static const char *opname[AOPK_NUM] = { "add", "sub", "mul", "div" };
+static const char *formname[3] = { "aa", "ak", "ka" };
+
+static void run_kernel(const AOP_KERNELS *k, int form, int op, MYFLT *r,
+                       const MYFLT *a, const MYFLT *b, uint32_t n)
+{
+    switch (form) {
+    case 0: k->vv[op](r, a, b, n); break;
+    case 1: k->vs[op](r, a, *b, n); break;
+    default: k->sv[op](r, *a, b, n); break;
+    }
+}
+
+static int check(const AOP_KERNELS *k, const MYFLT *a, const MYFLT *b)
+{
+    MYFLT want[MAXK], got[MAXK];
+    int form, op, i;
+
+    for (i = 0; i < 10000; i++) {
+      uint32_t nsmps = 1 + rand() % MAXK;
+      uint32_t offset = rand() % nsmps, n = nsmps - offset;
+      if (n > 1) n -= rand() % n;           /* early end */
+      for (form = 0; form < 3; form++)
+        for (op = 0; op < AOPK_NUM; op++) {
+          run_kernel(csound_aops_kernel_set(0), form, op,
+                     want, a + offset, b + offset, n);
+          run_kernel(k, form, op, got, a + offset, b + offset, n);
+          if (memcmp(want, got, n * sizeof(MYFLT))) {
+            printf("%s: %s%s differs from plain C (n=%u)\n",
+                   k->name, opname[op], formname[form], n);
+            return 0;
+          }
+        }
+    }
+    return 1;
+}
+
+static int check_peak(const AOP_KERNELS *k, const MYFLT *a)
+{
+    MYFLT want[2 * MAXK], got[2 * MAXK];
+    int i;
+
+    for (i = 0; i < 10000; i++) {
+      uint32_t lanes = AOPK_LANES * (1 + rand() % (MAXK / AOPK_LANES));
+      uint32_t n = lanes * (rand() % (MAXK / lanes + 1));
+      MYFLT lim = (MYFLT) (rand() % 4) / 8;
+      memset(want, 0, sizeof(want));
+      memset(got, 0, sizeof(got));
+      csound_aops_kernel_set(0)->peak(want, want + lanes, a, n, lanes, lim);
+      k->peak(got, got + lanes, a, n, lanes, lim);
+      if (memcmp(want, got, 2 * lanes * sizeof(MYFLT))) {
+        printf("%s: peak differs from plain C (lanes=%u)\n",
+               k->name, lanes);
+        return 0;
+      }
+    }
+    return 1;
+}
+
+int main(int argc, char **argv)
+{
+    double msamps = argc > 1 ? atof(argv[1]) : 20.0;
+    static const uint32_t ksmps[] = { 16, 64, 256 };
+    static const uint32_t chans[] = { 2, 6, 64 };
+    MYFLT a[MAXK], b[MAXK], r[MAXK], acc[2 * MAXK];
+    const AOP_KERNELS *k;
+    int i, s, form, op;
+
+    srand(1);
+    for (i = 0; i < MAXK; i++) {
+      a[i] = (MYFLT) rand() / RAND_MAX - 0.5;
+      b[i] = (MYFLT) rand() / RAND_MAX + 0.01;
+    }
+    printf("Msamples/s per opcode\n%-9s", "");
+    for (s = 0; s < 3; s++)
+      printf("  %7s %-5u", "ksmps", ksmps[s]);
+    printf("\n");
+    for (i = 0; (k = csound_aops_kernel_set(i)) != NULL; i++) {
+      if (!check(k, a, b) || !check_peak(k, a)) return 1;
+      printf("%s\n", k->name);
+      for (form = 0; form < 3; form++)
+        for (op = 0; op < AOPK_NUM; op++) {
+          printf("  %s%s  ", opname[op], formname[form]);
+          for (s = 0; s < 3; s++) {
+            long reps = (long) (msamps * 1e6 / ksmps[s]), j;
+            clock_t t0 = clock();
+            double secs;
+            for (j = 0; j < reps; j++)
+              run_kernel(k, form, op, r, a, b, ksmps[s]);
+            secs = (double) (clock() - t0) / CLOCKS_PER_SEC;
+            printf("  %13.1f", secs > 0 ? reps * ksmps[s] / secs / 1e6 : 0);
+          }
+          printf("\n");
+        }
+      printf("  peak   ");
+      for (s = 0; s < 3; s++) {
+        uint32_t lanes = chans[s], n;
+        long reps, j;
+        clock_t t0;
+        double secs;
+        while (lanes % AOPK_LANES) lanes += chans[s];
+        n = MAXK - MAXK % lanes;
+        reps = (long) (msamps * 1e6 / n);
+        memset(acc, 0, sizeof(acc));
+        t0 = clock();
+        for (j = 0; j < reps; j++)
+          k->peak(acc, acc + lanes, a, n, lanes, 0.25);
+        secs = (double) (clock() - t0) / CLOCKS_PER_SEC;
+        printf("  %13.1f", secs > 0 ? reps * n / secs / 1e6 : 0);
+      }
+      printf("   (2, 6, 64 channels)\n");
+    }
+    return 0;
+}
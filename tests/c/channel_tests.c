@@ -61,6 +61,42 @@ void test_control_channel(void)
     csoundDestroy(csound);
 }
 
+void test_control_channel_handle(void)
+{
+    csoundSetGlobalEnv("OPCODE6DIR64", "../../");
+    CSOUND *csound = csoundCreate(0);
+    CHANNEL_HANDLE *h[2], *bad;
+    MYFLT vals[2] = { 1.0, 2.0 };
+    csoundCreateMessageBuffer(csound, 0);
+    csoundSetOption(csound, "--logfile=null");
+    csoundCompileOrc(csound, orc1);
+    CU_ASSERT(csoundStart(csound) == CSOUND_SUCCESS);
+    CU_ASSERT(csoundGetChannelHandle(csound, &h[0], "testing",
+                                     CSOUND_CONTROL_CHANNEL |
+                                     CSOUND_INPUT_CHANNEL) == CSOUND_SUCCESS);
+    CU_ASSERT(csoundGetChannelHandle(csound, &h[1], "testing2",
+                                     CSOUND_CONTROL_CHANNEL |
+                                     CSOUND_INPUT_CHANNEL) == CSOUND_SUCCESS);
+    csoundSetControlChannelByHandle(csound, h[0], 5.0);
+    CU_ASSERT_EQUAL(5.0, csoundGetControlChannel(csound, "testing", NULL));
+    csoundSetControlChannel(csound, "testing", 6.0);
+    CU_ASSERT_EQUAL(6.0, csoundGetControlChannelByHandle(csound, h[0]));
+    csoundSetControlChannels(csound, h, vals, 2);
+    vals[0] = vals[1] = 0.0;
+    csoundGetControlChannels(csound, h, vals, 2);
+    CU_ASSERT_EQUAL(1.0, vals[0]);
+    CU_ASSERT_EQUAL(2.0, vals[1]);
+    /* wrong type */
+    CU_ASSERT(csoundGetChannelHandle(csound, &bad, "testing",
+                                     CSOUND_AUDIO_CHANNEL |
+                                     CSOUND_INPUT_CHANNEL) != CSOUND_SUCCESS);
+    CU_ASSERT_PTR_NULL(bad);
+
+    csoundCleanup(csound);
+    csoundDestroyMessageBuffer(csound);
+    csoundDestroy(csound);
+}
+
 const char orc2[] = "chn_k \"testing\", 3, 1, 1, 0, 10\n  chn_a \"testing2\", 3\n  instr 1\n  endin\n";
 
 void test_channel_list(void)
@@ -376,6 +412,7 @@ int main(void)
    /* add the tests to the suite */
    if ((NULL == CU_add_test(pSuite, "Channel Lists", test_channel_list))
            || (NULL == CU_add_test(pSuite, "Control channel", test_control_channel))
+           || (NULL == CU_add_test(pSuite, "Control channel handle", test_control_channel_handle))
            || (NULL == CU_add_test(pSuite, "Control channel parameters", test_control_channel_params))
            || (NULL == CU_add_test(pSuite, "Callbacks", test_channel_callbacks))
            || (NULL == CU_add_test(pSuite, "Opcodes", test_channel_opcodes))
@@ -1,5 +1,8 @@
 #include "csound.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
 #include <CUnit/Basic.h>
 
 #include "time.h"
@@ -54,9 +57,555 @@ void test_compile_async(void)
     csoundDestroy(csound);
 }
 
-int main()
+void test_async_queue_full(void)
+{
+    CSOUND  *csound;
+    MYFLT   pf[64] = { 1.0 };
+    int i, res = CSOUND_SUCCESS;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundCompileOrc(csound, "gi1 ftgen 1, 0, 16, 7, 0, 16, 0\n");
+    csoundReadScore(csound, "e 1\n");
+    csoundStart(csound);
+    for (i = 0; i < 1024 && res == CSOUND_SUCCESS; i++)
+      res = csoundTryTableSetAsync(csound, 1, i % 16, (MYFLT) i);
+    CU_ASSERT_EQUAL(res, CSOUND_SUCCESS);
+    CU_ASSERT_EQUAL(csoundTryTableSetAsync(csound, 1, 0, 1.0), CSOUND_ERROR);
+    CU_ASSERT_EQUAL(csoundGetAsyncQueueFull(csound), 1);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundTableGet(csound, 1, 15), 1023.0);
+    CU_ASSERT_EQUAL(csoundTryTableSetAsync(csound, 1, 0, 2.0), CSOUND_SUCCESS);
+    csoundPerformKsmps(csound);
+    CU_ASSERT_EQUAL(csoundTableGet(csound, 1, 0), 2.0);
+    /* too long for a slot: refused rather than allocated */
+    CU_ASSERT_EQUAL(csoundTryScoreEventAsync(csound, 'i', pf, 64),
+                    CSOUND_ERROR);
+    CU_ASSERT_EQUAL(csoundGetAsyncQueueFull(csound), 2);
+    csoundDestroy(csound);
+}
+
+void test_remove_slab_instr(void)
+{
+    CSOUND  *csound;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "--instance-slab=4");
+    csoundCompileOrc(csound, "gicnt init 0\n"
+                             "instr 1\n"
+                             "gicnt = gicnt + 1\n"
+                             "a1 oscili 0.1, 440\n"
+                             "endin\n"
+                             "instr 2\n"
+                             "remove 1\n"
+                             "endin\n");
+    /* six at once: two slab chunks, then removed, then no longer there */
+    csoundReadScore(csound, "i1 0 0.01\ni1 0 0.01\ni1 0 0.01\n"
+                            "i1 0 0.01\ni1 0 0.01\ni1 0 0.01\n"
+                            "i2 0.1 0\ni1 0.2 0.01\ne 0.3\n");
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    CU_ASSERT_EQUAL(csoundEvalCode(csound, "return gicnt\n"), 6.0);
+    csoundDestroy(csound);
+}
+
+/* render orc and sco with -n and up to two more options; returns the
+   spout samples of the whole performance, to be freed, and their number */
+static MYFLT *render_spout(const char *orc, const char *sco,
+                           const char *opt1, const char *opt2, long *n)
+{
+    CSOUND  *csound;
+    MYFLT   *buf = NULL;
+    long    nspout, cnt = 0, max = 0;
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    if (opt1 != NULL) csoundSetOption(csound, opt1);
+    if (opt2 != NULL) csoundSetOption(csound, opt2);
+    csoundCompileOrc(csound, orc);
+    csoundReadScore(csound, sco);
+    csoundStart(csound);
+    nspout = csoundGetKsmps(csound) * csoundGetNchnls(csound);
+    while (csoundPerformKsmps(csound) == 0) {
+      if (cnt + nspout > max) {
+        max = 2 * (cnt + nspout);
+        buf = (MYFLT *) realloc(buf, max * sizeof(MYFLT));
+      }
+      memcpy(buf + cnt, csoundGetSpout(csound), nspout * sizeof(MYFLT));
+      cnt += nspout;
+    }
+    csoundDestroy(csound);
+    *n = cnt;
+    return buf;
+}
+
+static int same_render(MYFLT *a, long na, MYFLT *b, long nb)
+{
+    long i, loud = 0;
+    if (a == NULL || b == NULL || na != nb) return 0;
+    for (i = 0; i < na; i++)
+      if (a[i] != 0.0) loud++;
+    return loud > 0 && memcmp(a, b, na * sizeof(MYFLT)) == 0;
+}
+
+static const char *lockstep_orc =
+    "sr = 44100\nksmps = 32\nnchnls = 1\n0dbfs = 1\n"
+    "instr 1\n"
+    "kenv linseg 0, 0.05, 1, p3 - 0.05, 0\n"
+    "a1 oscili kenv * 0.1, p4\n"
+    "a2 moogladder a1, 2000, 0.3\n"
+    "out a2\n"
+    "endin\n"
+    "instr 2\n"                 /* the global random sequence */
+    "kf random 200, 800\n"
+    "a1 oscili 0.05, kf\n"
+    "out a1\n"
+    "endin\n"
+    "instr 3\n"                 /* events, in the order they are made */
+    "ktrig metro 20\n"
+    "schedkwhen ktrig, 0, 0, 4, 0, 0.02, p4\n"
+    "endin\n"
+    "instr 4\n"
+    "a1 oscili 0.05, p4 + rnd(100)\n"
+    "out a1\n"
+    "endin\n";
+
+static const char *lockstep_sco =
+    "i1 0 0.5 220\ni1 0 0.5 330\ni1 0 0.5 440\n"
+    "i1 0.1 0.4 550\ni1 0.1 0.4 660\n"
+    "i2 0 0.5\ni2 0 0.5\ni2 0 0.5\n"
+    "i3 0 0.5 300\ni3 0 0.5 400\ni3 0 0.5 500\ne\n";
+
+void test_multi_instance_matches(void)
+{
+    long  n1, n2;
+    MYFLT *seq = render_spout(lockstep_orc, lockstep_sco, NULL, NULL, &n1);
+    MYFLT *mi = render_spout(lockstep_orc, lockstep_sco,
+                             "--multi-instance", NULL, &n2);
+    CU_ASSERT(same_render(seq, n1, mi, n2));
+    free(seq);
+    free(mi);
+}
+
+/* one instrument for each of the expression optimiser passes */
+static const char *expr_orc =
+    "sr = 44100\nksmps = 32\nnchnls = 1\n0dbfs = 1\n"
+    "instr 1\n"                 /* pow(x, 2) and x / 2^n */
+    "kenv line 0, p3, 1\n"
+    "kamp = pow(kenv, 2) / 8\n"
+    "a1 oscili kamp, p4 / 4 * 4\n"
+    "out a1\n"
+    "endin\n"
+    "instr 2\n"                 /* shared subexpressions */
+    "k1 line 0.1, p3, 0.3\n"
+    "k2 line 0.2, p3, 0.1\n"
+    "a1 oscili k1 * k2 + 0.01, p4\n"
+    "a2 oscili (k1 * k2) * 0.5, p4 * 1.5\n"
+    "out a1 + a2\n"
+    "endin\n"
+    "instr 3\n"                 /* k values fixed after init */
+    "ifrq = p4 * 2\n"
+    "kfrq = ifrq * 0.5 + 3\n"
+    "kamp = 0.05 * 3\n"
+    "a1 oscili kamp, kfrq\n"
+    "out a1\n"
+    "endin\n"
+    "instr 4\n"                 /* fused a-rate mix and crossfade */
+    "a1 oscili 0.1, p4\n"
+    "a2 oscili 0.1, p4 * 1.5\n"
+    "a3 oscili 0.1, p4 * 2\n"
+    "k1 line 0, p3, 1\n"
+    "k2 line 1, p3, 0\n"
+    "amix = (a1 * k1 + a2 * k2 - a3 * 0.25) / 3\n"
+    "out amix * (1 - k1) + a1 * k1\n"
+    "endin\n";
+
+static const char *expr_sco =
+    "i1 0 0.3 440\ni2 0 0.3 330\ni3 0.1 0.3 220\ni4 0.2 0.3 550\ne\n";
+
+void test_expression_opt_matches(void)
+{
+    long  n1, n2;
+    MYFLT *plain = render_spout(expr_orc, expr_sco,
+                                "--no-expression-opt", NULL, &n1);
+    MYFLT *opt = render_spout(expr_orc, expr_sco, NULL, NULL, &n2);
+    CU_ASSERT(same_render(plain, n1, opt, n2));
+    free(plain);
+    free(opt);
+}
+
+/* like same_render, for renders that may sum the same notes in
+   another order */
+static int close_render(MYFLT *a, long na, MYFLT *b, long nb, MYFLT tol)
+{
+    long i, loud = 0;
+    if (a == NULL || b == NULL || na != nb) return 0;
+    for (i = 0; i < na; i++) {
+      if (a[i] != 0.0) loud++;
+      if (a[i] - b[i] > tol || b[i] - a[i] > tol) return 0;
+    }
+    return loud > 0;
+}
+
+static const char *layout_orc =
+    "sr = 44100\nksmps = 16\nnchnls = 1\n0dbfs = 1\n"
+    "instr 1\n"
+    "kenv linseg 0, 0.01, 1, p3 - 0.02, 1, 0.01, 0\n"
+    "a1 oscili kenv * 0.01, p4\n"
+    "out a1\n"
+    "endin\n"
+    "instr 2\n"
+    "a1 oscili 0.01, p4\n"
+    "a2 butlp a1, 1000\n"
+    "out a2\n"
+    "endin\n";
+
+void test_instance_layout_matches(void)
+{
+    char  sco[8192], *s = sco;
+    long  n1, n2;
+    MYFLT *plain, *layout;
+    int   i;
+    /* overlapping notes that end and start all the time, so that
+       instances are freed and reused */
+    for (i = 0; i < 200; i++)
+      s += sprintf(s, "i%d %g %g %d\n", 1 + i % 2, (i % 50) * 0.01,
+                   0.05 + (i % 7) * 0.02, 100 + 5 * i);
+    strcpy(s, "e\n");
+    plain = render_spout(layout_orc, sco, NULL, NULL, &n1);
+    layout = render_spout(layout_orc, sco, "--instance-layout", NULL, &n2);
+    CU_ASSERT(close_render(plain, n1, layout, n2, 1e-5));
+    free(plain);
+    free(layout);
+}
+
+/* the same a-rate arithmetic a k-cycle at a time, where the kernels
+   take their vector loops, and a sample at a time in a UDO with
+   setksmps 1, where they only run their scalar tails */
+static const char *kernels_orc =
+    "sr = 44100\nksmps = 64\nnchnls = 2\n0dbfs = 1\n"
+    "opcode MixBlock, a, aa\n"
+    "a1, a2 xin\n"
+    "aout = (a1 + a2) * 0.25 + (a1 - a2) * a2 - a1 / (a2 + 2)\n"
+    "aout = aout + 0.5 / (a1 + 3) - (0.1 - a2) * a1\n"
+    "xout aout\n"
+    "endop\n"
+    "opcode MixSample, a, aa\n"
+    "setksmps 1\n"
+    "a1, a2 xin\n"
+    "aout = (a1 + a2) * 0.25 + (a1 - a2) * a2 - a1 / (a2 + 2)\n"
+    "aout = aout + 0.5 / (a1 + 3) - (0.1 - a2) * a1\n"
+    "xout aout\n"
+    "endop\n"
+    "instr 1\n"
+    "a1 oscili 0.5, p4\n"
+    "a2 oscili 0.4, p4 * 1.37\n"
+    "ab MixBlock a1, a2\n"
+    "as MixSample a1, a2\n"
+    "outs ab * 0.3, as * 0.3\n"
+    "endin\n";
+
+void test_arith_kernels_blocks(void)
+{
+    long  n, i, differ = 0, loud = 0;
+    /* notes off the k-cycle boundaries, for unaligned offsets */
+    MYFLT *out = render_spout(kernels_orc,
+                              "i1 0 0.2 220\ni1 0.0013 0.1 330\n"
+                              "i1 0.1007 0.05 440\ne\n",
+                              "--sample-accurate", NULL, &n);
+    CU_ASSERT_PTR_NOT_NULL(out);
+    for (i = 0; out != NULL && i < n; i += 2) {
+      if (out[i] != out[i + 1]) differ++;
+      if (out[i] != 0.0) loud++;
+    }
+    CU_ASSERT_EQUAL(differ, 0);
+    CU_ASSERT(loud > 0);
+    free(out);
+}
+
+/* a setksmps UDO and a local-ksmps instrument, with notes that start
+   and end off the k-cycle boundaries */
+static const char *lksmps_orc =
+    "sr = 44100\nksmps = 16\nnchnls = 1\n0dbfs = 1\n"
+    "opcode Tone, a, a\n"
+    "setksmps 4\n"
+    "ain xin\n"
+    "aout tone ain, 800\n"
+    "xout aout\n"
+    "endop\n"
+    "instr 1\n"
+    "a1 oscili p4, p5\n"
+    "out Tone(a1)\n"
+    "endin\n"
+    "instr 2\n"
+    "setksmps 4\n"
+    "a1 oscili p4, p5\n"
+    "a2 tone a1, 600\n"
+    "out a2\n"
+    "endin\n";
+
+static const char *lksmps_sco =
+    "i1 0.00013 0.0511 0.3 440\ni2 0.00029 0.0493 0.3 660\n"
+    "i1 0.1003 0.0004 0.3 440\ni2 0.1507 0.0003 0.3 660\n"
+    "i2 0.2 0.00011 0.3 660\n";
+
+void test_local_ksmps_offsets(void)
+{
+    long  n1, n2;
+    /* the reference runs everything at the local ksmps, where the
+       offset and early end fall in the first and last k-cycle */
+    MYFLT *lcl = render_spout(lksmps_orc, lksmps_sco,
+                              "--sample-accurate", NULL, &n1);
+    MYFLT *ref = render_spout(lksmps_orc, lksmps_sco,
+                              "--sample-accurate", "--ksmps=4", &n2);
+    /* the renders end on different k-cycles */
+    if (n2 > n1) n2 = n1;
+    CU_ASSERT(n2 > n1 - 16);
+    CU_ASSERT(same_render(lcl, n2, ref, n2));
+    free(lcl);
+    free(ref);
+}
+
+/* instr 1 records p4 in table 1 in the order the notes start */
+static const char *order_orc =
+    "sr = 44100\nksmps = 32\nnchnls = 1\n0dbfs = 1\n"
+    "giord ftgen 1, 0, 16, -2, 0\n"
+    "gicnt init 0\n"
+    "instr 1\n"
+    "tableiw p4, gicnt, 1\n"
+    "gicnt = gicnt + 1\n"
+    "if p4 == 2 then\n"         /* queued while the k-cycle is dispatched */
+    "  schedule 1, 0, 0.01, 9\n"
+    "endif\n"
+    "endin\n";
+
+void test_event_queue_order(void)
+{
+    /* p4 and start time; 0.5 is within the wheel, 1, 2 and 3 s beyond */
+    static const MYFLT ev[][2] = {
+      { 1, 2.0 }, { 2, 0.01 }, { 3, 0.5 }, { 4, 0.01 },
+      { 5, 1.0 }, { 6, 0.5 }, { 7, 3.0 }, { 8, 0.0 }
+    };
+    /* by start time, then in the order queued */
+    static const MYFLT want[] = { 8, 2, 4, 9, 3, 6, 5, 1, 7 };
+    CSOUND  *csound;
+    int     i;
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundCompileOrc(csound, order_orc);
+    csoundReadScore(csound, "f0 3.2\n");
+    csoundStart(csound);
+    for (i = 0; i < 8; i++) {
+      MYFLT p[4] = { 1, ev[i][1], 0.01, ev[i][0] };
+      csoundScoreEvent(csound, 'i', p, 4);
+    }
+    while (csoundPerformKsmps(csound) == 0);
+    CU_ASSERT_EQUAL(csoundEvalCode(csound, "return gicnt\n"), 9.0);
+    for (i = 0; i < 9; i++)
+      CU_ASSERT_EQUAL(csoundTableGet(csound, 1, i), want[i]);
+    csoundDestroy(csound);
+}
+
+/* instr 2 records p4 in table 2 when its note is turned off */
+static const char *offtime_orc =
+    "sr = 44100\nksmps = 32\nnchnls = 1\n0dbfs = 1\n"
+    "giord ftgen 2, 0, 16, -2, 0\n"
+    "gkcnt init 0\n"
+    "instr 2\n"
+    "xtratim 0.01\n"
+    "krel release\n"
+    "kdone init 0\n"
+    "if krel == 1 && kdone == 0 && p4 != 6 then\n"
+    "  tablew p4, gkcnt, 2\n"
+    "  gkcnt = gkcnt + 1\n"
+    "  kdone = 1\n"
+    "endif\n"
+    "if p4 == 6 && timeinsts() > 0.02 then\n"  /* leaves early */
+    "  turnoff\n"
+    "endif\n"
+    "endin\n";
+
+void test_offtime_order(void)
+{
+    static const MYFLT want[] = { 5, 2, 4, 7, 3, 1 };
+    CSOUND  *csound;
+    int     i;
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundCompileOrc(csound, offtime_orc);
+    csoundReadScore(csound, "i2 0 0.3 1\ni2 0 0.1 2\ni2 0 0.2 3\n"
+                            "i2 0 0.1 4\ni2 0 0.05 5\ni2 0 0.5 6\n"
+                            "i2 0.01 0.15 7\ne 0.6\n");
+    csoundStart(csound);
+    while (csoundPerformKsmps(csound) == 0);
+    CU_ASSERT_EQUAL(csoundEvalCode(csound, "return i(gkcnt)\n"), 6.0);
+    for (i = 0; i < 6; i++)
+      CU_ASSERT_EQUAL(csoundTableGet(csound, 2, i), want[i]);
+    csoundDestroy(csound);
+}
+
+/* diskin2 and fout close their files in deinit callbacks flagged to run
+   on the reclaimer thread; ten notes end together every 10 ms.  With -v
+   the fd chain is printed as diskin2's file is closed, and fout reports
+   closing its file, so the messages tell which thread did it */
+static const char *reclaim_src_orc =
+    "sr = 44100\nksmps = 16\nnchnls = 1\n0dbfs = 1\n"
+    "instr 1\n"
+    "a1 oscili 0.5, 441\n"
+    "fout \"reclaim_in.wav\", 16, a1\n"
+    "endin\n";
+
+static const char *reclaim_orc =
+    "sr = 44100\nksmps = 16\nnchnls = 1\n0dbfs = 1\n"
+    "instr 1\n"
+    "a1 diskin2 \"reclaim_in.wav\", p4, 0, 1\n"
+    "fout \"reclaim_out.wav\", 16, a1\n"
+    "out a1 * 0.05\n"
+    "endin\n";
+
+static pthread_t reclaim_main;
+static int reclaim_fd_closes, reclaim_fout_closes;
+
+static void reclaim_msg(CSOUND *csound, int attr,
+                        const char *format, va_list args)
+{
+    (void) csound; (void) attr; (void) args;
+    if (pthread_equal(pthread_self(), reclaim_main))
+      return;
+    if (strncmp(format, "fdlist for instr", 16) == 0)
+      reclaim_fd_closes++;
+    else if (strncmp(format, "Closing file", 12) == 0)
+      reclaim_fout_closes++;
+}
+
+void test_reclaim_thread_matches(void)
+{
+    char  sco[16384], *s = sco;
+    long  n, n1, n2;
+    MYFLT *src, *plain, *reclaimed;
+    int   i;
+    src = render_spout(reclaim_src_orc, "i1 0 0.5\ne\n", NULL, NULL, &n);
+    free(src);
+    for (i = 0; i < 300; i++)
+      s += sprintf(s, "i1 %g %g %g\n", (i / 10) * 0.01,
+                   0.02 + (i % 3) * 0.005, 1.0 + (i % 7) * 0.1);
+    strcpy(s, "e\n");
+    reclaim_main = pthread_self();
+    reclaim_fd_closes = reclaim_fout_closes = 0;
+    csoundSetDefaultMessageCallback(reclaim_msg);
+    plain = render_spout(reclaim_orc, sco, "-v", NULL, &n1);
+    CU_ASSERT_EQUAL(reclaim_fd_closes + reclaim_fout_closes, 0);
+    reclaimed = render_spout(reclaim_orc, sco, "-v", "--reclaim-thread", &n2);
+    csoundSetDefaultMessageCallback(NULL);
+    CU_ASSERT(reclaim_fd_closes > 0);
+    CU_ASSERT(reclaim_fout_closes > 0);
+    CU_ASSERT(same_render(plain, n1, reclaimed, n2));
+    free(plain);
+    free(reclaimed);
+    remove("reclaim_in.wav");
+    remove("reclaim_out.wav");
+}
+
+/* independent voices, two that feed a global bus and the instrument
+   that reads it, so that the -j N task graph has both parallel and
+   ordered work */
+static const char *threads_orc =
+    "sr = 44100\nksmps = 16\nnchnls = 2\n0dbfs = 1\n"
+    "gabus init 0\n"
+    "instr 1\n"
+    "kenv linseg 0, 0.005, 1, p3 - 0.01, 1, 0.005, 0\n"
+    "a1 oscili kenv * 0.02, p4\n"
+    "a2 moogladder a1, 1500, 0.4\n"
+    "outs a2, a1\n"
+    "endin\n"
+    "instr 2\n"
+    "a1 oscili 0.02, p4\n"
+    "a2 butlp a1, 800\n"
+    "outs a1, a2\n"
+    "endin\n"
+    "instr 3\n"
+    "a1 oscili 0.01, p4\n"
+    "gabus = gabus + a1\n"
+    "endin\n"
+    "instr 4\n"
+    "a1 oscili 0.01, p4 * 1.5\n"
+    "gabus = gabus + a1 * 0.5\n"
+    "endin\n"
+    "instr 9\n"
+    "a1 butlp gabus, 2000\n"
+    "outs a1, gabus\n"
+    "gabus = 0\n"
+    "endin\n";
+
+/* many short notes of each instrument, starting and ending all the
+   time, over the bus reader that lasts the whole score */
+static void threads_sco(char *s)
+{
+    int i;
+    s += sprintf(s, "i9 0 1.1\n");
+    for (i = 0; i < 400; i++)
+      s += sprintf(s, "i%d %g %g %d\n", 1 + i % 4, (i % 100) * 0.01,
+                   0.01 + (i % 9) * 0.007, 100 + 3 * i);
+    strcpy(s, "e\n");
+}
+
+/* render threads_orc with -j 4 and opt, and compare with one thread;
+   voices are summed in another order, so only rounding may differ */
+static void check_threaded_render(const char *opt)
+{
+    char  sco[16384];
+    long  n1, n2;
+    MYFLT *single, *threaded;
+    threads_sco(sco);
+    single = render_spout(threads_orc, sco, NULL, NULL, &n1);
+    threaded = render_spout(threads_orc, sco, "-j4", opt, &n2);
+    CU_ASSERT(close_render(single, n1, threaded, n2, 1e-12));
+    free(single);
+    free(threaded);
+}
+
+void test_work_stealing_matches(void)
+{
+    check_threaded_render("--work-stealing");
+}
+
+void test_dag_incremental_matches(void)
+{
+    check_threaded_render("--dag-incremental");
+}
+
+void test_park_spin_matches(void)
+{
+    check_threaded_render("--park-spin=1");
+}
+
+void test_dag_cost_model_matches(void)
+{
+    check_threaded_render("--dag-cost-model");
+}
+
+void test_task_batch_matches(void)
+{
+    check_threaded_render("--task-batch=2");
+}
+
+int main(int argc, char **argv)
 {
     CU_pSuite pSuite = NULL;
+    int i;
+
+    /* -+env:NAME=value options, before any instance loads its plugins */
+    for (i = 1; i < argc; i++)
+      if (strncmp(argv[i], "-+env:", 6) == 0) {
+        char *eq = strchr(argv[i] + 6, '=');
+        if (eq != NULL) {
+          *eq = '\0';
+          csoundSetGlobalEnv(argv[i] + 6, eq + 1);
+        }
+      }
 
     /* initialize the CUnit test registry */
     if (CUE_SUCCESS != CU_initialize_registry())
@@ -73,6 +622,36 @@ int main()
     if ((NULL == CU_add_test(pSuite, "Test daemon mode", test_daemon))
         || (NULL == CU_add_test(pSuite, "Test evalcode", test_eval_code))
 	|| (NULL == CU_add_test(pSuite, "Test compileAsync", test_compile_async)) 
+	|| (NULL == CU_add_test(pSuite, "Test async queue full",
+                                test_async_queue_full))
+	|| (NULL == CU_add_test(pSuite, "Test remove slab instrument",
+                                test_remove_slab_instr))
+	|| (NULL == CU_add_test(pSuite, "Test multi-instance render",
+                                test_multi_instance_matches))
+	|| (NULL == CU_add_test(pSuite, "Test expression-opt render",
+                                test_expression_opt_matches))
+	|| (NULL == CU_add_test(pSuite, "Test instance layout render",
+                                test_instance_layout_matches))
+	|| (NULL == CU_add_test(pSuite, "Test a-rate kernels by block",
+                                test_arith_kernels_blocks))
+	|| (NULL == CU_add_test(pSuite, "Test local ksmps offsets",
+                                test_local_ksmps_offsets))
+	|| (NULL == CU_add_test(pSuite, "Test event queue order",
+                                test_event_queue_order))
+	|| (NULL == CU_add_test(pSuite, "Test note offtime order",
+                                test_offtime_order))
+	|| (NULL == CU_add_test(pSuite, "Test reclaim thread render",
+                                test_reclaim_thread_matches))
+	|| (NULL == CU_add_test(pSuite, "Test -j 4 work stealing render",
+                                test_work_stealing_matches))
+	|| (NULL == CU_add_test(pSuite, "Test -j 4 incremental graph render",
+                                test_dag_incremental_matches))
+	|| (NULL == CU_add_test(pSuite, "Test -j 4 park spin render",
+                                test_park_spin_matches))
+	|| (NULL == CU_add_test(pSuite, "Test -j 4 cost model render",
+                                test_dag_cost_model_matches))
+	|| (NULL == CU_add_test(pSuite, "Test -j 4 task batch render",
+                                test_task_batch_matches))
 	)
     {
         CU_cleanup_registry();
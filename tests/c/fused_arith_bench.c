@@ -0,0 +1,104 @@
+/*
+ * File:   fused_arith_bench.c
+ *
+ * Mixing expressions with and without --no-expression-opt: each
+ * instrument is a typical a-rate mix or crossfade written as one
+ * expression, which the optimiser turns into a single fused opcode.
+ * Renders many voices of each and reports the time per k-cycle.  Not a
+ * test; run it by hand:
+ *
+ *   benchFusedArith [voices] [seconds] [ksmps]
+ */
+
+#include "csound.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char orc_head[] =
+    "sr = 44100\n"
+    "ksmps = %d\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n";
+
+static const char orc_body[] =
+    "instr 1\n"                 /* two-source mix */
+    "  a1 oscili 0.1, p4\n"
+    "  a2 oscili 0.1, p4*1.5\n"
+    "  k1 line 0, p3, 1\n"
+    "  k2 line 1, p3, 0\n"
+    "  a3 = (a1*k1 + a2*k2) * 0.5\n"
+    "  out a3\n"
+    "endin\n"
+    "instr 2\n"                 /* four-source mix with master gain */
+    "  a1 oscili 0.1, p4\n"
+    "  a2 oscili 0.1, p4*1.25\n"
+    "  a3 oscili 0.1, p4*1.5\n"
+    "  a4 oscili 0.1, p4*2\n"
+    "  k1 line 0, p3, 1\n"
+    "  a5 = (a1*0.3 + a2*0.2 + a3*k1 + a4*(1-k1)) * p5\n"
+    "  out a5\n"
+    "endin\n"
+    "instr 3\n"                 /* equal-gain crossfade and dry/wet */
+    "  a1 oscili 0.1, p4\n"
+    "  a2 oscili 0.1, p4*0.5\n"
+    "  k1 line 0, p3, 1\n"
+    "  a3 = a1 + (a2 - a1)*k1\n"
+    "  a4 = a3*0.7 + a1*0.3 - a2/4\n"
+    "  out a4\n"
+    "endin\n";
+
+static double run(int insno, int voices, double secs, int ksmps,
+                  const char *option)
+{
+    CSOUND *csound = csoundCreate(NULL);
+    char orc[2048], sco[128];
+    long kcycles = 0;
+    clock_t t0, t = 0;
+    int i;
+
+    snprintf(orc, sizeof(orc), orc_head, ksmps);
+    strncat(orc, orc_body, sizeof(orc) - strlen(orc) - 1);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "--logfile=null");
+    if (option != NULL)
+      csoundSetOption(csound, option);
+    csoundCompileOrc(csound, orc);
+    for (i = 0; i < voices; i++) {
+      snprintf(sco, sizeof(sco), "i%d 0 %g %d 0.5\n",
+               insno, secs, 100 + 7 * i);
+      csoundReadScore(csound, sco);
+    }
+    csoundStart(csound);
+    for (;;) {
+      int done;
+      t0 = clock();
+      done = csoundPerformKsmps(csound);
+      t += clock() - t0;
+      if (done) break;
+      kcycles++;
+    }
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+    return 1e6 * t / CLOCKS_PER_SEC / (kcycles ? kcycles : 1);
+}
+
+int main(int argc, char **argv)
+{
+    int voices = argc > 1 ? atoi(argv[1]) : 100;
+    double secs = argc > 2 ? atof(argv[2]) : 5.0;
+    int ksmps = argc > 3 ? atoi(argv[3]) : 64;
+    int insno;
+
+    printf("%d voices, ksmps %d, us per k-cycle\n", voices, ksmps);
+    printf("instr  %20s  %20s\n", "--no-expression-opt", "default");
+    for (insno = 1; insno <= 3; insno++) {
+      double plain = run(insno, voices, secs, ksmps, "--no-expression-opt");
+      double fused = run(insno, voices, secs, ksmps, NULL);
+      printf("%5d  %20.3f  %20.3f\n", insno, plain, fused);
+    }
+    return 0;
+}
@@ -0,0 +1,151 @@
+/*
+ * File:   instance_layout_bench.c
+ *
+ * Compares the default instance layout with --instance-layout: renders
+ * the same dense, churning score both ways and reports the time and,
+ * on Linux, the hardware cache misses per k-cycle of
+ * csoundPerformKsmps().  Not a test; run it by hand:
+ *
+ *   benchInstanceLayout [notes] [seconds]
+ */
+
+#include "csound.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+static int open_cache_counter(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int) syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+static void counter_start(int fd)
+{
+    if (fd < 0) return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+static long long counter_stop(int fd)
+{
+    long long n = -1;
+    if (fd < 0) return -1;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &n, sizeof(n)) != sizeof(n)) return -1;
+    return n;
+}
+#else
+static int open_cache_counter(void) { return -1; }
+static void counter_start(int fd) { (void) fd; }
+static long long counter_stop(int fd) { (void) fd; return -1; }
+#endif
+
+static const char orc[] =
+    "sr = 44100\n"
+    "ksmps = 16\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "  k1 linseg 0, p3*0.5, p4, p3*0.5, 0\n"
+    "  a1 oscili k1, p5\n"
+    "  a2 butterlp a1, 2000\n"
+    "  out a2\n"
+    "endin\n"
+    "instr 2\n"
+    "  a1 oscili p4, p5\n"
+    "  a2 moogladder a1, 1500, 0.4\n"
+    "  out a2\n"
+    "endin\n"
+    "instr 3\n"
+    "  k1 linseg p4, p3, 0\n"
+    "  a1 oscili k1, p5*1.5\n"
+    "  out a1\n"
+    "endin\n";
+
+/* short overlapping notes of three instruments, so that instances are
+   freed and reused in an order unrelated to their addresses */
+static char *make_score(int notes, double secs)
+{
+    char *sco = (char *) malloc((size_t) notes * 64 + 1);
+    char *p = sco;
+    int i;
+    srand(1);
+    for (i = 0; i < notes; i++) {
+      double start = secs * rand() / (double) RAND_MAX;
+      double dur = 0.05 + 1.5 * rand() / (double) RAND_MAX;
+      p += sprintf(p, "i%d %.4f %.4f 0.001 %d\n",
+                   1 + i % 3, start, dur, 100 + rand() % 1000);
+    }
+    return sco;
+}
+
+static void run(const char *sco, const char *option, int fd)
+{
+    CSOUND *csound = csoundCreate(NULL);
+    long long misses = 0, n;
+    long kcycles = 0;
+    clock_t t0, t = 0;
+
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "--logfile=null");
+    if (option != NULL)
+      csoundSetOption(csound, option);
+    csoundCompileOrc(csound, orc);
+    csoundReadScore(csound, sco);
+    csoundStart(csound);
+    for (;;) {
+      int done;
+      t0 = clock();
+      counter_start(fd);
+      done = csoundPerformKsmps(csound);
+      n = counter_stop(fd);
+      t += clock() - t0;
+      if (n >= 0) misses += n;
+      else misses = -1;
+      if (done) break;
+      kcycles++;
+    }
+    printf("%-20s %8ld k-cycles  %8.3f us/k-cycle",
+           option != NULL ? option : "default", kcycles,
+           1e6 * t / CLOCKS_PER_SEC / (kcycles ? kcycles : 1));
+    if (misses >= 0)
+      printf("  %10.1f cache misses/k-cycle",
+             (double) misses / (kcycles ? kcycles : 1));
+    printf("\n");
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+}
+
+int main(int argc, char **argv)
+{
+    int notes = argc > 1 ? atoi(argv[1]) : 4000;
+    double secs = argc > 2 ? atof(argv[2]) : 20.0;
+    char *sco = make_score(notes, secs);
+    int fd = open_cache_counter();
+
+    if (fd < 0)
+      printf("no hardware cache counter, reporting time only\n");
+    run(sco, NULL, fd);
+    run(sco, "--instance-layout", fd);
+    run(sco, NULL, fd);
+    run(sco, "--instance-layout", fd);
+    free(sco);
+    return 0;
+}
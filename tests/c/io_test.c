@@ -1,5 +1,7 @@
 #include "csound.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <CUnit/Basic.h>
 
@@ -284,6 +286,288 @@ void test_midi_hostbased(void)
 }
 
 
+/* compile orc and sco with the options in opts (NULL terminated) and
+   perform to the end; if spout is not NULL, it gets the spout samples of
+   the whole performance, to be freed, and n their number */
+static int render_opts(const char *orc, const char *sco, const char **opts,
+                       MYFLT **spout, long *n)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+    long    nspout, cnt = 0, max = 0;
+    int     ret;
+    MYFLT   *buf = NULL;
+    for ( ; *opts != NULL; opts++)
+      csoundSetOption(csound, *opts);
+    csoundCompileOrc(csound, orc);
+    csoundReadScore(csound, sco);
+    ret = csoundStart(csound);
+    nspout = csoundGetKsmps(csound) * csoundGetNchnls(csound);
+    while (ret == 0 && csoundPerformKsmps(csound) == 0) {
+      if (spout == NULL) continue;
+      if (cnt + nspout > max) {
+        max = 2 * (cnt + nspout);
+        buf = (MYFLT *) realloc(buf, max * sizeof(MYFLT));
+      }
+      memcpy(buf + cnt, csoundGetSpout(csound), nspout * sizeof(MYFLT));
+      cnt += nspout;
+    }
+    csoundDestroy(csound);          /* closes the output file */
+    if (spout != NULL) {
+      *spout = buf;
+      *n = cnt;
+    }
+    return ret;
+}
+
+/* the contents of a file, to be freed, and their size (-1: unreadable) */
+static long file_bytes(const char *name, unsigned char **data)
+{
+    FILE *f = fopen(name, "rb");
+    long n;
+    *data = NULL;
+    if (f == NULL) return -1;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    rewind(f);
+    *data = (unsigned char *) malloc(n > 0 ? n : 1);
+    if (fread(*data, 1, n, f) != (size_t) n) n = -1;
+    fclose(f);
+    return n;
+}
+
+/* three channels, one of them beyond 0dbfs, and an odd ksmps */
+static const char *file_orc =
+    "sr = 44100\nksmps = 7\nnchnls = 3\n0dbfs = 2\n"
+    "instr 1\n"
+    "kenv line 0, p3, 1\n"
+    "a1 oscili 0.9, p4\n"
+    "a2 oscili 2.5, p4 * 1.5\n"
+    "outch 1, a1, 2, a2 * kenv, 3, -a1\n"
+    "endin\n";
+
+static const char *file_sco = "i1 0 0.3 440\ni1 0.1 0.1 660\ne\n";
+
+void test_write_buffers(void)
+{
+    static const char *fmt[] = { "-f", "-s" };
+    int i;
+    for (i = 0; i < 2; i++) {
+      const char *plain[] = { "-d", "-W", fmt[i], "-b50",
+                              "-oio_test_plain.wav", NULL };
+      const char *wb[] = { "-d", "-W", fmt[i], "-b50",
+                           "-oio_test_wb.wav", "--write-buffers=3", NULL };
+      unsigned char *a, *b;
+      long na, nb;
+      render_opts(file_orc, file_sco, plain, NULL, NULL);
+      render_opts(file_orc, file_sco, wb, NULL, NULL);
+      na = file_bytes("io_test_plain.wav", &a);
+      nb = file_bytes("io_test_wb.wav", &b);
+      CU_ASSERT(na > 1000);
+      CU_ASSERT_EQUAL(na, nb);
+      CU_ASSERT(na == nb && a != NULL && b != NULL && memcmp(a, b, na) == 0);
+      free(a);
+      free(b);
+      remove("io_test_plain.wav");
+      remove("io_test_wb.wav");
+    }
+}
+
+void test_spout_to_file(void)
+{
+    const char *raw[] = { "-d", "-h", "-f", "-b50", "-oio_test.raw", NULL };
+    const char *pcm[] = { "-d", "-h", "-s", "-b50", "-oio_test.raw", NULL };
+    unsigned char *data;
+    MYFLT   *spout;
+    long    i, n, nbytes;
+    int     bad;
+
+    /* raw floats are written as they are */
+    render_opts(file_orc, file_sco, raw, &spout, &n);
+    nbytes = file_bytes("io_test.raw", &data);
+    CU_ASSERT(n > 0);
+    CU_ASSERT_EQUAL(nbytes, n * (long) sizeof(float));
+    for (i = 0, bad = 0; nbytes == n * (long) sizeof(float) && i < n; i++) {
+      float x;
+      memcpy(&x, data + i * sizeof(float), sizeof(float));
+      bad += (x != (float) spout[i]);
+    }
+    CU_ASSERT_EQUAL(bad, 0);
+    free(data);
+    free(spout);
+
+    /* 16 bit samples are scaled by 1/0dbfs and clipped */
+    render_opts(file_orc, file_sco, pcm, &spout, &n);
+    nbytes = file_bytes("io_test.raw", &data);
+    CU_ASSERT_EQUAL(nbytes, n * 2);
+    for (i = 0, bad = 0; nbytes == n * 2 && i < n; i++) {
+      int   s = (int16_t) (data[2 * i] | (data[2 * i + 1] << 8));
+      double x = spout[i] * 0.5 * 32767.0;
+      if (x > 32767.0) x = 32767.0;
+      if (x < -32768.0) x = -32768.0;
+      bad += (s - x > 2.0 || x - s > 2.0);
+    }
+    CU_ASSERT_EQUAL(bad, 0);
+    free(data);
+    free(spout);
+    remove("io_test.raw");
+}
+
+static const char *gen01_orc =
+    "sr = 44100\nksmps = 7\nnchnls = 3\n0dbfs = 2\n"
+    "gi1 ftgen 1, 0, 0, 1, \"io_test_s16.wav\", 0, 0, 0\n"
+    "gi2 ftgen 2, 0, 0, 1, \"io_test_f32.wav\", 0, 0, 0\n"
+    "gi3 ftgen 3, 0, 0, -1, \"io_test_f32.wav\", 0, 0, 0\n"
+    "gi4 ftgen 4, 0, 4096, 1, \"io_test_s16.wav\", 0.01, 0, 2\n"
+    "gi5 ftgen 5, 0, 4096, -1, \"io_test_f32.wav\", 0.01, 0, 3\n";
+
+#define GEN01_TABLES 5
+
+/* the GEN01 tables of gen01_orc, loaded with the option opt */
+static void gen01_tables(const char *opt, MYFLT **tab, int *len)
+{
+    CSOUND  *csound = csoundCreate(NULL);
+    int     i;
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    if (opt != NULL)
+      csoundSetOption(csound, opt);
+    csoundCompileOrc(csound, gen01_orc);
+    csoundStart(csound);
+    for (i = 0; i < GEN01_TABLES; i++) {
+      MYFLT *t;
+      len[i] = csoundGetTable(csound, &t, i + 1);
+      tab[i] = NULL;
+      if (len[i] > 0) {
+        tab[i] = (MYFLT *) malloc((len[i] + 1) * sizeof(MYFLT));
+        memcpy(tab[i], t, (len[i] + 1) * sizeof(MYFLT));   /* with guard */
+      }
+    }
+    csoundDestroy(csound);
+}
+
+void test_gen01_mmap(void)
+{
+    const char *s16[] = { "-d", "-W", "-s", "-oio_test_s16.wav", NULL };
+    const char *f32[] = { "-d", "-W", "-f", "-oio_test_f32.wav", NULL };
+    static const char *mmap_opts[] = { "--mmap-soundfiles",
+                                       "--mmap-soundfiles=defer" };
+    MYFLT   *plain[GEN01_TABLES], *mapped[GEN01_TABLES];
+    int     plain_len[GEN01_TABLES], mapped_len[GEN01_TABLES];
+    int     i, j;
+
+    render_opts(file_orc, file_sco, s16, NULL, NULL);
+    render_opts(file_orc, file_sco, f32, NULL, NULL);
+    gen01_tables(NULL, plain, plain_len);
+    for (i = 0; i < GEN01_TABLES; i++)
+      CU_ASSERT(plain_len[i] > 0);
+    for (j = 0; j < 2; j++) {
+      gen01_tables(mmap_opts[j], mapped, mapped_len);
+      for (i = 0; i < GEN01_TABLES; i++) {
+        CU_ASSERT_EQUAL(mapped_len[i], plain_len[i]);
+        CU_ASSERT(mapped_len[i] == plain_len[i] && plain[i] != NULL &&
+                  memcmp(mapped[i], plain[i],
+                         (plain_len[i] + 1) * sizeof(MYFLT)) == 0);
+        free(mapped[i]);
+      }
+    }
+    for (i = 0; i < GEN01_TABLES; i++)
+      free(plain[i]);
+    remove("io_test_s16.wav");
+    remove("io_test_f32.wav");
+}
+
+static const char *diskin_orc =
+    "sr = 44100\nksmps = 7\nnchnls = 3\n0dbfs = 2\n"
+    "instr 1\n"
+    "a1, a2, a3 diskin2 \"io_test_in.wav\", 1\n"
+    "outch 1, a1, 2, a2, 3, a3\n"
+    "endin\n";
+
+static const char *diskin_sco = "i1 0 0.25\ne 0.4\n";
+
+void test_diskin_mmap(void)
+{
+    const char *src[] = { "-d", "-W", "-f", "-oio_test_in.wav", NULL };
+    const char *plain[] = { "-d", "-n", NULL };
+    const char *mapped[] = { "-d", "-n", "--mmap-soundfiles", NULL };
+    MYFLT   *ref, *buf;
+    long    nref, n;
+
+    render_opts(file_orc, file_sco, src, NULL, NULL);
+    render_opts(diskin_orc, diskin_sco, plain, &ref, &nref);
+    render_opts(diskin_orc, diskin_sco, mapped, &buf, &n);
+    CU_ASSERT(nref > 0);
+    CU_ASSERT_EQUAL(n, nref);
+    CU_ASSERT(n == nref && memcmp(buf, ref, n * sizeof(MYFLT)) == 0);
+    free(ref);
+    free(buf);
+    remove("io_test_in.wav");
+}
+
+static long first_nonzero(const MYFLT *x, long n)
+{
+    long i;
+    for (i = 0; i < n && x[i] == 0; i++) ;
+    return i;
+}
+
+void test_diskin_async(void)
+{
+    const char *src[] = { "-d", "-W", "-f", "-oio_test_in.wav", NULL };
+    const char *sync[] = { "-d", "-n", NULL };
+    CSOUND  *csound;
+    MYFLT   *ref, *buf;
+    long    nref, n = 0, nspout, i0, j0, i;
+    uint32_t underruns = 0, frames = 0;
+    int     streams = 0, bad = 0;
+
+    render_opts(file_orc, file_sco, src, NULL, NULL);
+    render_opts(diskin_orc, diskin_sco, sync, &ref, &nref);
+
+    csound = csoundCreate(NULL);
+    csoundSetOption(csound, "-d");
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "--realtime");
+    csoundCompileOrc(csound, diskin_orc);
+    csoundReadScore(csound, diskin_sco);
+    CU_ASSERT_EQUAL(csoundStart(csound), CSOUND_SUCCESS);
+    nspout = csoundGetKsmps(csound) * csoundGetNchnls(csound);
+    buf = (MYFLT *) calloc(nref + nspout, sizeof(MYFLT));
+    while (csoundPerformKsmps(csound) == 0) {
+      uint32_t u, f;
+      int k = csoundGetDiskinUnderruns(csound, "io_test_in.wav", &u, &f);
+      if (k > streams) streams = k;
+      if (k > 0) {
+        underruns = u;
+        frames = f;
+      }
+      if (n <= nref) {
+        memcpy(buf + n, csoundGetSpout(csound), nspout * sizeof(MYFLT));
+        n += nspout;
+      }
+      csoundSleep(1);                 /* as if waiting for the device */
+    }
+    /* one stream while the note plays, none once it has ended */
+    CU_ASSERT_EQUAL(streams, 1);
+    CU_ASSERT_EQUAL(csoundGetDiskinUnderruns(csound, NULL, NULL, NULL), 0);
+    csoundDestroy(csound);
+
+    /* the samples are those of a synchronous render, unless the reader
+       fell behind; note activation may be a cycle apart in realtime mode */
+    if (underruns == 0) {
+      CU_ASSERT_EQUAL(frames, 0);
+      i0 = first_nonzero(ref, nref);
+      j0 = first_nonzero(buf, n);
+      CU_ASSERT(i0 < nref && j0 < n);
+      for (i = 0; i0 + i < nref && j0 + i < n; i++)
+        bad += (ref[i0 + i] != buf[j0 + i]);
+      CU_ASSERT_EQUAL(bad, 0);
+    }
+    free(ref);
+    free(buf);
+    remove("io_test_in.wav");
+}
+
 int main()
 {
     CU_pSuite pSuite = NULL;
@@ -307,6 +591,11 @@ int main()
             || (NULL == CU_add_test(pSuite, "MIDI Modules\n", test_midi_modules))
             || (NULL == CU_add_test(pSuite, "MIDI Hostbased\n", test_midi_hostbased))
             || (NULL == CU_add_test(pSuite, "Audio realtime mode\n", test_audio_realtime_mode))
+            || (NULL == CU_add_test(pSuite, "Background writer\n", test_write_buffers))
+            || (NULL == CU_add_test(pSuite, "Spout to file\n", test_spout_to_file))
+            || (NULL == CU_add_test(pSuite, "GEN01 mapped\n", test_gen01_mmap))
+            || (NULL == CU_add_test(pSuite, "diskin2 mapped\n", test_diskin_mmap))
+            || (NULL == CU_add_test(pSuite, "Asynchronous diskin2\n", test_diskin_async))
         )
     {
        CU_cleanup_registry();
@@ -0,0 +1,88 @@
+/*
+ * File:   multi_instance_bench.c
+ *
+ * Voice-count throughput with and without --multi-instance: for a
+ * rising number of simultaneous notes of each instrument it renders a
+ * few seconds and reports the time per voice per k-cycle.  Not a test;
+ * run it by hand:
+ *
+ *   benchMultiInstance [max voices] [seconds]
+ */
+
+#include "csound.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char orc[] =
+    "sr = 44100\n"
+    "ksmps = 32\n"
+    "nchnls = 1\n"
+    "0dbfs = 1\n"
+    "instr 1\n"
+    "  k1 linseg 0, p3*0.5, p4, p3*0.5, 0\n"
+    "  a1 oscili k1, p5\n"
+    "  out a1\n"
+    "endin\n"
+    "instr 2\n"
+    "  a1 oscili p4, p5\n"
+    "  a2 butterlp a1, 2000\n"
+    "  out a2\n"
+    "endin\n"
+    "instr 3\n"
+    "  a1 oscili p4, p5\n"
+    "  a2 moogladder a1, 1500, 0.4\n"
+    "  out a2\n"
+    "endin\n";
+
+static double run(int insno, int voices, double secs, const char *option)
+{
+    CSOUND *csound = csoundCreate(NULL);
+    char   *sco = (char *) malloc((size_t) voices * 64 + 1), *p = sco;
+    long   kcycles = 0;
+    clock_t t0, t = 0;
+    int    i;
+
+    for (i = 0; i < voices; i++)
+      p += sprintf(p, "i%d 0 %.3f 0.001 %d\n", insno, secs, 100 + 7 * i);
+    csoundSetOption(csound, "-n");
+    csoundSetOption(csound, "-d");
+    csoundSetOption(csound, "-m0");
+    csoundSetOption(csound, "--logfile=null");
+    if (option != NULL)
+      csoundSetOption(csound, option);
+    csoundCompileOrc(csound, orc);
+    csoundReadScore(csound, sco);
+    csoundStart(csound);
+    for (;;) {
+      int done;
+      t0 = clock();
+      done = csoundPerformKsmps(csound);
+      t += clock() - t0;
+      if (done) break;
+      kcycles++;
+    }
+    csoundCleanup(csound);
+    csoundDestroy(csound);
+    free(sco);
+    return 1e9 * t / CLOCKS_PER_SEC / (kcycles ? kcycles : 1) / voices;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *name[] = { "", "linseg+oscili", "oscili+butterlp",
+                                  "oscili+moogladder" };
+    int    maxv = argc > 1 ? atoi(argv[1]) : 64;
+    double secs = argc > 2 ? atof(argv[2]) : 5.0;
+    int    insno, v;
+
+    printf("%-18s %6s %14s %14s\n", "instrument", "voices",
+           "ns/voice/k", "multi ns/v/k");
+    for (insno = 1; insno <= 3; insno++)
+      for (v = 1; v <= maxv; v *= 2)
+        printf("%-18s %6d %14.1f %14.1f\n", name[insno], v,
+               run(insno, v, secs, NULL),
+               run(insno, v, secs, "--multi-instance"));
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include "csound.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+
+/* Frontends/csound/sections.c */
+extern int render_sections(int argc, const char **argv, int nthreads,
+                           int check);
+
+int init_suite1(void)
+{
+    return 0;
+}
+
+int clean_suite1(void)
+{
+    return 0;
+}
+
+static const char *sections_csd =
+    "<CsoundSynthesizer>\n"
+    "<CsInstruments>\n"
+    "sr = 44100\nksmps = 32\nnchnls = 2\n0dbfs = 1\n"
+    "gkacc init 0\n"
+    "instr 1\n"
+    "kenv linseg 0, 0.02, 1, p3 - 0.04, 1, 0.02, 0\n"
+    "a1 oscili kenv * 0.1, p4\n"
+    "outs a1, a1 * 0.5\n"
+    "endin\n"
+    "%s"
+    "</CsInstruments>\n"
+    "<CsScore>\n"
+    "%s"
+    "</CsScore>\n"
+    "</CsoundSynthesizer>\n";
+
+/* state carried from section to section */
+static const char *shared_instr =
+    "instr 2\n"
+    "gkacc = gkacc + 0.0001\n"
+    "a1 oscili gkacc, p4\n"
+    "outs a1, a1\n"
+    "endin\n";
+
+static int render_score(const char *instr, const char *score, int nthreads)
+{
+    const char *argv[] = { "csound", "-n", "-d", "-m0", "sections_test.csd" };
+    FILE *f = fopen(argv[4], "w");
+    int  result;
+    if (f == NULL) return -2;
+    fprintf(f, sections_csd, instr, score);
+    fclose(f);
+    result = render_sections(5, argv, nthreads, 1);
+    remove(argv[4]);
+    return result;
+}
+
+void test_sections_match(void)
+{
+    CU_ASSERT_EQUAL(render_score("", "i1 0 0.2 440\ni1 0.1 0.2 660\ns\n"
+                                 "i1 0 0.3 550\ns\n"
+                                 "i1 0 0.1 330\ni1 0.05 0.2 220\ns\n"
+                                 "i1 0 0.2 880\ne\n", 3), 0);
+}
+
+void test_sections_more_threads(void)
+{
+    CU_ASSERT_EQUAL(render_score("", "i1 0 0.2 440\ns\ni1 0 0.2 550\ne\n",
+                                 8), 0);
+}
+
+void test_sections_shared_state(void)
+{
+    /* gkacc goes on growing from section to section, so the score is
+       rendered in order */
+    CU_ASSERT_EQUAL(render_score(shared_instr,
+                                 "i2 0 0.2 440\ns\ni2 0 0.2 550\ns\n"
+                                 "i2 0 0.2 660\ne\n", 2), 1);
+    /* as does an instrument that writes a table, if only in one note */
+    CU_ASSERT_EQUAL(render_score("gi1 ftgen 1, 0, 8, 2, 0\n"
+                                 "instr 3\ntablew 1, 0, 1\nendin\n",
+                                 "i1 0 0.2 440\ns\ni3 0 0.1\ne\n", 2), 1);
+}
+
+int main()
+{
+    CU_pSuite pSuite = NULL;
+
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("parallel sections tests", init_suite1, clean_suite1);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(pSuite, "Test sections match", test_sections_match))
+        || (NULL == CU_add_test(pSuite, "Test more threads than sections",
+                                test_sections_more_threads))
+        || (NULL == CU_add_test(pSuite, "Test sections sharing state",
+                                test_sections_shared_state))
+        )
+    {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}